@@ -36,6 +36,7 @@ make install PREFIX=%{_prefix} DESTDIR=%{buildroot}
 /usr/bin/mergerfs-fusermount
 /usr/bin/fsck.mergerfs
 /usr/bin/mergerfs.collect-info
+/usr/bin/mergerfs.stats
 /sbin/mount.mergerfs
 /usr/lib/mergerfs/preload.so
 %doc %{_mandir}/*
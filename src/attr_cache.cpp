@@ -0,0 +1,264 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "attr_cache.hpp"
+
+#include "fs_lstat.hpp"
+#include "fs_pathbuf.hpp"
+#include "fs_stat.hpp"
+
+#include "fuse.h"
+
+#include "boost/unordered/concurrent_flat_map.hpp"
+#include "rapidhash/rapidhash.h"
+
+#include <atomic>
+#include <cerrno>
+
+#include <time.h>
+
+
+struct AttrCacheElement
+{
+  u64              time;
+  AttrCache::Entry entry;
+};
+
+typedef boost::concurrent_flat_map<u64,AttrCacheElement> attr_cache;
+
+static attr_cache       g_cache;
+static std::atomic<u64> g_hits{0};
+static std::atomic<u64> g_misses{0};
+
+
+static
+u64
+_get_time(void)
+{
+  struct timespec ts;
+
+  ::clock_gettime(CLOCK_MONOTONIC_COARSE,&ts);
+
+  return ts.tv_sec;
+}
+
+u64
+AttrCache::fingerprint(const struct stat &st_)
+{
+  const u64 data[] =
+    {
+      (u64)st_.st_dev,
+      (u64)st_.st_ino,
+      (u64)st_.st_size,
+      (u64)st_.st_mtim.tv_sec,
+      (u64)st_.st_mtim.tv_nsec,
+      (u64)st_.st_ctim.tv_sec,
+      (u64)st_.st_ctim.tv_nsec
+    };
+
+  return rapidhash(data,sizeof(data));
+}
+
+static
+bool
+_validate(const std::string &branch_,
+          const fs::path    &fusepath_,
+          const bool         follow_,
+          cu64               fingerprint_)
+{
+  int rv;
+  struct stat st;
+  const fs::PathBuf fullpath(std::string_view{branch_},fusepath_.native());
+
+  rv = (follow_ ?
+        fs::stat(fullpath.c_str(),&st) :
+        fs::lstat(fullpath.c_str(),&st));
+  if(rv < 0)
+    return false;
+
+  return (AttrCache::fingerprint(st) == fingerprint_);
+}
+
+bool
+AttrCache::get(cu64            nodeid_,
+               const fs::path &fusepath_,
+               cu64            timeout_,
+               const bool      validate_,
+               struct stat    *st_)
+{
+  bool found;
+  bool follow;
+  u64 now;
+  u64 fingerprint;
+  std::string branch;
+
+  found = false;
+  now   = ::_get_time();
+  g_cache.cvisit(nodeid_,
+                 [&](const auto &v_)
+                 {
+                   const AttrCacheElement &e = v_.second;
+
+                   if((now - e.time) >= timeout_)
+                     return;
+                   if(e.entry.fusepath != fusepath_.native())
+                     return;
+
+                   found       = true;
+                   branch      = e.entry.branch;
+                   follow      = e.entry.follow;
+                   fingerprint = e.entry.fingerprint;
+                   *st_        = e.entry.st;
+                 });
+
+  if(!found)
+    {
+      g_misses.fetch_add(1,std::memory_order_relaxed);
+      return false;
+    }
+  if(!validate_ || ::_validate(branch,fusepath_,follow,fingerprint))
+    {
+      g_hits.fetch_add(1,std::memory_order_relaxed);
+      return true;
+    }
+
+  g_cache.erase(nodeid_);
+  g_misses.fetch_add(1,std::memory_order_relaxed);
+
+  return false;
+}
+
+void
+AttrCache::set(cu64    nodeid_,
+               Entry &&entry_)
+{
+  AttrCacheElement e{::_get_time(),std::move(entry_)};
+
+  g_cache.insert_or_assign(nodeid_,std::move(e));
+}
+
+void
+AttrCache::invalidate(cu64 nodeid_)
+{
+  if(g_cache.empty())
+    return;
+
+  g_cache.erase(nodeid_);
+}
+
+// For entry changing ops the request's nodeid is the parent. The
+// node being linked, unlinked or renamed has to be looked up by path
+// and since the op has not yet been applied to the node table it is
+// still found under its old name.
+void
+AttrCache::invalidate(const fs::path &fusepath_)
+{
+  u64 nodeid;
+
+  if(g_cache.empty())
+    return;
+  if(fuse_path_nodeid(fusepath_.c_str(),&nodeid) < 0)
+    return;
+
+  g_cache.erase(nodeid);
+}
+
+// Link, unlink and rename change st_ctime, and the first two
+// st_nlink, of every name of the inode. Those share st_ino so are
+// dropped when the node's entry shows it is hard linked. When nothing
+// is known about the node, or the node table can't be consulted, all
+// hard linked file entries are dropped.
+void
+AttrCache::invalidate_links(const fs::path &fusepath_)
+{
+  int rv;
+  u64 nodeid;
+  bool found;
+  struct stat st;
+
+  if(g_cache.empty())
+    return;
+
+  // No node means the kernel never saw the name so nothing is cached
+  // for it or through it.
+  rv = fuse_path_nodeid(fusepath_.c_str(),&nodeid);
+  if(rv == -ENOENT)
+    return;
+
+  found = false;
+  if(rv == 0)
+    {
+      g_cache.cvisit(nodeid,
+                     [&](const auto &v_)
+                     {
+                       found = true;
+                       st    = v_.second.entry.st;
+                     });
+      g_cache.erase(nodeid);
+    }
+
+  if(found && ((st.st_nlink <= 1) || S_ISDIR(st.st_mode)))
+    return;
+
+  g_cache.erase_if([&](const auto &v_)
+  {
+    const struct stat &est = v_.second.entry.st;
+
+    if(S_ISDIR(est.st_mode) || (est.st_nlink <= 1))
+      return false;
+
+    return (!found || (est.st_ino == st.st_ino));
+  });
+}
+
+void
+AttrCache::clear()
+{
+  g_cache.clear();
+}
+
+u64
+AttrCache::prune(cu64 timeout_)
+{
+  u64 now;
+
+  now = ::_get_time();
+
+  return g_cache.erase_if([=](const auto &v_)
+  {
+    return ((now - v_.second.time) >= timeout_);
+  });
+}
+
+u64
+AttrCache::size()
+{
+  return g_cache.size();
+}
+
+AttrCache::Stats
+AttrCache::stats()
+{
+  Stats s;
+
+  s.hits   = g_hits.load(std::memory_order_relaxed);
+  s.misses = g_misses.load(std::memory_order_relaxed);
+  s.size   = g_cache.size();
+
+  return s;
+}
@@ -0,0 +1,92 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  USERSPACE ATTRIBUTE CACHE
+  =========================
+
+  Optional cache of fully computed getattr results (after symlinkify
+  and inodecalc) keyed by nodeid. It exists for setups which run with
+  `cache.attr=0` so the kernel asks for attributes on every access
+  but where rerunning the search policy across many branches for
+  each request is expensive.
+
+  Each entry records the fusepath it was computed for, the branch it
+  was found on, and a fingerprint (dev, ino, size, mtime, ctime) of
+  the branch file's raw stat. A lookup is a hit only when:
+
+  - the entry's fusepath matches the current fusepath of the node
+  - the entry is younger than the timeout
+  - if validation is requested a single (l)stat of the known branch
+    file produces the same fingerprint
+
+  Since ctime changes on any metadata or data change a validated hit
+  is coherent with writers touching the branches directly. What
+  validation can not detect is the search policy now preferring a
+  different branch (such as a new copy appearing on a higher
+  priority branch). That is bounded by the timeout.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "fs_path.hpp"
+
+#include <string>
+
+#include <sys/stat.h>
+
+
+namespace AttrCache
+{
+  struct Entry
+  {
+    std::string fusepath;
+    std::string branch;
+    bool        follow;
+    u64         fingerprint;
+    struct stat st;
+  };
+
+  struct Stats
+  {
+    u64 hits;
+    u64 misses;
+    u64 size;
+  };
+
+  u64  fingerprint(const struct stat &st);
+
+  bool get(cu64            nodeid,
+           const fs::path &fusepath,
+           cu64            timeout,
+           const bool      validate,
+           struct stat    *st);
+  void set(cu64    nodeid,
+           Entry &&entry);
+
+  void invalidate(cu64 nodeid);
+  void invalidate(const fs::path &fusepath);
+  void invalidate_links(const fs::path &fusepath);
+  void clear();
+  u64  prune(cu64 timeout);
+  u64  size();
+
+  Stats stats();
+}
@@ -19,21 +19,137 @@
 #include "branch.hpp"
 #include "num.hpp"
 
+#include "fs_close.hpp"
+#include "fs_fstat.hpp"
+#include "fs_open.hpp"
+#include "fs_stat.hpp"
+
+#include <fcntl.h>
+
+
+static bool g_fds_enabled = false;
+
+
+Branch::RootFD::RootFD()
+  : fd(-1),
+    retired(-1)
+{
+}
+
+Branch::RootFD::~RootFD()
+{
+  if(fd >= 0)
+    fs::close(fd);
+  if(retired >= 0)
+    fs::close(retired);
+}
+
 Branch::Branch()
-  : mode(Branch::Mode::RW)
+  : mode(Branch::Mode::RW),
+    _rootfd(std::make_shared<RootFD>())
 {
 }
 
 Branch::Branch(const Branch &branch_)
   : _minfreespace(branch_._minfreespace),
     mode(branch_.mode),
-    path(branch_.path)
+    path(branch_.path),
+    _rootfd(branch_._rootfd)
 {
 }
 
 Branch::Branch(const u64 &default_minfreespace_)
-  : _minfreespace(&default_minfreespace_)
+  : _minfreespace(&default_minfreespace_),
+    _rootfd(std::make_shared<RootFD>())
+{
+}
+
+bool
+Branch::fds_enabled()
+{
+  return g_fds_enabled;
+}
+
+void
+Branch::fds_enabled(const bool enabled_)
+{
+  g_fds_enabled = enabled_;
+}
+
+static
+int
+_open_root(const fs::path &path_)
+{
+  return fs::open(path_,O_PATH|O_DIRECTORY|O_CLOEXEC);
+}
+
+// Returns the branch root O_PATH fd or -1 if disabled or the root can
+// not be opened in which case callers fall back to absolute paths.
+int
+Branch::fd() const
 {
+  int fd;
+  int expected;
+
+  if(!g_fds_enabled)
+    return -1;
+
+  fd = _rootfd->fd.load(std::memory_order_acquire);
+  if(fd >= 0)
+    return fd;
+
+  fd = ::_open_root(path);
+  if(fd < 0)
+    return -1;
+
+  expected = -1;
+  if(_rootfd->fd.compare_exchange_strong(expected,fd))
+    return fd;
+
+  fs::close(fd);
+
+  return expected;
+}
+
+// Reopens the root if the branch path now refers to a different
+// directory than the one held, such as a filesystem being mounted
+// over the branch path after it was first opened. The replaced fd
+// may still be in use by in-flight requests so it is closed on the
+// following call rather than immediately. Expected to be called
+// periodically from a single thread.
+void
+Branch::revalidate_fd() const
+{
+  int rv;
+  int fd;
+  int newfd;
+  struct stat st_fd;
+  struct stat st_path;
+
+  if(_rootfd->retired >= 0)
+    {
+      fs::close(_rootfd->retired);
+      _rootfd->retired = -1;
+    }
+
+  fd = _rootfd->fd.load(std::memory_order_acquire);
+  if(fd < 0)
+    return;
+
+  rv = fs::stat(path,&st_path);
+  if(rv < 0)
+    return;
+  rv = fs::fstat(fd,&st_fd);
+  if((rv == 0) &&
+     (st_fd.st_dev == st_path.st_dev) &&
+     (st_fd.st_ino == st_path.st_ino))
+    return;
+
+  newfd = ::_open_root(path);
+  if(newfd < 0)
+    return;
+
+  _rootfd->retired = _rootfd->fd.exchange(newfd);
 }
 
 std::string
@@ -22,6 +22,7 @@
 #include "strvec.hpp"
 #include "fs_path.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -40,11 +41,28 @@ public:
       NC
     };
 
+public:
+  // O_PATH handle on the branch root shared by all copies of a
+  // Branch. Opened lazily when `cache.branch-fds` is enabled so the
+  // *at() variants of the fs wrappers can work relative to it rather
+  // than having the kernel walk the full branch path every call.
+  struct RootFD
+  {
+    RootFD();
+    ~RootFD();
+
+    std::atomic<int> fd;
+    int retired;
+  };
+
 public:
   std::variant<u64,const u64*> _minfreespace;
   Mode mode;
   fs::path path;
 
+private:
+  std::shared_ptr<RootFD> _rootfd;
+
 public:
   Branch();
   Branch(const Branch&);
@@ -64,4 +82,19 @@ public:
 public:
   u64 minfreespace() const;
   void set_minfreespace(const u64);
+
+public:
+  int  fd() const;
+  void revalidate_fd() const;
+
+public:
+  static bool fds_enabled();
+  static void fds_enabled(const bool);
+
+  static
+  const char*
+  relpath(const fs::path &fusepath_)
+  {
+    return (fusepath_.empty() ? "." : fusepath_.c_str());
+  }
 };
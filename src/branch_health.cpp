@@ -0,0 +1,148 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "branch_health.hpp"
+
+#include "fs_statvfs.hpp"
+#include "statvfs_util.hpp"
+#include "thread_pool.hpp"
+
+#include "fuse_stats.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+
+#define BRANCH_HEALTH_THREADS     4
+#define BRANCH_HEALTH_QUEUE_DEPTH 256
+
+namespace l
+{
+  struct Entry
+  {
+    std::atomic<u64> probe_start_ns{0};
+    std::atomic<u64> probe_done_ns{0};
+    std::atomic<u64> probe_latency_ns{0};
+    std::atomic<s32> probe_err{0};
+    std::atomic<u64> spaceavail{0};
+    std::atomic<u64> spaceused{0};
+  };
+}
+
+typedef std::unordered_map<std::string,std::shared_ptr<l::Entry>> EntryMap;
+
+// Entries are never removed. The number of paths is bounded by the
+// branches ever configured.
+static std::mutex g_mutex;
+static EntryMap   g_entries;
+
+
+static
+ThreadPool&
+_pool()
+{
+  static ThreadPool tp(BRANCH_HEALTH_THREADS,
+                       BRANCH_HEALTH_QUEUE_DEPTH,
+                       "branch.health");
+
+  return tp;
+}
+
+static
+std::shared_ptr<l::Entry>
+_entry(const std::string &path_)
+{
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  auto &ptr = g_entries[path_];
+  if(!ptr)
+    ptr = std::make_shared<l::Entry>();
+
+  return ptr;
+}
+
+static
+void
+_probe(const std::string         &path_,
+       std::shared_ptr<l::Entry>  entry_)
+{
+  int rv;
+  u64 end;
+  u64 start;
+  struct statvfs st;
+
+  start = entry_->probe_start_ns.load(std::memory_order_relaxed);
+  rv    = fs::statvfs(path_.c_str(),&st);
+  end   = fuse_stats_now_ns();
+
+  if(rv == 0)
+    {
+      entry_->spaceavail.store(StatVFS::spaceavail(st),std::memory_order_relaxed);
+      entry_->spaceused.store(StatVFS::spaceused(st),std::memory_order_relaxed);
+    }
+  entry_->probe_err.store(rv,std::memory_order_relaxed);
+  entry_->probe_latency_ns.store(end - start,std::memory_order_relaxed);
+  entry_->probe_done_ns.store(end,std::memory_order_relaxed);
+  entry_->probe_start_ns.store(0,std::memory_order_release);
+}
+
+void
+BranchHealth::probe(const Branches::Ptr &branches_)
+{
+  for(const auto &branch : *branches_)
+    {
+      u64 expected;
+      std::string path;
+      std::shared_ptr<l::Entry> entry;
+
+      path  = branch.path.native();
+      entry = ::_entry(path);
+
+      // Claim the entry so only one probe per branch is outstanding.
+      expected = 0;
+      if(!entry->probe_start_ns.compare_exchange_strong(expected,
+                                                        fuse_stats_now_ns()))
+        continue;
+
+      if(!::_pool().try_enqueue_work([path,entry]()
+      {
+        ::_probe(path,entry);
+      }))
+        entry->probe_start_ns.store(0,std::memory_order_relaxed);
+    }
+}
+
+BranchHealth::Health
+BranchHealth::get(const std::string &path_)
+{
+  Health h;
+  std::shared_ptr<l::Entry> entry;
+
+  entry = ::_entry(path_);
+
+  h.probe_start_ns   = entry->probe_start_ns.load(std::memory_order_acquire);
+  h.probe_done_ns    = entry->probe_done_ns.load(std::memory_order_relaxed);
+  h.probe_latency_ns = entry->probe_latency_ns.load(std::memory_order_relaxed);
+  h.probe_err        = entry->probe_err.load(std::memory_order_relaxed);
+  h.spaceavail       = entry->spaceavail.load(std::memory_order_relaxed);
+  h.spaceused        = entry->spaceused.load(std::memory_order_relaxed);
+
+  return h;
+}
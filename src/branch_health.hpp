@@ -0,0 +1,48 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "branches.hpp"
+
+#include <string>
+
+
+// Background statvfs probes of each branch. The results (space and
+// how long the call took) are what the stats snapshot reports for
+// branches so producing a snapshot never touches a branch itself. A
+// probe which has not returned is left outstanding and its start
+// time reported so a hung branch shows up as such rather than
+// hanging whoever asked.
+namespace BranchHealth
+{
+  struct Health
+  {
+    u64 probe_start_ns;
+    u64 probe_done_ns;
+    u64 probe_latency_ns;
+    s32 probe_err;
+    u64 spaceavail;
+    u64 spaceused;
+  };
+
+  void   probe(const Branches::Ptr &branches);
+  Health get(const std::string &path);
+}
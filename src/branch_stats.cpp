@@ -0,0 +1,138 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "branch_stats.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+#define BRANCH_STATS_SHARDS 8
+
+namespace l
+{
+  struct alignas(64) Shard
+  {
+    std::atomic<u64> ops[BranchStats::MAX_OP];
+    std::atomic<u64> errors[BranchStats::MAX_OP];
+    std::atomic<u64> total_ns[BranchStats::MAX_OP];
+    std::atomic<u64> read_bytes;
+    std::atomic<u64> write_bytes;
+    std::atomic<u64> hist[FUSE_STATS_HIST_BUCKETS];
+  };
+}
+
+struct BranchStats::Counters
+{
+  l::Shard shards[BRANCH_STATS_SHARDS];
+};
+
+typedef std::unordered_map<std::string,
+                           std::unique_ptr<BranchStats::Counters>> CountersMap;
+
+static std::shared_mutex g_mutex;
+static CountersMap       g_counters;
+static std::atomic<u32>  g_next_shard{0};
+
+
+static
+u32
+_shard()
+{
+  static thread_local u32 shard =
+    (g_next_shard.fetch_add(1,std::memory_order_relaxed) % BRANCH_STATS_SHARDS);
+
+  return shard;
+}
+
+BranchStats::Counters*
+BranchStats::get(const std::string &path_)
+{
+  {
+    std::shared_lock<std::shared_mutex> lk(g_mutex);
+    auto i = g_counters.find(path_);
+    if(i != g_counters.end())
+      return i->second.get();
+  }
+
+  std::unique_lock<std::shared_mutex> lk(g_mutex);
+  auto &ptr = g_counters[path_];
+  if(!ptr)
+    ptr = std::make_unique<Counters>();
+
+  return ptr.get();
+}
+
+void
+BranchStats::record(Counters *counters_,
+                     const Op  op_,
+                     const s64 rv_,
+                     cu64      start_ns_)
+{
+  u64 ns;
+  l::Shard *s;
+
+  ns = (fuse_stats_now_ns() - start_ns_);
+  s  = &counters_->shards[::_shard()];
+
+  s->ops[op_].fetch_add(1,std::memory_order_relaxed);
+  s->total_ns[op_].fetch_add(ns,std::memory_order_relaxed);
+  s->hist[fuse_stats_hist_bucket(ns)].fetch_add(1,std::memory_order_relaxed);
+  if(rv_ < 0)
+    s->errors[op_].fetch_add(1,std::memory_order_relaxed);
+  else if(op_ == READ)
+    s->read_bytes.fetch_add(rv_,std::memory_order_relaxed);
+  else if(op_ == WRITE)
+    s->write_bytes.fetch_add(rv_,std::memory_order_relaxed);
+}
+
+void
+BranchStats::record(const std::string &path_,
+                     const Op           op_,
+                     const s64          rv_,
+                     cu64               start_ns_)
+{
+  BranchStats::record(BranchStats::get(path_),op_,rv_,start_ns_);
+}
+
+void
+BranchStats::snapshot(const std::string &path_,
+                       Snapshot          *snapshot_)
+{
+  const Counters *counters;
+
+  *snapshot_ = {};
+
+  counters = BranchStats::get(path_);
+  for(const auto &s : counters->shards)
+    {
+      for(u32 op = 0; op < MAX_OP; op++)
+        {
+          snapshot_->ops[op]      += s.ops[op].load(std::memory_order_relaxed);
+          snapshot_->errors[op]   += s.errors[op].load(std::memory_order_relaxed);
+          snapshot_->total_ns[op] += s.total_ns[op].load(std::memory_order_relaxed);
+        }
+      snapshot_->read_bytes  += s.read_bytes.load(std::memory_order_relaxed);
+      snapshot_->write_bytes += s.write_bytes.load(std::memory_order_relaxed);
+      for(u32 b = 0; b < FUSE_STATS_HIST_BUCKETS; b++)
+        snapshot_->hist[b] += s.hist[b].load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "fuse_stats.hpp"
+
+#include <string>
+
+
+// Per branch IO accounting. Counters are looked up by branch path
+// once, when a file is opened, and the pointer kept in the FileInfo so
+// the read and write paths only touch relaxed atomics in a per thread
+// shard. Shards are summed when a snapshot is taken. Counters live
+// for the life of the process so re-adding a branch continues its
+// history.
+namespace BranchStats
+{
+  enum Op
+    {
+      READ,
+      WRITE,
+      OPEN,
+      SYNC,
+      MAX_OP
+    };
+
+  struct Counters;
+
+  struct Snapshot
+  {
+    u64 ops[MAX_OP];
+    u64 errors[MAX_OP];
+    u64 total_ns[MAX_OP];
+    u64 read_bytes;
+    u64 write_bytes;
+    u64 hist[FUSE_STATS_HIST_BUCKETS];
+  };
+
+  Counters* get(const std::string &path);
+
+  // `rv_` is the result of the underlying call: negative is an error
+  // and for READ and WRITE a positive value is the bytes moved.
+  void record(Counters *counters,
+              const Op  op,
+              const s64 rv,
+              cu64      start_ns);
+  void record(const std::string &path,
+              const Op           op,
+              const s64          rv,
+              cu64               start_ns);
+
+  void snapshot(const std::string &path,
+                Snapshot          *snapshot);
+}
@@ -0,0 +1,390 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "branch_watch.hpp"
+
+#include "attr_cache.hpp"
+#include "fd_cache.hpp"
+#include "syslog.hpp"
+
+#include "fuse.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+
+#define BRANCH_WATCH_MASK (FAN_CREATE      | \
+                           FAN_DELETE      | \
+                           FAN_MOVED_FROM  | \
+                           FAN_MOVED_TO    | \
+                           FAN_ATTRIB      | \
+                           FAN_CLOSE_WRITE | \
+                           FAN_ONDIR)
+#define BRANCH_WATCH_BUFSIZE (64 * 1024)
+
+namespace l
+{
+  struct Root
+  {
+    std::string path;
+    int         fd;
+    fsid_t      fsid;
+  };
+}
+
+static std::mutex               g_mutex;
+static std::thread              g_thread;
+static int                      g_stopfd = -1;
+static std::vector<std::string> g_paths;
+
+
+bool
+BranchWatch::relpath(const std::vector<std::string> &roots_,
+                     const std::string              &fullpath_,
+                     std::string                    *relpath_)
+{
+  for(const auto &root : roots_)
+    {
+      if(fullpath_.compare(0,root.size(),root) != 0)
+        continue;
+      if((fullpath_.size() > root.size()) &&
+         (fullpath_[root.size()] != '/'))
+        continue;
+
+      *relpath_ = fullpath_.substr(root.size());
+
+      return true;
+    }
+
+  return false;
+}
+
+// Roots are compared against /proc/self/fd links so must be
+// canonical and without the trailing slash.
+static
+std::vector<std::string>
+_root_paths(const Branches::Ptr &branches_)
+{
+  char buf[PATH_MAX];
+  std::vector<std::string> paths;
+
+  for(const auto &branch : *branches_)
+    {
+      std::string path;
+
+      if(::realpath(branch.path.c_str(),buf) == NULL)
+        continue;
+
+      path = buf;
+      while(!path.empty() && (path.back() == '/'))
+        path.pop_back();
+
+      paths.emplace_back(path);
+    }
+
+  return paths;
+}
+
+static
+int
+_resolve_dir(const std::vector<l::Root> &roots_,
+             const fsid_t               &fsid_,
+             struct file_handle         *fh_,
+             std::string                *path_)
+{
+  int fd;
+  ssize_t rv;
+  char link[64];
+  char buf[PATH_MAX];
+
+  for(const auto &root : roots_)
+    {
+      if(std::memcmp(&root.fsid,&fsid_,sizeof(fsid_t)) != 0)
+        continue;
+
+      fd = ::open_by_handle_at(root.fd,fh_,O_PATH);
+      if(fd < 0)
+        return -errno;
+
+      snprintf(link,sizeof(link),"/proc/self/fd/%d",fd);
+      rv = ::readlink(link,buf,sizeof(buf) - 1);
+      ::close(fd);
+      if(rv < 0)
+        return -errno;
+
+      path_->assign(buf,rv);
+
+      return 0;
+    }
+
+  return -ENOENT;
+}
+
+// `relpath_` is as returned by relpath() while the fd cache is keyed
+// by fusepath which has no leading slash. The fd cache is checked
+// regardless of the node being known as it outlives the node.
+void
+BranchWatch::invalidate(const std::string &relpath_)
+{
+  int rv;
+  u64 nodeid;
+  std::string::size_type pos;
+
+  pos = relpath_.find_first_not_of('/');
+  if(pos != std::string::npos)
+    FdCache::invalidate(relpath_.c_str() + pos);
+
+  rv = fuse_invalidate_path(relpath_.c_str(),0,&nodeid);
+  if(rv < 0)
+    return;
+
+  if(nodeid)
+    AttrCache::invalidate(nodeid);
+}
+
+static
+void
+_process(const std::vector<l::Root>     &roots_,
+         const std::vector<std::string> &paths_,
+         const char                     *buf_,
+         ssize_t                         len_,
+         std::unordered_set<std::string> *relpaths_,
+         bool                           *overflow_)
+{
+  const pid_t pid = ::getpid();
+  const struct fanotify_event_metadata *meta;
+
+  meta = (const struct fanotify_event_metadata*)buf_;
+  for(; FAN_EVENT_OK(meta,len_); meta = FAN_EVENT_NEXT(meta,len_))
+    {
+      int rv;
+      const char *name;
+      std::string path;
+      std::string relpath;
+      struct file_handle *fh;
+      const struct fanotify_event_info_fid *fid;
+
+      if(meta->vers != FANOTIFY_METADATA_VERSION)
+        continue;
+      if(meta->mask & FAN_Q_OVERFLOW)
+        {
+          *overflow_ = true;
+          continue;
+        }
+      if(meta->pid == pid)
+        continue;
+      if(meta->event_len < (sizeof(*meta) + sizeof(*fid)))
+        continue;
+
+      fid = (const struct fanotify_event_info_fid*)(meta + 1);
+      if(fid->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+        continue;
+
+      fh   = (struct file_handle*)fid->handle;
+      name = (const char*)(fh->f_handle + fh->handle_bytes);
+
+      rv = ::_resolve_dir(roots_,*(const fsid_t*)&fid->fsid,fh,&path);
+      if(rv < 0)
+        continue;
+      if(std::strcmp(name,".") != 0)
+        path += '/' + std::string(name);
+
+      if(!BranchWatch::relpath(paths_,path,&relpath))
+        continue;
+      if(relpath.empty())
+        continue;
+
+      relpaths_->emplace(relpath);
+    }
+}
+
+static
+void
+_watch(int                  fanfd_,
+       int                  stopfd_,
+       std::vector<l::Root> roots_)
+{
+  ssize_t len;
+  struct pollfd pfds[2];
+  std::vector<char> buf(BRANCH_WATCH_BUFSIZE);
+  std::vector<std::string> paths;
+  std::unordered_set<std::string> relpaths;
+
+  // Longest first so nested branches map to the innermost root.
+  for(const auto &root : roots_)
+    paths.emplace_back(root.path);
+  std::sort(paths.begin(),paths.end(),
+            [](const std::string &a_, const std::string &b_)
+            {
+              return (a_.size() > b_.size());
+            });
+
+  pfds[0] = {fanfd_,POLLIN,0};
+  pfds[1] = {stopfd_,POLLIN,0};
+  while(true)
+    {
+      bool overflow;
+
+      if(::poll(pfds,2,-1) < 0)
+        {
+          if(errno == EINTR)
+            continue;
+          break;
+        }
+      if(pfds[1].revents)
+        break;
+
+      // Drain what is queued so repeated changes to a path within a
+      // burst cost one invalidation.
+      overflow = false;
+      relpaths.clear();
+      while((len = ::read(fanfd_,buf.data(),buf.size())) > 0)
+        ::_process(roots_,paths,buf.data(),len,&relpaths,&overflow);
+
+      if(overflow)
+        {
+          SysLog::info("branch-watch: event queue overflowed");
+          fuse_invalidate_all_nodes();
+          AttrCache::clear();
+          FdCache::clear();
+          continue;
+        }
+
+      for(const auto &relpath : relpaths)
+        BranchWatch::invalidate(relpath);
+    }
+
+  for(const auto &root : roots_)
+    ::close(root.fd);
+  ::close(fanfd_);
+}
+
+static
+void
+_stop()
+{
+  if(!g_thread.joinable())
+    return;
+
+  ::eventfd_write(g_stopfd,1);
+  g_thread.join();
+  ::close(g_stopfd);
+  g_stopfd = -1;
+}
+
+static
+void
+_start(const std::vector<std::string> &paths_)
+{
+  int rv;
+  int fanfd;
+  std::vector<l::Root> roots;
+
+  fanfd = ::fanotify_init(FAN_CLASS_NOTIF |
+                          FAN_CLOEXEC     |
+                          FAN_NONBLOCK    |
+                          FAN_REPORT_DFID_NAME,
+                          O_RDONLY | O_LARGEFILE);
+  if(fanfd < 0)
+    {
+      SysLog::warning("branch-watch: fanotify unavailable - {}",
+                      strerror(errno));
+      return;
+    }
+
+  for(const auto &path : paths_)
+    {
+      l::Root root;
+      struct statfs st;
+
+      root.path = (path.empty() ? "/" : path);
+      root.fd   = ::open(root.path.c_str(),O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+      if(root.fd < 0)
+        continue;
+
+      rv = ::fstatfs(root.fd,&st);
+      if(rv == 0)
+        rv = ::fanotify_mark(fanfd,
+                             FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                             BRANCH_WATCH_MASK,
+                             root.fd,
+                             NULL);
+      if(rv < 0)
+        {
+          SysLog::warning("branch-watch: unable to watch `{}` - {}",
+                          root.path,
+                          strerror(errno));
+          ::close(root.fd);
+          continue;
+        }
+
+      root.path = path;
+      root.fsid = st.f_fsid;
+      roots.emplace_back(root);
+    }
+
+  if(roots.empty())
+    {
+      ::close(fanfd);
+      return;
+    }
+
+  g_stopfd = ::eventfd(0,EFD_CLOEXEC);
+  g_thread = std::thread(::_watch,fanfd,g_stopfd,std::move(roots));
+}
+
+void
+BranchWatch::sync(const bool           enabled_,
+                  const Branches::Ptr &branches_)
+{
+  std::vector<std::string> paths;
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  if(enabled_)
+    paths = ::_root_paths(branches_);
+  if(paths == g_paths)
+    return;
+
+  ::_stop();
+  g_paths = paths;
+  if(g_paths.empty())
+    return;
+
+  ::_start(g_paths);
+}
+
+void
+BranchWatch::stop()
+{
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  ::_stop();
+  g_paths.clear();
+}
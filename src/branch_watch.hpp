@@ -0,0 +1,59 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  BRANCH CHANGE WATCH
+  ===================
+
+  Optional watcher, enabled with `cache.branch-watch`, which listens
+  for changes made directly to the branches (not through mergerfs)
+  and tells the kernel to drop whatever it has cached for the
+  affected paths. Without it the only defense against stale entries
+  and attributes is keeping `cache.entry` and `cache.attr` short.
+
+  Uses fanotify filesystem marks with FAN_REPORT_DFID_NAME so
+  creates, deletes, renames, attribute changes, and closes after
+  writing are all reported with their parent directory and
+  name. Events caused by mergerfs itself are ignored. The directory
+  is resolved through its file handle, matched against the branch
+  roots, and the remaining relative path is looked up in the node
+  table. Only paths the kernel has looked up are invalidated. A
+  queue overflow invalidates everything.
+
+  fanotify requires CAP_SYS_ADMIN and Linux 5.9 or newer. If
+  unavailable a warning is logged and nothing is watched.
+*/
+
+#pragma once
+
+#include "branches.hpp"
+
+#include <string>
+#include <vector>
+
+
+namespace BranchWatch
+{
+  void sync(const bool enabled, const Branches::Ptr &branches);
+  void stop();
+
+  bool relpath(const std::vector<std::string> &roots,
+               const std::string              &fullpath,
+               std::string                    *relpath);
+  void invalidate(const std::string &relpath);
+}
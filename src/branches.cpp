@@ -23,6 +23,7 @@
 #include "fs_glob.hpp"
 #include "fs_is_rofs.hpp"
 #include "fs_realpathize.hpp"
+#include "mem_branch.hpp"
 #include "base_types.h"
 #include "num.hpp"
 #include "str.hpp"
@@ -214,6 +215,20 @@ namespace l
     if(minfreespace.has_value())
       branch._minfreespace = minfreespace.value();
 
+    if(MemBranch::is_mem(glob))
+      {
+        std::string path;
+
+        rv = MemBranch::path(glob,&path);
+        if(rv < 0)
+          return rv;
+
+        branch.path = path;
+        branches_->emplace_back(branch);
+
+        return 0;
+      }
+
     fs::glob(glob,&paths);
     if(paths.empty())
       {
@@ -77,7 +77,13 @@ Config::Config()
   branches_mount_timeout(0),
   branches_mount_timeout_fail(false),
   cache_attr(1),
+  cache_attr_user(0),
+  cache_attr_user_validate(true),
+  cache_branch_fds(false),
+  cache_branch_watch(false),
   cache_entry(1),
+  cache_fd_reuse(0),
+  cache_fd_reuse_stats(),
   cache_files(CacheFiles::ENUM::OFF),
   cache_files_process_names(CACHE_FILES_PROCESS_NAMES_DEFAULT),
   cache_negative_entry(0),
@@ -87,9 +93,12 @@ Config::Config()
   cache_writeback(false),
   category(func),
   config_file(),
+  copy_chunk_size(256),
+  copy_inflight(4),
   direct_io_allow_mmap(true),
   dropcacheonclose(false),
   export_support(true),
+  fanout_thread_count(0),
   flushonclose(FlushOnClose::ENUM::OPENED_FOR_WRITE),
   follow_symlinks(FollowSymlinks::ENUM::NEVER),
   fsname(),
@@ -104,9 +113,11 @@ Config::Config()
   link_cow(false),
   link_exdev(LinkEXDEV::ENUM::PASSTHROUGH),
   log_file({}),
+  log_slow_ops(0),
   minfreespace(branches.minfreespace),
   mountpoint(),
   moveonenospc(true),
+  moveonenospc_async(false),
   nfsopenhack(NFSOpenHack::ENUM::OFF),
   nullrw(false),
   parallel_direct_writes(true),
@@ -119,14 +130,21 @@ Config::Config()
   proxy_ioprio(false),
   read_thread_count(fuse_cfg.read_thread_count),
   readahead(0),
+  readahead_prefetch(0),
   readdir("seq"),
+  release_async(ReleaseAsync::ENUM::OFF),
   rename_exdev(RenameEXDEV::ENUM::PASSTHROUGH),
+  replica_balance(false),
   scheduling_priority(-10),
   security_capability(true),
   statfs(StatFS::ENUM::BASE),
   statfs_ignore(StatFSIgnore::ENUM::NONE),
+  stats_hot_nodes(false),
+  stats_hot_nodes_top(),
+  stats_shm(false),
   symlinkify(false),
   symlinkify_timeout(3600),
+  write_coalesce(0),
   xattr(XAttr::ENUM::PASSTHROUGH),
 
   _congestion_threshold(fuse_cfg.congestion_threshold),
@@ -157,6 +175,7 @@ Config::Config()
     async_read.ro =
     branches_mount_timeout.ro =
     branches_mount_timeout_fail.ro =
+    cache_fd_reuse_stats.ro =
     cache_symlinks.ro =
     cache_writeback.ro =
     direct_io_allow_mmap.ro =
@@ -174,6 +193,7 @@ Config::Config()
     process_thread_queue_depth.ro =
     read_thread_count.ro =
     scheduling_priority.ro =
+    stats_hot_nodes_top.ro =
     true;
   _congestion_threshold.display =
     _gid.display =
@@ -197,7 +217,13 @@ Config::Config()
   _map["branches-mount-timeout"]      = &branches_mount_timeout;
   _map["branches-mount-timeout-fail"] = &branches_mount_timeout_fail;
   _map["cache.attr"]                  = &cache_attr;
+  _map["cache.attr.user"]             = &cache_attr_user;
+  _map["cache.attr.user.validate"]    = &cache_attr_user_validate;
+  _map["cache.branch-fds"]            = &cache_branch_fds;
+  _map["cache.branch-watch"]          = &cache_branch_watch;
   _map["cache.entry"]                 = &cache_entry;
+  _map["cache.fd-reuse"]              = &cache_fd_reuse;
+  _map["cache.fd-reuse.stats"]        = &cache_fd_reuse_stats;
   _map["cache.files"]                 = &cache_files;
   _map["cache.files.process-names"]   = &cache_files_process_names;
   _map["cache.negative-entry"]        = &cache_negative_entry;
@@ -210,12 +236,15 @@ Config::Config()
   _map["category.create"]             = &category.create;
   _map["category.search"]             = &category.search;
   _map["config"]                      = &config_file;
+  _map["copy.chunk-size"]             = &copy_chunk_size;
+  _map["copy.inflight"]               = &copy_inflight;
   _map["debug"]                       = &_debug;
   _map["defaults"]                    = &_dummy;
   _map["direct-io"]                   = &_dummy;
   _map["direct-io-allow-mmap"]        = &direct_io_allow_mmap;
   _map["dropcacheonclose"]            = &dropcacheonclose;
   _map["export-support"]              = &export_support;
+  _map["fanout-thread-count"]         = &fanout_thread_count;
   _map["flush-on-close"]              = &flushonclose;
   _map["follow-symlinks"]             = &follow_symlinks;
   _map["fsname"]                      = &fsname;
@@ -255,10 +284,12 @@ Config::Config()
   _map["link-cow"]                    = &link_cow;
   _map["link-exdev"]                  = &link_exdev;
   _map["log.file"]                    = &log_file;
+  _map["log.slow-ops"]                = &log_slow_ops;
   _map["minfreespace"]                = &minfreespace;
   _map["mount"]                       = &_mount;
   _map["mountpoint"]                  = &_mountpoint;
   _map["moveonenospc"]                = &moveonenospc;
+  _map["moveonenospc.async"]          = &moveonenospc_async;
   _map["negative-entry"]              = &_dummy;
   _map["never-forget-nodes"]          = &_never_forget_nodes;
   _map["nfsopenhack"]                 = &nfsopenhack;
@@ -279,9 +310,12 @@ Config::Config()
   _map["proxy-ioprio"]                = &proxy_ioprio;
   _map["read-thread-count"]           = &read_thread_count;
   _map["readahead"]                   = &readahead;
+  _map["readahead.prefetch"]          = &readahead_prefetch;
+  _map["release.async"]               = &release_async;
   _map["remember"]                    = &_remember;
   _map["remember-nodes"]              = &_remember_nodes;
   _map["rename-exdev"]                = &rename_exdev;
+  _map["replica-balance"]             = &replica_balance;
   _map["scheduling-priority"]         = &scheduling_priority;
   _map["security-capability"]         = &security_capability;
   _map["splice-move"]                 = &_dummy;
@@ -290,6 +324,9 @@ Config::Config()
   _map["srcmounts"]                   = &_srcmounts;
   _map["statfs"]                      = &statfs;
   _map["statfs-ignore"]               = &statfs_ignore;
+  _map["stats.hot-nodes"]             = &stats_hot_nodes;
+  _map["stats.hot-nodes.top"]         = &stats_hot_nodes_top;
+  _map["stats.shm"]                   = &stats_shm;
   _map["symlinkify"]                  = &symlinkify;
   _map["symlinkify-timeout"]          = &symlinkify_timeout;
   _map["threads"]                     = &_threads;
@@ -297,6 +334,7 @@ Config::Config()
   _map["umask"]                       = &_umask;
   _map["use-ino"]                     = &_dummy;
   _map["version"]                     = &_version;
+  _map["write-coalesce"]              = &write_coalesce;
   _map["xattr"]                       = &xattr;
 }
 
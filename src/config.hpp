@@ -23,8 +23,10 @@
 #include "config_cachefiles.hpp"
 #include "config_debug.hpp"
 #include "config_dummy.hpp"
+#include "config_fd_reuse_stats.hpp"
 #include "config_flushonclose.hpp"
 #include "config_follow_symlinks.hpp"
+#include "config_hot_nodes.hpp"
 #include "config_inodecalc.hpp"
 #include "config_link_exdev.hpp"
 #include "config_log_file.hpp"
@@ -35,6 +37,7 @@
 #include "config_passthrough_io.hpp"
 #include "config_pid.hpp"
 #include "config_proxy_ioprio.hpp"
+#include "config_release_async.hpp"
 #include "config_rename_exdev.hpp"
 #include "config_set.hpp"
 #include "config_statfs.hpp"
@@ -113,7 +116,13 @@ public:
   ConfigU64      branches_mount_timeout;
   ConfigBOOL     branches_mount_timeout_fail;
   ConfigU64      cache_attr;
+  ConfigU64      cache_attr_user;
+  ConfigBOOL     cache_attr_user_validate;
+  ConfigBOOL     cache_branch_fds;
+  ConfigBOOL     cache_branch_watch;
   ConfigU64      cache_entry;
+  ConfigU64      cache_fd_reuse;
+  ConfigFdReuseStats cache_fd_reuse_stats;
   CacheFiles     cache_files;
   ConfigSet      cache_files_process_names;
   ConfigU64      cache_negative_entry;
@@ -123,9 +132,12 @@ public:
   ConfigBOOL     cache_writeback;
   Categories     category;
   CfgConfigFile  config_file;
+  ConfigU64      copy_chunk_size;
+  ConfigU64      copy_inflight;
   ConfigBOOL     direct_io_allow_mmap;
   ConfigBOOL     dropcacheonclose;
   ConfigBOOL     export_support;
+  ConfigU64      fanout_thread_count;
   FlushOnClose   flushonclose;
   FollowSymlinks follow_symlinks;
   ConfigSTR      fsname;
@@ -140,9 +152,11 @@ public:
   ConfigBOOL     link_cow;
   LinkEXDEV      link_exdev;
   LogFile        log_file;
+  ConfigU64      log_slow_ops;
   TFSRef<u64>    minfreespace;
   fs::path       mountpoint;
   MoveOnENOSPC   moveonenospc;
+  ConfigBOOL     moveonenospc_async;
   NFSOpenHack    nfsopenhack;
   ConfigBOOL     nullrw;
   ConfigBOOL     parallel_direct_writes;
@@ -156,14 +170,21 @@ public:
   ProxyIOPrio    proxy_ioprio;
   TFSRef<int>    read_thread_count;
   ConfigU64      readahead;
+  ConfigU64      readahead_prefetch;
   FUSE::ReadDir  readdir;
+  ReleaseAsync   release_async;
   RenameEXDEV    rename_exdev;
+  ConfigBOOL     replica_balance;
   ConfigINT      scheduling_priority;
   ConfigBOOL     security_capability;
   StatFS         statfs;
   StatFSIgnore   statfs_ignore;
+  ConfigBOOL     stats_hot_nodes;
+  ConfigHotNodesTop stats_hot_nodes_top;
+  ConfigBOOL     stats_shm;
   ConfigBOOL     symlinkify;
   ConfigS64      symlinkify_timeout;
+  ConfigU64      write_coalesce;
   XAttr          xattr;
 
 private:
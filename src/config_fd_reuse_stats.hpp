@@ -0,0 +1,46 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "fd_cache.hpp"
+#include "tofrom_string.hpp"
+#include "fmt/core.h"
+
+
+class ConfigFdReuseStats : public ToFromString
+{
+public:
+  std::string
+  to_string() const final
+  {
+    const FdCache::Stats s = FdCache::stats();
+
+    return fmt::format("hits={},misses={},evictions={},size={}",
+                       s.hits,
+                       s.misses,
+                       s.evictions,
+                       s.size);
+  }
+
+  int
+  from_string(const std::string_view) final
+  {
+    return -EROFS;
+  }
+};
@@ -0,0 +1,60 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "hot_nodes.hpp"
+#include "tofrom_string.hpp"
+
+#include "fuse.h"
+
+#include "fmt/core.h"
+
+#include <limits.h>
+
+
+// One "score path" line per node, hottest first. Nodes the kernel has
+// since forgotten are skipped.
+class ConfigHotNodesTop : public ToFromString
+{
+public:
+  std::string
+  to_string() const final
+  {
+    int rv;
+    std::string s;
+    char path[PATH_MAX];
+
+    for(const auto &e : HotNodes::top())
+      {
+        rv = fuse_nodeid_path(e.nodeid,path,sizeof(path));
+        if(rv < 0)
+          continue;
+
+        s += fmt::format("{} {}\n",e.score,path);
+      }
+
+    return s;
+  }
+
+  int
+  from_string(const std::string_view) final
+  {
+    return -EROFS;
+  }
+};
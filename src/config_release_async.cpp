@@ -0,0 +1,54 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "config_release_async.hpp"
+#include "ef.hpp"
+#include "errno.hpp"
+
+template<>
+std::string
+ReleaseAsync::to_string() const
+{
+  switch(_data)
+    {
+    case ReleaseAsync::ENUM::OFF:
+      return "off";
+    case ReleaseAsync::ENUM::DROPCACHE:
+      return "dropcache";
+    case ReleaseAsync::ENUM::CLOSE:
+      return "close";
+    }
+
+  return {};
+}
+
+template<>
+int
+ReleaseAsync::from_string(const std::string_view s_)
+{
+  if(s_ == "off")
+    _data = ReleaseAsync::ENUM::OFF;
+  ef(s_ == "dropcache")
+    _data = ReleaseAsync::ENUM::DROPCACHE;
+  ef(s_ == "close")
+    _data = ReleaseAsync::ENUM::CLOSE;
+  else
+    return -EINVAL;
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "fanout.hpp"
+
+
+#define FANOUT_QUEUE_DEPTH_PER_THREAD 8
+
+static std::atomic<u64> g_threads{0};
+
+
+void
+Fanout::threads(cu64 count_)
+{
+  g_threads.store(count_,std::memory_order_relaxed);
+  if(count_)
+    Fanout::pool().set_threads(count_);
+}
+
+u64
+Fanout::threads()
+{
+  return g_threads.load(std::memory_order_relaxed);
+}
+
+// Created on first use so no threads exist unless enabled. Resized by
+// threads() though never below one as an idle thread is cheap.
+ThreadPool&
+Fanout::pool()
+{
+  static ThreadPool tp(std::max<u64>(Fanout::threads(),1),
+                       std::max<u64>(Fanout::threads(),1) * FANOUT_QUEUE_DEPTH_PER_THREAD,
+                       "fanout");
+
+  return tp;
+}
@@ -0,0 +1,132 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "branchptrvec.hpp"
+#include "thread_pool.hpp"
+
+#include "base_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+
+// Runs a per-branch operation across the branches returned by an
+// action policy concurrently. Results are returned indexed by branch
+// so callers fold them into Err / PolicyRV in branch order exactly as
+// the sequential loops do.
+//
+// The calling thread works through the branches alongside up to
+// `fanout-thread-count` pool threads so a saturated pool only costs
+// parallelism, never progress. With the count at 0 or a single
+// branch everything runs inline.
+namespace Fanout
+{
+  void threads(cu64 count);
+  u64  threads();
+
+  ThreadPool& pool();
+
+  template<typename T>
+  struct State
+  {
+    std::atomic<u64>        next{0};
+    u64                     count;
+    u64                     remaining;
+    std::mutex              mutex;
+    std::condition_variable cv;
+    const BranchPtrVec     *branches;
+    T                      *results;
+  };
+
+  template<typename T, typename FuncType>
+  void
+  work(State<T> &s_,
+       FuncType &func_)
+  {
+    u64 i;
+    u64 done;
+
+    // Nothing but `count` may be touched until an index is claimed:
+    // once all are done the caller's stack is gone.
+    done = 0;
+    while((i = s_.next.fetch_add(1,std::memory_order_relaxed)) < s_.count)
+      {
+        s_.results[i] = func_(*(*s_.branches)[i]);
+        done++;
+      }
+
+    if(done == 0)
+      return;
+
+    std::lock_guard<std::mutex> lk(s_.mutex);
+    s_.remaining -= done;
+    if(s_.remaining == 0)
+      s_.cv.notify_all();
+  }
+
+  // `func_(const Branch&)` is called once per branch with the return
+  // value stored in `results_[i]`. `results_` must have room for
+  // branches_.size() elements.
+  template<typename T, typename FuncType>
+  void
+  run(const BranchPtrVec &branches_,
+      T                  *results_,
+      FuncType          &&func_)
+  {
+    u64 helpers;
+    const u64 n = branches_.size();
+
+    helpers = std::min(n - 1,Fanout::threads());
+    if((n <= 1) || (helpers == 0))
+      {
+        for(u64 i = 0; i < n; i++)
+          results_[i] = func_(*branches_[i]);
+        return;
+      }
+
+    // Shared ownership as a queued helper may only start after the
+    // caller has finished everything and returned.
+    auto s = std::make_shared<State<T>>();
+    s->count     = n;
+    s->remaining = n;
+    s->branches  = &branches_;
+    s->results   = results_;
+
+    for(u64 i = 0; i < helpers; i++)
+      {
+        bool queued;
+
+        queued = Fanout::pool().try_enqueue_work([s,&func_]()
+        {
+          Fanout::work(*s,func_);
+        });
+        if(!queued)
+          break;
+      }
+
+    Fanout::work(*s,func_);
+
+    std::unique_lock<std::mutex> lk(s->mutex);
+    s->cv.wait(lk,[&]{ return (s->remaining == 0); });
+  }
+}
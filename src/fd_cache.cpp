@@ -0,0 +1,350 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "fd_cache.hpp"
+
+#include "fs_close.hpp"
+#include "fs_fstat.hpp"
+#include "fs_getfl.hpp"
+#include "fs_lstat.hpp"
+#include "fs_pathbuf.hpp"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+
+
+#ifndef O_NOATIME
+#define O_NOATIME 0
+#endif
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
+
+// Flags which change the behavior of an open file description. Others
+// passed to open (O_CLOEXEC, O_NOFOLLOW, ...) don't matter once the
+// file is open.
+#define FD_CACHE_FLAGS_MASK (O_ACCMODE|O_APPEND|O_DIRECT|O_NOATIME|O_NONBLOCK|O_SYNC|O_DSYNC)
+
+namespace l
+{
+  struct Entry
+  {
+    u64         nodeid;
+    int         flags;
+    int         fd;
+    u64         time;
+    dev_t       dev;
+    ino_t       ino;
+    std::string fusepath;
+    Branch      branch;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::unordered_multimap<u64,EntryList::iterator> EntryMap;
+}
+
+// Most recently used at the front.
+static std::mutex       g_mutex;
+static l::EntryList     g_lru;
+static l::EntryMap      g_map;
+static std::atomic<u64> g_capacity{0};
+static std::atomic<u64> g_hits{0};
+static std::atomic<u64> g_misses{0};
+static std::atomic<u64> g_evictions{0};
+
+
+static
+u64
+_get_time(void)
+{
+  struct timespec ts;
+
+  ::clock_gettime(CLOCK_MONOTONIC_COARSE,&ts);
+
+  return ts.tv_sec;
+}
+
+static
+u64
+_key(cu64      nodeid_,
+     const int flags_)
+{
+  return (nodeid_ ^ ((u64)(flags_ & FD_CACHE_FLAGS_MASK) << 48));
+}
+
+// Must be called with g_mutex held. Returns the fd for the caller to
+// close outside the lock.
+static
+int
+_erase(l::EntryList::iterator i_)
+{
+  int fd;
+  u64 key;
+
+  fd  = i_->fd;
+  key = ::_key(i_->nodeid,i_->flags);
+
+  auto range = g_map.equal_range(key);
+  for(auto m = range.first; m != range.second; ++m)
+    {
+      if(m->second != i_)
+        continue;
+      g_map.erase(m);
+      break;
+    }
+  g_lru.erase(i_);
+
+  return fd;
+}
+
+static
+void
+_close_all(const std::vector<int> &fds_)
+{
+  for(const auto fd : fds_)
+    fs::close(fd);
+}
+
+static
+bool
+_validate(const l::Entry &e_)
+{
+  int rv;
+  struct stat st;
+  const fs::PathBuf fullpath(e_.branch.path,e_.fusepath.c_str());
+
+  rv = fs::lstat(fullpath.c_str(),&st);
+  if(rv < 0)
+    return false;
+
+  return ((st.st_dev == e_.dev) && (st.st_ino == e_.ino));
+}
+
+void
+FdCache::capacity(cu64 capacity_)
+{
+  std::vector<int> fds;
+
+  g_capacity.store(capacity_,std::memory_order_relaxed);
+
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    while(g_lru.size() > capacity_)
+      {
+        fds.push_back(::_erase(std::prev(g_lru.end())));
+        g_evictions.fetch_add(1,std::memory_order_relaxed);
+      }
+  }
+
+  ::_close_all(fds);
+}
+
+u64
+FdCache::capacity()
+{
+  return g_capacity.load(std::memory_order_relaxed);
+}
+
+// Returns a validated fd and sets `branch_` or -1 on a miss.
+int
+FdCache::take(cu64                   nodeid_,
+              const fs::path        &fusepath_,
+              const int              flags_,
+              std::optional<Branch> *branch_)
+{
+  u64 key;
+  std::optional<l::Entry> entry;
+
+  if(FdCache::capacity() == 0)
+    return -1;
+
+  key = ::_key(nodeid_,flags_);
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    auto range = g_map.equal_range(key);
+    for(auto m = range.first; m != range.second; ++m)
+      {
+        const l::Entry &e = *m->second;
+
+        if(e.nodeid != nodeid_)
+          continue;
+        if(e.flags != (flags_ & FD_CACHE_FLAGS_MASK))
+          continue;
+        if(e.fusepath != fusepath_.native())
+          continue;
+
+        entry = std::move(*m->second);
+        g_lru.erase(m->second);
+        g_map.erase(m);
+        break;
+      }
+  }
+
+  if(entry && ::_validate(*entry))
+    {
+      g_hits.fetch_add(1,std::memory_order_relaxed);
+      branch_->emplace(entry->branch);
+      return entry->fd;
+    }
+
+  g_misses.fetch_add(1,std::memory_order_relaxed);
+  if(entry)
+    fs::close(entry->fd);
+
+  return -1;
+}
+
+// Returns true if the cache took ownership of `fd_`. Only read-only
+// fds are kept.
+bool
+FdCache::put(cu64            nodeid_,
+             const fs::path &fusepath_,
+             const Branch   &branch_,
+             const int       fd_)
+{
+  int rv;
+  int flags;
+  u64 capacity;
+  struct stat st;
+  std::vector<int> fds;
+
+  capacity = FdCache::capacity();
+  if(capacity == 0)
+    return false;
+
+  flags = fs::getfl(fd_);
+  if(flags < 0)
+    return false;
+  if((flags & O_ACCMODE) != O_RDONLY)
+    return false;
+
+  rv = fs::fstat(fd_,&st);
+  if(rv < 0)
+    return false;
+  if(!S_ISREG(st.st_mode) || (st.st_nlink == 0))
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    g_lru.push_front(l::Entry{nodeid_,
+                              flags & FD_CACHE_FLAGS_MASK,
+                              fd_,
+                              ::_get_time(),
+                              st.st_dev,
+                              st.st_ino,
+                              fusepath_.native(),
+                              branch_});
+    g_map.emplace(::_key(nodeid_,flags),g_lru.begin());
+
+    while(g_lru.size() > capacity)
+      {
+        fds.push_back(::_erase(std::prev(g_lru.end())));
+        g_evictions.fetch_add(1,std::memory_order_relaxed);
+      }
+  }
+
+  ::_close_all(fds);
+
+  return true;
+}
+
+void
+FdCache::invalidate(const fs::path &fusepath_)
+{
+  std::vector<int> fds;
+
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    if(g_lru.empty())
+      return;
+
+    for(auto i = g_lru.begin(); i != g_lru.end();)
+      {
+        auto next = std::next(i);
+        if(i->fusepath == fusepath_.native())
+          fds.push_back(::_erase(i));
+        i = next;
+      }
+  }
+
+  ::_close_all(fds);
+}
+
+void
+FdCache::clear()
+{
+  std::vector<int> fds;
+
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    for(const auto &e : g_lru)
+      fds.push_back(e.fd);
+    g_lru.clear();
+    g_map.clear();
+  }
+
+  ::_close_all(fds);
+}
+
+u64
+FdCache::prune(cu64 timeout_)
+{
+  u64 now;
+  std::vector<int> fds;
+
+  now = ::_get_time();
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    while(!g_lru.empty() && ((now - g_lru.back().time) >= timeout_))
+      fds.push_back(::_erase(std::prev(g_lru.end())));
+  }
+
+  g_evictions.fetch_add(fds.size(),std::memory_order_relaxed);
+  ::_close_all(fds);
+
+  return fds.size();
+}
+
+FdCache::Stats
+FdCache::stats()
+{
+  Stats s;
+
+  s.hits      = g_hits.load(std::memory_order_relaxed);
+  s.misses    = g_misses.load(std::memory_order_relaxed);
+  s.evictions = g_evictions.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    s.size = g_lru.size();
+  }
+
+  return s;
+}
@@ -0,0 +1,77 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  RELEASED FD REUSE CACHE
+  =======================
+
+  Optional bounded LRU of branch fds from released read-only opens,
+  enabled with `cache.fd-reuse`. Workloads which repeatedly open and
+  close the same files can then skip the search policy and the
+  open(2) on the branch.
+
+  Entries are keyed by nodeid and the fd's status flags (access mode,
+  O_DIRECT, O_NOATIME, etc.) and record the branch and fusepath the
+  fd was opened for. A cached fd is only handed out if the fusepath
+  still matches and an lstat of the branch file returns the same
+  dev/ino as the fd, so files replaced or removed directly on the
+  branch are not reused.
+
+  Cached fds keep their inodes alive so entries for a path are
+  dropped on unlink and rename through mergerfs and idle ones are
+  closed by the maintenance thread.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "branch.hpp"
+#include "fs_path.hpp"
+
+#include <optional>
+
+
+namespace FdCache
+{
+  struct Stats
+  {
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+    u64 size;
+  };
+
+  void capacity(cu64 capacity);
+  u64  capacity();
+
+  int  take(cu64                   nodeid,
+            const fs::path        &fusepath,
+            const int              flags,
+            std::optional<Branch> *branch);
+  bool put(cu64            nodeid,
+           const fs::path &fusepath,
+           const Branch   &branch,
+           const int       fd);
+
+  void invalidate(const fs::path &fusepath);
+  void clear();
+  u64  prune(cu64 timeout);
+
+  Stats stats();
+}
@@ -45,14 +45,22 @@
 
 #include "assert.hpp"
 #include "branch.hpp"
+#include "branch_stats.hpp"
 #include "fh.hpp"
 #include "fs_path.hpp"
+#include "read_stream.hpp"
+#include "replica_balance.hpp"
+#include "write_coalesce.hpp"
 
 #include "base_types.h"
 
+#include <atomic>
 #include <shared_mutex>
 
 
+class Relocation;
+
+
 class FileInfo : public FH
 {
 public:
@@ -67,7 +75,9 @@ public:
     : FH(fusepath_),
       fd(fd_),
       branch(*branch_),
-      direct_io(direct_io_)
+      direct_io(direct_io_),
+      writable(0),
+      stats(BranchStats::get(branch_->path.native()))
   {
   }
 
@@ -78,7 +88,9 @@ public:
     : FH(fusepath_),
       fd(fd_),
       branch(branch_),
-      direct_io(direct_io_)
+      direct_io(direct_io_),
+      writable(0),
+      stats(BranchStats::get(branch_.path.native()))
   {
   }
 
@@ -86,7 +98,9 @@ public:
     : FH(fi_->fusepath),
       fd(fi_->fd),
       branch(fi_->branch),
-      direct_io(fi_->direct_io)
+      direct_io(fi_->direct_io),
+      writable(fi_->writable),
+      stats(fi_->stats)
   {
   }
 
@@ -97,6 +111,20 @@ public:
   int fd;
   Branch branch;
   u32 direct_io:1;
+  // Opened with write access.
+  u32 writable:1;
+  // Number of handles on the node opened with write access. Only
+  // maintained on the canonical FileInfo held in open_files.
+  std::atomic<u32> writers{0};
+  // Set on handles which replica-balance opened on a branch other
+  // than the canonical one. The canonical FileInfo outlives them as
+  // they hold a reference on the open_files entry. Once the node has
+  // a writer reads go through `primary_fd`, a lazily opened read-only
+  // fd on the canonical branch, so they see the writes.
+  FileInfo *canonical = nullptr;
+  std::atomic<int> primary_fd{-1};
+  // Per branch IO counters for `branch`.
+  BranchStats::Counters *stats;
   // Serializes the fd state across concurrent writes on the same open
   // file. Concurrent writes happen with:
   // 1) writeback-cache + page-cache mode
@@ -107,6 +135,15 @@ public:
   // the fs::dup2() rebinding when moveonenospc activates. Writers
   // take shared lock; move takes unique.
   std::shared_mutex mutex;
+  // Read pattern tracking for readahead.prefetch.
+  ReadStream read_stream;
+  // Device load accounting when opened via replica-balance.
+  ReplicaBalance::Ref replica;
+  // Buffered small writes when write-coalesce is enabled.
+  WriteCoalesce wc;
+  // Set once a moveonenospc.async relocation has begun. Owned by the
+  // FileInfo and freed in release.
+  std::atomic<Relocation*> relocation{nullptr};
 };
 
 inline
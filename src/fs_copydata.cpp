@@ -18,12 +18,138 @@
 
 #include "fs_copydata.hpp"
 
+#include "errno.hpp"
 #include "fs_copydata_copy_file_range.hpp"
 #include "fs_copydata_readwrite.hpp"
 #include "fs_fadvise.hpp"
+#include "fs_fallocate.hpp"
+#include "fs_fstat.hpp"
 #include "fs_ficlone.hpp"
+#include "fs_ftruncate.hpp"
+#include "fs_lseek.hpp"
 
+#include <algorithm>
+
+#include <fcntl.h>
 #include <stddef.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// Copies [offset,offset+count). copy_file_range is dropped for the
+// rest of the file the first time it fails.
+static
+s64
+_copy_range(const int  src_fd_,
+            const int  dst_fd_,
+            const s64  offset_,
+            const u64  count_,
+            bool      *use_cfr_)
+{
+  s64 rv;
+
+  if(*use_cfr_)
+    {
+      rv = fs::copydata_copy_file_range(src_fd_,dst_fd_,offset_,count_);
+      if(rv >= 0)
+        return rv;
+      *use_cfr_ = false;
+    }
+
+  return fs::copydata_readwrite(src_fd_,dst_fd_,offset_,count_);
+}
+
+// If the hole can't be punched the range is copied instead which, as
+// reads of a hole return zeros, has the same result.
+static
+s64
+_punch_hole(const int   src_fd_,
+            const int   dst_fd_,
+            const off_t offset_,
+            const off_t len_)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+  int rv;
+
+  rv = fs::fallocate(dst_fd_,
+                     FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE,
+                     offset_,
+                     len_);
+  if(rv == 0)
+    return len_;
+#endif
+
+  return fs::copydata_readwrite(src_fd_,dst_fd_,offset_,len_);
+}
+
+// Walks the data extents of the source with SEEK_DATA/SEEK_HOLE and
+// copies only those. Holes are left unwritten on the destination, or
+// punched if it already has blocks allocated, and the size set at the
+// end so a trailing hole is preserved. Returns -ENOTSUP if extents
+// can't be queried.
+static
+s64
+_copydata_sparse(const int src_fd_,
+                 const int dst_fd_,
+                 const u64 count_)
+{
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+  s64 rv;
+  bool punch;
+  bool use_cfr;
+  off_t data;
+  off_t hole;
+  off_t offset;
+  struct stat dst_st;
+
+  rv = fs::fstat(dst_fd_,&dst_st);
+  if(rv < 0)
+    return rv;
+
+  punch   = (dst_st.st_blocks > 0);
+  use_cfr = true;
+  offset  = 0;
+  while(offset < (off_t)count_)
+    {
+      data = fs::lseek(src_fd_,offset,SEEK_DATA);
+      if(data == -ENXIO)
+        data = count_;
+      else if(data < 0)
+        return ((offset == 0) ? -ENOTSUP : data);
+      data = std::min(data,(off_t)count_);
+
+      if(punch && (data > offset))
+        {
+          rv = ::_punch_hole(src_fd_,dst_fd_,offset,data - offset);
+          if(rv < 0)
+            return rv;
+        }
+      if(data >= (off_t)count_)
+        break;
+
+      hole = fs::lseek(src_fd_,data,SEEK_HOLE);
+      if(hole < 0)
+        return hole;
+      hole = std::min(hole,(off_t)count_);
+
+      rv = ::_copy_range(src_fd_,dst_fd_,data,hole - data,&use_cfr);
+      if(rv < 0)
+        return rv;
+      if(rv < (hole - data))
+        return (data + rv);
+
+      offset = hole;
+    }
+
+  rv = fs::ftruncate(dst_fd_,count_);
+  if(rv < 0)
+    return rv;
+
+  return count_;
+#else
+  return -ENOTSUP;
+#endif
+}
 
 s64
 fs::copydata(const int src_fd_,
@@ -31,6 +157,7 @@ fs::copydata(const int src_fd_,
              const u64 count_)
 {
   s64 rv;
+  bool use_cfr;
 
   rv = fs::ficlone(src_fd_,dst_fd_);
   if(rv >= 0)
@@ -39,9 +166,11 @@ fs::copydata(const int src_fd_,
   fs::fadvise_willneed(src_fd_,0,count_);
   fs::fadvise_sequential(src_fd_,0,count_);
 
-  rv = fs::copydata_copy_file_range(src_fd_,dst_fd_,count_);
-  if(rv >= 0)
+  rv = ::_copydata_sparse(src_fd_,dst_fd_,count_);
+  if(rv != -ENOTSUP)
     return rv;
 
-  return fs::copydata_readwrite(src_fd_,dst_fd_,count_);
+  use_cfr = true;
+
+  return ::_copy_range(src_fd_,dst_fd_,0,count_,&use_cfr);
 }
@@ -29,6 +29,7 @@ static
 s64
 _copydata_copy_file_range(const int src_fd_,
                           const int dst_fd_,
+                          const s64 offset_,
                           const u64 count_)
 {
   s64 rv;
@@ -36,8 +37,8 @@ _copydata_copy_file_range(const int src_fd_,
   s64 src_off;
   s64 dst_off;
 
-  src_off = 0;
-  dst_off = 0;
+  src_off = offset_;
+  dst_off = offset_;
   nleft   = count_;
   while(nleft > 0)
     {
@@ -64,9 +65,11 @@ _copydata_copy_file_range(const int src_fd_,
 s64
 fs::copydata_copy_file_range(const int src_fd_,
                              const int dst_fd_,
+                             const s64 offset_,
                              const u64 count_)
 {
   return ::_copydata_copy_file_range(src_fd_,
                                      dst_fd_,
+                                     offset_,
                                      count_);
 }
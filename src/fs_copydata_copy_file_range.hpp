@@ -26,5 +26,6 @@ namespace fs
   s64
   copydata_copy_file_range(const int src_fd,
                            const int dst_fd,
+                           const s64 offset,
                            const u64 count);
 }
@@ -22,63 +22,284 @@
 #include "fs_pread.hpp"
 #include "fs_pwriten.hpp"
 
+#include "scope_guard/scope_guard.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 
+#define ALIGNMENT          4096
+#define DEFAULT_CHUNK_SIZE (256 * 1024)
+#define DEFAULT_INFLIGHT   4
+
+static std::atomic<u64> g_chunk_size{DEFAULT_CHUNK_SIZE};
+static std::atomic<u64> g_inflight{DEFAULT_INFLIGHT};
+
+namespace l
+{
+  struct Chunk
+  {
+    char *buf;
+    s64   offset;
+    s64   len;
+  };
+
+  // Single producer / single consumer ring of chunks. The reader
+  // fills chunks in file order while the writer drains them so both
+  // devices are kept busy.
+  struct Pipeline
+  {
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::vector<Chunk>      chunks;
+    u64                     head = 0;
+    u64                     tail = 0;
+    s64                     err  = 0;
+    bool                    eof  = false;
+    bool                    stop = false;
+  };
+}
+
+
+static
+s64
+_pread(const int  fd_,
+       char      *buf_,
+       const u64  size_,
+       const s64  offset_)
+{
+  s64 rv;
+
+  do
+    {
+      rv = fs::pread(fd_,buf_,size_,offset_);
+    }
+  while((rv == -EINTR) || (rv == -EAGAIN));
+
+  return rv;
+}
+
 static
 s64
-_copydata_readwrite(const int src_fd_,
-                    const int dst_fd_,
-                    const u64 count_,
-                    const u64 bufsize_)
+_copydata_serial(const int  src_fd_,
+                 const int  dst_fd_,
+                 const s64  offset_,
+                 const u64  count_,
+                 char      *buf_,
+                 const u64  bufsize_)
 {
   int err;
   s64 nr;
   s64 nw;
+  s64 end;
   s64 offset;
-  std::vector<char> buf;
 
-  if(bufsize_ == 0)
-    return -EINVAL;
+  offset = offset_;
+  end    = (offset_ + count_);
+  while(offset < end)
+    {
+      nr = ::_pread(src_fd_,buf_,std::min<u64>(bufsize_,end - offset),offset);
+      if(nr == 0)
+        break;
+      if(nr < 0)
+        return nr;
+
+      nw = fs::pwriten(dst_fd_,buf_,nr,offset,&err);
+      if(err < 0)
+        return err;
 
-  buf.resize(bufsize_);
+      offset += nw;
+    }
+
+  return (offset - offset_);
+}
 
-  offset = 0;
-  while(offset < (s64)count_)
+static
+void
+_pipeline_reader(l::Pipeline &p_,
+                 const int    src_fd_,
+                 const s64    offset_,
+                 const u64    count_,
+                 const u64    bufsize_)
+{
+  s64 nr;
+  s64 end;
+  s64 offset;
+  l::Chunk *chunk;
+  const u64 n = p_.chunks.size();
+
+  offset = offset_;
+  end    = (offset_ + count_);
+  while(offset < end)
     {
-      nr = fs::pread(src_fd_,&buf[0],buf.size(),offset);
-      switch(nr)
+      {
+        std::unique_lock<std::mutex> lk(p_.mutex);
+        p_.cv.wait(lk,[&]{ return (p_.stop || ((p_.tail - p_.head) < n)); });
+        if(p_.stop)
+          return;
+        chunk = &p_.chunks[p_.tail % n];
+      }
+
+      nr = ::_pread(src_fd_,
+                    chunk->buf,
+                    std::min<u64>(bufsize_,end - offset),
+                    offset);
+      if(nr <= 0)
         {
-        case -EINTR:
-        case -EAGAIN:
-          continue;
-        case 0:
-          return offset;
-        default:
-          if(nr < 0)
-            return nr;
-          break;
+          std::lock_guard<std::mutex> lk(p_.mutex);
+          p_.err = ((nr < 0) ? nr : 0);
+          p_.eof = true;
+          p_.cv.notify_all();
+          return;
         }
 
-      nw = fs::pwriten(dst_fd_,&buf[0],nr,offset,&err);
+      chunk->offset = offset;
+      chunk->len    = nr;
+      offset       += nr;
+
+      {
+        std::lock_guard<std::mutex> lk(p_.mutex);
+        p_.tail++;
+        p_.cv.notify_all();
+      }
+    }
+
+  std::lock_guard<std::mutex> lk(p_.mutex);
+  p_.eof = true;
+  p_.cv.notify_all();
+}
+
+// The calling thread writes while a second reads ahead into up to
+// `inflight_` buffers. Data is written in the order read so a short
+// copy still results in a valid prefix of the source.
+static
+s64
+_copydata_pipelined(const int  src_fd_,
+                    const int  dst_fd_,
+                    const s64  offset_,
+                    const u64  count_,
+                    char      *buf_,
+                    const u64  bufsize_,
+                    const u64  inflight_)
+{
+  int err;
+  s64 nw;
+  s64 written;
+  l::Chunk *chunk;
+  l::Pipeline p;
+  std::thread reader;
+
+  p.chunks.resize(inflight_);
+  for(u64 i = 0; i < inflight_; i++)
+    p.chunks[i].buf = &buf_[i * bufsize_];
+
+  reader = std::thread(::_pipeline_reader,
+                       std::ref(p),
+                       src_fd_,
+                       offset_,
+                       count_,
+                       bufsize_);
+
+  err     = 0;
+  written = offset_;
+  while(true)
+    {
+      {
+        std::unique_lock<std::mutex> lk(p.mutex);
+        p.cv.wait(lk,[&]{ return (p.eof || (p.head != p.tail)); });
+        if(p.head == p.tail)
+          {
+            err = p.err;
+            break;
+          }
+        chunk = &p.chunks[p.head % inflight_];
+      }
+
+      nw = fs::pwriten(dst_fd_,chunk->buf,chunk->len,chunk->offset,&err);
       if(err < 0)
-        return err;
+        break;
 
-      offset += nw;
+      written = (chunk->offset + nw);
+
+      {
+        std::lock_guard<std::mutex> lk(p.mutex);
+        p.head++;
+        p.cv.notify_all();
+      }
     }
 
-  return offset;
+  {
+    std::lock_guard<std::mutex> lk(p.mutex);
+    p.stop = true;
+    p.cv.notify_all();
+  }
+  reader.join();
+
+  if(err < 0)
+    return err;
+
+  return (written - offset_);
 }
 
-#define BUF_SIZE (256 * 1024)
+void
+fs::copydata_readwrite_config(const u64 chunk_size_,
+                              const u64 inflight_)
+{
+  g_chunk_size.store(chunk_size_ ? chunk_size_ : DEFAULT_CHUNK_SIZE,
+                     std::memory_order_relaxed);
+  g_inflight.store(inflight_,std::memory_order_relaxed);
+}
 
 s64
 fs::copydata_readwrite(const int src_fd_,
                        const int dst_fd_,
-                       const u64 count_)
+                       const s64 offset_,
+                       const u64 count_,
+                       const u64 chunk_size_,
+                       const u64 inflight_)
 {
-  return ::_copydata_readwrite(src_fd_,
+  u64 n;
+  u64 bufsize;
+  char *buf;
+
+  if(chunk_size_ == 0)
+    return -EINVAL;
+
+  bufsize = (((chunk_size_ + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT);
+  n       = ((count_ > bufsize) ? std::max<u64>(inflight_,1) : 1);
+
+  buf = (char*)std::aligned_alloc(ALIGNMENT,bufsize * n);
+  if(buf == NULL)
+    return -ENOMEM;
+  DEFER { std::free(buf); };
+
+  if(n == 1)
+    return ::_copydata_serial(src_fd_,dst_fd_,offset_,count_,buf,bufsize);
+
+  return ::_copydata_pipelined(src_fd_,
                                dst_fd_,
+                               offset_,
                                count_,
-                               BUF_SIZE);
+                               buf,
+                               bufsize,
+                               n);
+}
+
+s64
+fs::copydata_readwrite(const int src_fd_,
+                       const int dst_fd_,
+                       const s64 offset_,
+                       const u64 count_)
+{
+  return fs::copydata_readwrite(src_fd_,
+                                dst_fd_,
+                                offset_,
+                                count_,
+                                g_chunk_size.load(std::memory_order_relaxed),
+                                g_inflight.load(std::memory_order_relaxed));
 }
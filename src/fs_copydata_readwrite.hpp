@@ -22,8 +22,25 @@
 
 namespace fs
 {
+  // chunk_size is rounded up to a multiple of the page size so the
+  // buffers are usable with O_DIRECT. inflight <= 1 disables the
+  // reader thread.
+  void
+  copydata_readwrite_config(const u64 chunk_size,
+                            const u64 inflight);
+
+  // Copies [offset,offset+count) to the same range of dst_fd.
   s64
   copydata_readwrite(const int src_fd,
                      const int dst_fd,
+                     const s64 offset,
                      const u64 count);
+
+  s64
+  copydata_readwrite(const int src_fd,
+                     const int dst_fd,
+                     const s64 offset,
+                     const u64 count,
+                     const u64 chunk_size,
+                     const u64 inflight);
 }
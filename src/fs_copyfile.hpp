@@ -38,6 +38,12 @@ namespace fs
            const struct stat &src_st,
            const int          dst_fd);
 
+  // xattrs, attrs, owner, mode and times. No data.
+  s64
+  copymeta(const int          src_fd,
+           const struct stat &src_st,
+           const int          dst_fd);
+
   s64
   copyfile(const int            src_fd,
            const fs::path      &dst_filepath,
@@ -20,6 +20,7 @@
 
 #include "fs_lstat.hpp"
 #include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
 
 
 namespace fs
@@ -54,11 +55,12 @@ namespace fs
          const char     *relpath_,
          struct stat    *st_)
   {
-    fs::path fullpath;
+    int rv;
+    const fs::PathBuf fullpath(basepath_,relpath_);
 
-    fullpath = basepath_ / relpath_;
+    rv = fs::lstat(fullpath.c_str(),st_);
 
-    return fs::exists(fullpath,st_);
+    return (rv == 0);
   }
 
   static
@@ -68,11 +70,12 @@ namespace fs
          const fs::path &relpath_,
          struct stat    *st_)
   {
-    fs::path fullpath;
+    int rv;
+    const fs::PathBuf fullpath(basepath_,relpath_);
 
-    fullpath = basepath_ / relpath_;
+    rv = fs::lstat(fullpath.c_str(),st_);
 
-    return fs::exists(fullpath,st_);
+    return (rv == 0);
   }
 
   static
@@ -96,4 +99,29 @@ namespace fs
 
     return fs::exists(basepath_,relpath_,&st);
   }
+
+  static
+  inline
+  bool
+  exists(const Branch   &branch_,
+         const fs::path &relpath_,
+         struct stat    *st_)
+  {
+    int rv;
+
+    rv = fs::lstat(branch_,relpath_,st_);
+
+    return (rv == 0);
+  }
+
+  static
+  inline
+  bool
+  exists(const Branch   &branch_,
+         const fs::path &relpath_)
+  {
+    struct stat st;
+
+    return fs::exists(branch_,relpath_,&st);
+  }
 }
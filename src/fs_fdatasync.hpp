@@ -22,7 +22,7 @@
 #define _GNU_SOURCE
 #endif
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <unistd.h>
 
@@ -35,11 +35,8 @@ namespace fs
   fdatasync(const int fd_)
   {
 #if _POSIX_SYNCHRONIZED_IO > 0
-    int rv;
-
-    rv = ::fdatasync(fd_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("fdatasync",fd_,NULL,
+                      [&]() { return ::fdatasync(fd_); });
 #else
     return -ENOSYS;
 #endif
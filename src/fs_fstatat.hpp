@@ -21,6 +21,7 @@
 #include "fs_path.hpp"
 #include "to_neg_errno.hpp"
 
+#include <fcntl.h>
 #include <sys/stat.h>
 
 
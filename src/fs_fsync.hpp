@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <unistd.h>
 
@@ -30,10 +30,7 @@ namespace fs
   int
   fsync(const int fd_)
   {
-    int rv;
-
-    rv = ::fsync(fd_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("fsync",fd_,NULL,
+                      [&]() { return ::fsync(fd_); });
   }
 }
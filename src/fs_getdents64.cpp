@@ -16,7 +16,7 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <sys/types.h>
 
@@ -34,11 +34,8 @@ namespace fs
              const size_t  count_)
   {
 #if defined SYS_getdents64
-    ssize_t rv;
-
-    rv = ::syscall(SYS_getdents64,fd_,dirp_,count_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("getdents64",fd_,NULL,
+                      [&]() { return ::syscall(SYS_getdents64,fd_,dirp_,count_); });
 #else
     return -ENOTSUP;
 #endif
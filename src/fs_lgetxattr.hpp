@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 #include "xattr.hpp"
 
 #include <string>
@@ -37,14 +37,11 @@ namespace fs
             const size_t  size_)
   {
 #ifdef USE_XATTR
-    int rv;
-
-    rv = ::lgetxattr(path_,
-                     attrname_,
-                     value_,
-                     size_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("lgetxattr",-1,path_,
+                      [&]() { return ::lgetxattr(path_,
+                                                 attrname_,
+                                                 value_,
+                                                 size_); });
 #else
     return -ENOTSUP;
 #endif
@@ -18,10 +18,14 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "branch.hpp"
+#include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -35,11 +39,8 @@ namespace fs
   lstat(const char  *path_,
         struct stat *st_)
   {
-    int rv;
-
-    rv = ::lstat(path_,st_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("lstat",-1,path_,
+                      [&]() { return ::lstat(path_,st_); });
   }
 
   static
@@ -50,4 +51,21 @@ namespace fs
   {
     return fs::lstat(path_.c_str(),st_);
   }
+
+  static
+  inline
+  int
+  lstat(const Branch   &branch_,
+        const fs::path &relpath_,
+        struct stat    *st_)
+  {
+    int fd;
+
+    fd = branch_.fd();
+    if(fd < 0)
+      return fs::lstat(fs::PathBuf(branch_.path,relpath_).c_str(),st_);
+
+    return fs::traced("fstatat",fd,Branch::relpath(relpath_),
+                      [&]() { return ::fstatat(fd,Branch::relpath(relpath_),st_,AT_SYMLINK_NOFOLLOW); });
+  }
 }
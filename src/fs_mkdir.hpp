@@ -18,9 +18,8 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
-
 #include "fs_path.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -36,12 +35,9 @@ namespace fs
   mkdir(const char   *path_,
         const mode_t  mode_)
   {
-    int rv;
-
-    rv = ::mkdir(path_,
-                 mode_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("mkdir",-1,path_,
+                      [&]() { return ::mkdir(path_,
+                                             mode_); });
   }
 
   static
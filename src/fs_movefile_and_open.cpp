@@ -75,7 +75,7 @@ _movefile_and_open(const Policy::Create &createFunc_,
   fs::path src_branch;
   fs::path src_filepath;
   fs::path dst_filepath;
-  std::vector<Branch*> dst_branch;
+  BranchPtrVec dst_branch;
 
   src_branch = branchpath_;
 
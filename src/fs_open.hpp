@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -35,11 +35,8 @@ namespace fs
   open(const char *path_,
        const int   flags_)
   {
-    int rv;
-
-    rv = ::open(path_,flags_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("open",-1,path_,
+                      [&]() { return ::open(path_,flags_); });
   }
 
   static
@@ -49,11 +46,8 @@ namespace fs
        const int     flags_,
        const mode_t  mode_)
   {
-    int rv;
-
-    rv = ::open(path_,flags_,mode_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("open",-1,path_,
+                      [&]() { return ::open(path_,flags_,mode_); });
   }
 
   static
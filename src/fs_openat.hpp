@@ -18,8 +18,10 @@
 
 #pragma once
 
+#include "branch.hpp"
 #include "fs_path.hpp"
-#include "to_neg_errno.hpp"
+#include "fs_pathbuf.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -37,11 +39,8 @@ namespace fs
          const int     flags_,
          const mode_t  mode_ = 0)
   {
-    int rv;
-
-    rv = ::openat(dirfd_,pathname_,flags_,mode_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("openat",dirfd_,pathname_,
+                      [&]() { return ::openat(dirfd_,pathname_,flags_,mode_); });
   }
 
   static
@@ -71,4 +70,24 @@ namespace fs
                       flags_,
                       mode_);
   }
+
+  static
+  inline
+  int
+  openat(const Branch   &branch_,
+         const fs::path &relpath_,
+         const int       flags_,
+         const mode_t    mode_ = 0)
+  {
+    int fd;
+
+    fd = branch_.fd();
+    if(fd < 0)
+      return fs::openat(AT_FDCWD,
+                        fs::PathBuf(branch_.path,relpath_).c_str(),
+                        flags_,
+                        mode_);
+
+    return fs::openat(fd,Branch::relpath(relpath_),flags_,mode_);
+  }
 }
@@ -0,0 +1,110 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "fs_path.hpp"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <limits.h>
+
+
+namespace fs
+{
+  // Joins a base path and a relative path the same way `base / rel`
+  // does for fs::path but into an inline buffer so the common case
+  // of building a branch path for a single syscall doesn't touch the
+  // heap. Paths longer than PATH_MAX spill over into a std::string.
+  class PathBuf
+  {
+  public:
+    PathBuf(const std::string_view base_,
+            const std::string_view rel_)
+    {
+      size_t len;
+      bool   sep;
+
+      sep = (!base_.empty() && (base_.back() != '/'));
+      len = (base_.size() + sep + rel_.size());
+
+      _len = len;
+      if(len < sizeof(_buf))
+        {
+          _ptr = _buf;
+          memcpy(_buf,base_.data(),base_.size());
+          if(sep)
+            _buf[base_.size()] = '/';
+          memcpy(&_buf[base_.size() + sep],rel_.data(),rel_.size());
+          _buf[len] = '\0';
+          return;
+        }
+
+      _heap.reserve(len);
+      _heap.append(base_);
+      if(sep)
+        _heap.push_back('/');
+      _heap.append(rel_);
+      _ptr = _heap.c_str();
+    }
+
+    PathBuf(const fs::path &base_,
+            const fs::path &rel_)
+      : PathBuf(std::string_view{base_.native()},
+                std::string_view{rel_.native()})
+    {
+    }
+
+    PathBuf(const fs::path &base_,
+            const char     *rel_)
+      : PathBuf(std::string_view{base_.native()},
+                std::string_view{rel_})
+    {
+    }
+
+    PathBuf(const PathBuf&) = delete;
+    PathBuf& operator=(const PathBuf&) = delete;
+
+  public:
+    const char*
+    c_str() const
+    {
+      return _ptr;
+    }
+
+    std::string_view
+    view() const
+    {
+      return {_ptr,_len};
+    }
+
+    size_t
+    size() const
+    {
+      return _len;
+    }
+
+  private:
+    const char  *_ptr;
+    size_t       _len;
+    std::string  _heap;
+    char         _buf[PATH_MAX];
+  };
+}
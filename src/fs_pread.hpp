@@ -19,7 +19,7 @@
 #pragma once
 
 #include "base_types.h"
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <unistd.h>
 
@@ -32,10 +32,7 @@ namespace fs
         const u64  count_,
         const s64  offset_)
   {
-    s64 rv;
-
-    rv = ::pread(fd_,buf_,count_,offset_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("pread",fd_,NULL,
+                      [&]() { return ::pread(fd_,buf_,count_,offset_); });
   }
 }
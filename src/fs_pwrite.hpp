@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <unistd.h>
 
@@ -33,10 +33,7 @@ namespace fs
          size_t const  count_,
          off_t const   offset_)
   {
-    ssize_t rv;
-
-    rv = ::pwrite(fd_,buf_,count_,offset_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("pwrite",fd_,NULL,
+                      [&]() { return ::pwrite(fd_,buf_,count_,offset_); });
   }
 }
@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -34,10 +34,7 @@ namespace fs
            char              *buf_,
            const size_t       bufsiz_)
   {
-    ssize_t rv;
-
-    rv = ::readlink(path_.c_str(),buf_,bufsiz_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("readlink",-1,path_.c_str(),
+                      [&]() { return ::readlink(path_.c_str(),buf_,bufsiz_); });
   }
 }
@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <stdio.h>
 
@@ -31,11 +31,8 @@ namespace fs
   rename(const char *oldpath_,
          const char *newpath_)
   {
-    int rv;
-
-    rv = ::rename(oldpath_,newpath_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("rename",-1,oldpath_,
+                      [&]() { return ::rename(oldpath_,newpath_); });
   }
 
   static
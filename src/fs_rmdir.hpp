@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -32,11 +32,8 @@ namespace fs
   int
   rmdir(const char *path_)
   {
-    int rv;
-
-    rv = ::rmdir(path_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("rmdir",-1,path_,
+                      [&]() { return ::rmdir(path_); });
   }
 
   static
@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
@@ -33,11 +33,8 @@ namespace fs
   statvfs(const char     *path_,
           struct statvfs *st_)
   {
-    int rv;
-
-    rv = ::statvfs(path_,st_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("statvfs",-1,path_,
+                      [&]() { return ::statvfs(path_,st_); });
   }
 
   static
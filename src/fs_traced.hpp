@@ -0,0 +1,53 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "to_neg_errno.hpp"
+
+#include "fuse_slowlog.hpp"
+#include "fuse_usdt.hpp"
+
+
+namespace fs
+{
+  // Runs a branch syscall wrapped in the USDT entry/return probes and
+  // the slow op log. `func_` makes the call and returns its result as
+  // is; errno is read once, straight after, before anything else can
+  // change it. Returns the result or -errno.
+  template<typename Func>
+  static
+  inline
+  auto
+  traced(const char *name_,
+         const int   fd_,
+         const char *path_,
+         Func        func_)
+  {
+    u64 start;
+    decltype(func_()) rv;
+
+    FUSE_USDT3(branch_syscall_entry,name_,fd_,path_);
+    start = fuse_slowlog_start();
+    rv = ::to_neg_errno(func_());
+    fuse_slowlog_call(name_,fd_,path_,rv,start);
+    FUSE_USDT2(branch_syscall_return,name_,rv);
+
+    return rv;
+  }
+}
@@ -18,10 +18,14 @@
 
 #pragma once
 
-#include "to_neg_errno.hpp"
+#include "branch.hpp"
+#include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
+#include "fs_traced.hpp"
 
 #include <string>
 
+#include <fcntl.h>
 #include <unistd.h>
 
 
@@ -32,11 +36,8 @@ namespace fs
   int
   unlink(const char *path_)
   {
-    int rv;
-
-    rv = ::unlink(path_);
-
-    return ::to_neg_errno(rv);
+    return fs::traced("unlink",-1,path_,
+                      [&]() { return ::unlink(path_); });
   }
 
   static
@@ -46,4 +47,20 @@ namespace fs
   {
     return fs::unlink(path_.c_str());
   }
+
+  static
+  inline
+  int
+  unlink(const Branch   &branch_,
+         const fs::path &relpath_)
+  {
+    int fd;
+
+    fd = branch_.fd();
+    if(fd < 0)
+      return fs::unlink(fs::PathBuf(branch_.path,relpath_).c_str());
+
+    return fs::traced("unlinkat",fd,Branch::relpath(relpath_),
+                      [&]() { return ::unlinkat(fd,Branch::relpath(relpath_),0); });
+  }
 }
@@ -0,0 +1,282 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "fsck_index.hpp"
+
+#include "rapidhash/rapidhash.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace l
+{
+  struct Header
+  {
+    char magic[8];
+    u32  version;
+    u32  nbranches;
+    u64  confighash;
+    u64  count;
+  };
+
+  struct RecordHeader
+  {
+    u64 hash;
+    u32 flags;
+    u32 reserved;
+  };
+}
+
+static_assert(sizeof(l::Header) == 32);
+static_assert(sizeof(l::RecordHeader) == 16);
+static_assert(sizeof(FsckIndex::BranchStat) == 48);
+
+
+static
+u64
+_recsize(cu32 nbranches_)
+{
+  return (sizeof(l::RecordHeader) +
+          (nbranches_ * sizeof(FsckIndex::BranchStat)));
+}
+
+void
+FsckIndex::set(BranchStat        &bs_,
+               const struct stat &st_)
+{
+  bs_.size       = st_.st_size;
+  bs_.mtime_sec  = st_.st_mtim.tv_sec;
+  bs_.mtime_nsec = st_.st_mtim.tv_nsec;
+  bs_.mode       = st_.st_mode;
+  bs_.uid        = st_.st_uid;
+  bs_.gid        = st_.st_gid;
+  bs_.ctime_sec  = st_.st_ctim.tv_sec;
+  bs_.ctime_nsec = st_.st_ctim.tv_nsec;
+}
+
+u64
+FsckIndex::hash(const std::string &relpath_)
+{
+  return rapidhash(relpath_.data(),relpath_.size());
+}
+
+FsckIndex::Reader::Reader()
+  : _data(nullptr),
+    _size(0),
+    _count(0),
+    _recsize(0)
+{
+}
+
+FsckIndex::Reader::~Reader()
+{
+  if(_data)
+    ::munmap((void*)_data,_size);
+}
+
+// Returns -EINVAL if the file is not an index or was created for a
+// different branch list or options in which case it is ignored.
+int
+FsckIndex::Reader::open(const std::string &filepath_,
+                        cu64               confighash_,
+                        cu32               nbranches_)
+{
+  int fd;
+  void *mem;
+  struct stat st;
+  const l::Header *hdr;
+
+  fd = ::open(filepath_.c_str(),O_RDONLY|O_CLOEXEC);
+  if(fd < 0)
+    return -errno;
+
+  if(::fstat(fd,&st) < 0)
+    {
+      int err = errno;
+      ::close(fd);
+      return -err;
+    }
+
+  if((u64)st.st_size < sizeof(l::Header))
+    {
+      ::close(fd);
+      return -EINVAL;
+    }
+
+  mem = ::mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if(mem == MAP_FAILED)
+    return -errno;
+
+  hdr = (const l::Header*)mem;
+  _recsize = ::_recsize(nbranches_);
+  if((std::memcmp(hdr->magic,FSCK_INDEX_MAGIC,sizeof(hdr->magic)) != 0) ||
+     (hdr->version != FSCK_INDEX_VERSION) ||
+     (hdr->nbranches != nbranches_) ||
+     (hdr->confighash != confighash_) ||
+     ((u64)st.st_size != (sizeof(l::Header) + (hdr->count * _recsize))))
+    {
+      ::munmap(mem,st.st_size);
+      return -EINVAL;
+    }
+
+  ::madvise(mem,st.st_size,MADV_RANDOM);
+
+  _data  = (const char*)mem;
+  _size  = st.st_size;
+  _count = hdr->count;
+
+  return 0;
+}
+
+const
+FsckIndex::BranchStat*
+FsckIndex::Reader::lookup(cu64  hash_,
+                          u32  *flags_) const
+{
+  u64 lo;
+  u64 hi;
+  const char *recs;
+
+  if(_data == nullptr)
+    return nullptr;
+
+  recs = (_data + sizeof(l::Header));
+  lo = 0;
+  hi = _count;
+  while(lo < hi)
+    {
+      u64 mid = (lo + ((hi - lo) / 2));
+      const l::RecordHeader *rec = (const l::RecordHeader*)(recs + (mid * _recsize));
+
+      if(rec->hash < hash_)
+        {
+          lo = (mid + 1);
+          continue;
+        }
+      if(rec->hash > hash_)
+        {
+          hi = mid;
+          continue;
+        }
+
+      *flags_ = rec->flags;
+      return (const BranchStat*)(rec + 1);
+    }
+
+  return nullptr;
+}
+
+u64
+FsckIndex::Reader::count() const
+{
+  return _count;
+}
+
+FsckIndex::Writer::Writer(cu32 nbranches_)
+  : _nbranches(nbranches_),
+    _recsize(::_recsize(nbranches_))
+{
+}
+
+void
+FsckIndex::Writer::add(cu64              hash_,
+                       cu32              flags_,
+                       const BranchStat *stats_)
+{
+  l::RecordHeader rec{};
+
+  rec.hash  = hash_;
+  rec.flags = flags_;
+
+  std::lock_guard<std::mutex> lk(_mutex);
+
+  _records.insert(_records.end(),(const char*)&rec,(const char*)(&rec + 1));
+  _records.insert(_records.end(),
+                  (const char*)stats_,
+                  (const char*)(stats_ + _nbranches));
+}
+
+int
+FsckIndex::Writer::write(const std::string &filepath_,
+                         cu64               confighash_)
+{
+  FILE *f;
+  l::Header hdr{};
+  std::string tmppath;
+  std::vector<u64> order;
+
+  std::lock_guard<std::mutex> lk(_mutex);
+
+  std::memcpy(hdr.magic,FSCK_INDEX_MAGIC,sizeof(hdr.magic));
+  hdr.version    = FSCK_INDEX_VERSION;
+  hdr.nbranches  = _nbranches;
+  hdr.confighash = confighash_;
+  hdr.count      = (_records.size() / _recsize);
+
+  order.resize(hdr.count);
+  for(u64 i = 0; i < hdr.count; i++)
+    order[i] = i;
+
+  auto hash_at =
+    [&](cu64 i_)
+    {
+      return ((const l::RecordHeader*)&_records[i_ * _recsize])->hash;
+    };
+
+  std::sort(order.begin(),
+            order.end(),
+            [&](cu64 a_, cu64 b_)
+            {
+              return (hash_at(a_) < hash_at(b_));
+            });
+
+  tmppath = filepath_ + ".tmp";
+  f = ::fopen(tmppath.c_str(),"w");
+  if(f == NULL)
+    return -errno;
+
+  ::fwrite(&hdr,sizeof(hdr),1,f);
+  for(cu64 i : order)
+    ::fwrite(&_records[i * _recsize],_recsize,1,f);
+
+  if(::fflush(f) || ::fsync(::fileno(f)) || ::ferror(f))
+    {
+      int err = errno;
+      ::fclose(f);
+      ::unlink(tmppath.c_str());
+      return -err;
+    }
+  ::fclose(f);
+
+  if(::rename(tmppath.c_str(),filepath_.c_str()) < 0)
+    {
+      int err = errno;
+      ::unlink(tmppath.c_str());
+      return -err;
+    }
+
+  return 0;
+}
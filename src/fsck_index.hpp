@@ -0,0 +1,116 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  FSCK INDEX
+  ==========
+
+  A compact on disk index used by `fsck.mergerfs --index` to skip
+  comparing files which have not changed since the previous run. One
+  record per name found on more than one branch keyed by a hash of
+  its path relative to the mountpoint. Each record holds the size,
+  mtime, ctime, mode, uid and gid of every copy (mode 0 when absent)
+  along with flags.
+
+  The file is a header followed by records sorted by hash so it can
+  be mmap'ed and binary searched without being parsed. A new index
+  is written to a temporary file and renamed over the old one once a
+  scan completes.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+
+#define FSCK_INDEX_MAGIC   "MFSFSCKI"
+#define FSCK_INDEX_VERSION 2
+
+namespace FsckIndex
+{
+  enum
+    {
+      FLAG_MISMATCH = (1 << 0)
+    };
+
+  struct BranchStat
+  {
+    u64 size;
+    s64 mtime_sec;
+    s64 ctime_sec;
+    u32 mtime_nsec;
+    u32 ctime_nsec;
+    u32 mode;
+    u32 uid;
+    u32 gid;
+    u32 reserved;
+  };
+
+  void set(BranchStat &bs, const struct stat &st);
+
+  u64 hash(const std::string &relpath);
+
+  class Reader
+  {
+  public:
+    Reader();
+    ~Reader();
+
+  public:
+    int open(const std::string &filepath,
+             cu64               confighash,
+             cu32               nbranches);
+
+    const BranchStat* lookup(cu64  hash,
+                             u32  *flags) const;
+
+    u64 count() const;
+
+  private:
+    const char *_data;
+    u64       _size;
+    u64       _count;
+    u64       _recsize;
+  };
+
+  class Writer
+  {
+  public:
+    Writer(cu32 nbranches);
+
+  public:
+    void add(cu64              hash,
+             cu32              flags,
+             const BranchStat *stats);
+
+    int write(const std::string &filepath,
+              cu64               confighash);
+
+  private:
+    u32             _nbranches;
+    u64             _recsize;
+    std::mutex      _mutex;
+    std::vector<char> _records;
+  };
+}
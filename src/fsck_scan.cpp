@@ -0,0 +1,260 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "fsck_scan.hpp"
+
+#include "fs_close.hpp"
+#include "fs_dirent64.hpp"
+#include "fs_fstatat.hpp"
+#include "fs_getdents64.hpp"
+#include "fs_open.hpp"
+
+#include "scope_guard/scope_guard.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+#include <dirent.h>
+
+#define GETDENTS_BUFSIZE (128 * 1024)
+
+
+namespace l
+{
+  // Branch index in the upper bits, d_type in the lowest byte.
+  typedef SmallVec<u32,4> BranchTypeVec;
+}
+
+static
+std::string
+_join(const std::string &a_,
+      const std::string &b_)
+{
+  if(a_.empty())
+    return b_;
+  if(b_.empty())
+    return a_;
+  return a_ + '/' + b_;
+}
+
+// With an index a name whose copies all have the same size, mtime,
+// ctime, mode and owner as in the last run, when they matched, is not
+// compared again. Every copy is still stat'ed: a file rewritten in
+// place or appended to does not change its directory's mtime so
+// nothing short of a stat will notice.
+static
+bool
+_unchanged(FsckScan::Scan                     &scan_,
+           const std::string                  &relpath_,
+           const PathStatVec                  &pathstats_,
+           const l::BranchTypeVec             &brtypes_,
+           std::vector<FsckIndex::BranchStat> &filestats_,
+           u32                                *flags_)
+{
+  u64 hash;
+  const FsckIndex::BranchStat *prev;
+
+  filestats_.assign(scan_.branches.size(),FsckIndex::BranchStat{});
+  for(u64 i = 0; i < pathstats_.size(); i++)
+    {
+      const u32 bidx = (brtypes_[i] >> 8);
+
+      if(pathstats_[i].st.st_size < 0)
+        return false;
+
+      FsckIndex::set(filestats_[bidx],pathstats_[i].st);
+    }
+
+  hash = FsckIndex::hash(relpath_);
+  prev = scan_.index_in.lookup(hash,flags_);
+
+  return (prev &&
+          !(*flags_ & FsckIndex::FLAG_MISMATCH) &&
+          (std::memcmp(prev,
+                       filestats_.data(),
+                       filestats_.size() * sizeof(FsckIndex::BranchStat)) == 0));
+}
+
+static
+void
+_check_names(FsckScan::Scan                                         &scan_,
+             const std::string                                      &relpath_,
+             const std::vector<int>                                 &fds_,
+             const std::unordered_map<std::string,l::BranchTypeVec> &names_,
+             FsckScan::DirQueue                                     &queue_,
+             const u64                                               idx_)
+{
+  int rv;
+  u32 flags;
+  u64 mismatches;
+  PathStatVec pathstats;
+  std::vector<FsckIndex::BranchStat> filestats;
+
+  mismatches = 0;
+  for(const auto &[name,brtypes] : names_)
+    {
+      bool isdir;
+      bool unknown;
+      bool differ;
+      std::string namepath;
+
+      isdir   = false;
+      unknown = false;
+      for(const u32 brtype : brtypes)
+        {
+          const u32 type = (brtype & 0xFF);
+
+          isdir   |= (type == DT_DIR);
+          unknown |= (type == DT_UNKNOWN);
+        }
+
+      pathstats.clear();
+      if((brtypes.size() > 1) || (unknown && !isdir))
+        {
+          for(const u32 brtype : brtypes)
+            {
+              const u32 bidx = (brtype >> 8);
+
+              PathStat &ps = pathstats.emplace_back(scan_.branches[bidx]);
+
+              ps.path += '/';
+              ps.path += ::_join(relpath_,name);
+              rv = fs::fstatat_nofollow(fds_[bidx],name.c_str(),&ps.st);
+              scan_.stats.fetch_add(1,std::memory_order_relaxed);
+              if(rv < 0)
+                ps.st.st_size = rv;
+              else if(S_ISDIR(ps.st.st_mode))
+                isdir = true;
+            }
+        }
+
+      namepath = ::_join(relpath_,name);
+      if(pathstats.size() > 1)
+        {
+          scan_.duplicates.fetch_add(1,std::memory_order_relaxed);
+
+          flags = 0;
+          if(scan_.index_out &&
+             ::_unchanged(scan_,namepath,pathstats,brtypes,filestats,&flags))
+            {
+              scan_.skipped.fetch_add(1,std::memory_order_relaxed);
+              differ = false;
+            }
+          else
+            {
+              std::lock_guard<std::mutex> lk(scan_.report_mutex);
+              differ = scan_.report(scan_.mountpoint / namepath,pathstats);
+            }
+
+          if(differ)
+            mismatches++;
+          if(scan_.index_out)
+            scan_.index_out->add(FsckIndex::hash(namepath),
+                                 (differ ? FsckIndex::FLAG_MISMATCH : 0),
+                                 filestats.data());
+        }
+
+      if(isdir)
+        queue_.push(idx_,std::move(namepath));
+    }
+
+  scan_.entries.fetch_add(names_.size(),std::memory_order_relaxed);
+  scan_.mismatches.fetch_add(mismatches,std::memory_order_relaxed);
+}
+
+// Reads the directory from every branch with getdents64 and merges
+// the listings by name so only names found on more than one branch
+// need to be stat'ed.
+void
+FsckScan::scan_dir(Scan              &scan_,
+                   const std::string &relpath_,
+                   std::vector<char> &buf_,
+                   DirQueue          &queue_,
+                   cu64               idx_)
+{
+  std::vector<int> fds;
+  std::unordered_map<std::string,l::BranchTypeVec> names;
+
+  fds.resize(scan_.branches.size(),-1);
+  DEFER
+    {
+      for(const int fd : fds)
+        if(fd >= 0)
+          fs::close(fd);
+    };
+
+  for(u32 bidx = 0; bidx < scan_.branches.size(); bidx++)
+    {
+      int fd;
+
+      fd = fs::open_dir_ro(::_join(scan_.branches[bidx],relpath_));
+      if(fd < 0)
+        continue;
+      fds[bidx] = fd;
+    }
+
+  for(u32 bidx = 0; bidx < scan_.branches.size(); bidx++)
+    {
+      const int fd = fds[bidx];
+
+      if(fd < 0)
+        continue;
+
+      while(true)
+        {
+          ssize_t nread;
+
+          nread = fs::getdents64(fd,buf_.data(),buf_.size());
+          if(nread <= 0)
+            break;
+
+          for(ssize_t pos = 0; pos < nread;)
+            {
+              fs::dirent64 *d = reinterpret_cast<fs::dirent64*>(&buf_[pos]);
+
+              pos += d->reclen;
+
+              if((d->name[0] == '.') &&
+                 ((d->name[1] == '\0') ||
+                  ((d->name[1] == '.') && (d->name[2] == '\0'))))
+                continue;
+
+              names[d->name].push_back((bidx << 8) | d->type);
+            }
+        }
+    }
+
+  ::_check_names(scan_,relpath_,fds,names,queue_,idx_);
+
+  scan_.dirs.fetch_add(1,std::memory_order_relaxed);
+}
+
+void
+FsckScan::scan_thread(Scan     &scan_,
+                      DirQueue &queue_,
+                      cu64      idx_)
+{
+  std::string relpath;
+  std::vector<char> buf(GETDENTS_BUFSIZE);
+
+  while(queue_.pop(idx_,relpath))
+    {
+      FsckScan::scan_dir(scan_,relpath,buf,queue_,idx_);
+      queue_.done();
+    }
+}
@@ -0,0 +1,201 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  FSCK BRANCH SCAN
+  ================
+
+  The scanner behind `fsck.mergerfs --branches`. Directories are read
+  directly from every branch in parallel, listings are merged by name
+  and only names found on more than one branch are stat'ed and passed
+  to `report`. With an index, names whose copies are unchanged since
+  they last matched are counted as `skipped` rather than reported.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "fsck_index.hpp"
+#include "smallvec.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+
+struct PathStat
+{
+  PathStat(const std::string &path_)
+    : path(path_),
+      st{}
+  {
+  }
+
+  std::string path;
+  struct stat st;
+};
+
+using PathStatVec = std::vector<PathStat>;
+
+namespace FsckScan
+{
+  // Work stealing queue of relative directory paths. Each scanner
+  // thread pushes and pops the newest entry on its own deque
+  // (depth first, keeping its working set small) and when empty
+  // steals the oldest entry from another thread's deque (likely a
+  // large, not yet started subtree).
+  class DirQueue
+  {
+  public:
+    DirQueue(const u64 nthreads_)
+      : _deques(nthreads_),
+        _pending(0)
+    {
+    }
+
+  public:
+    void
+    push(const u64    idx_,
+         std::string &&relpath_)
+    {
+      Deque &d = _deques[idx_];
+
+      _pending.fetch_add(1,std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lk(d.mutex);
+      d.paths.emplace_back(std::move(relpath_));
+    }
+
+    // Called once a popped directory, and the pushing of its
+    // children, is complete.
+    void
+    done()
+    {
+      _pending.fetch_sub(1,std::memory_order_release);
+    }
+
+    bool
+    pop(const u64    idx_,
+        std::string &relpath_)
+    {
+      const u64 n = _deques.size();
+
+      while(true)
+        {
+          if(_pop_back(_deques[idx_],relpath_))
+            return true;
+
+          for(u64 i = 1; i < n; i++)
+            {
+              if(_pop_front(_deques[(idx_ + i) % n],relpath_))
+                return true;
+            }
+
+          if(_pending.load(std::memory_order_acquire) == 0)
+            return false;
+
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+  private:
+    struct Deque
+    {
+      std::mutex              mutex;
+      std::deque<std::string> paths;
+    };
+
+    static
+    bool
+    _pop_back(Deque       &d_,
+              std::string &relpath_)
+    {
+      std::lock_guard<std::mutex> lk(d_.mutex);
+
+      if(d_.paths.empty())
+        return false;
+
+      relpath_ = std::move(d_.paths.back());
+      d_.paths.pop_back();
+
+      return true;
+    }
+
+    static
+    bool
+    _pop_front(Deque       &d_,
+               std::string &relpath_)
+    {
+      std::lock_guard<std::mutex> lk(d_.mutex);
+
+      if(d_.paths.empty())
+        return false;
+
+      relpath_ = std::move(d_.paths.front());
+      d_.paths.pop_front();
+
+      return true;
+    }
+
+  private:
+    std::vector<Deque> _deques;
+    std::atomic<u64>   _pending;
+  };
+
+  // Called, serialized, with the stat'ed copies of a name found on
+  // more than one branch. Returns true if they differ.
+  using ReportFunc = std::function<bool(const std::string&,const PathStatVec&)>;
+
+  struct Scan
+  {
+    std::filesystem::path    mountpoint;
+    std::vector<std::string> branches;
+    ReportFunc               report;
+
+    FsckIndex::Reader                  index_in;
+    std::unique_ptr<FsckIndex::Writer> index_out;
+
+    std::mutex       report_mutex;
+    std::atomic<u64> dirs{0};
+    std::atomic<u64> skipped{0};
+    std::atomic<u64> entries{0};
+    std::atomic<u64> stats{0};
+    std::atomic<u64> duplicates{0};
+    std::atomic<u64> mismatches{0};
+  };
+
+  void scan_dir(Scan              &scan,
+                const std::string &relpath,
+                std::vector<char> &buf,
+                DirQueue          &queue,
+                cu64               idx);
+
+  void scan_thread(Scan     &scan,
+                   DirQueue &queue,
+                   cu64      idx);
+}
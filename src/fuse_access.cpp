@@ -22,6 +22,7 @@
 #include "errno.hpp"
 #include "fs_eaccess.hpp"
 #include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
 
 #include <string>
 #include <vector>
@@ -36,8 +37,7 @@ _access(const Policy::Search &searchFunc_,
 {
   int rv;
   StrVec basepaths;
-  fs::path fullpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = searchFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -45,9 +45,9 @@ _access(const Policy::Search &searchFunc_,
   if(branches.empty())
     return -ENOENT;
 
-  fullpath = branches[0]->path / fusepath_;
+  const fs::PathBuf fullpath(branches[0]->path,fusepath_);
 
-  rv = fs::eaccess(fullpath,mask_);
+  rv = fs::eaccess(fullpath.c_str(),mask_);
 
   return rv;
 }
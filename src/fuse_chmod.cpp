@@ -20,9 +20,12 @@
 
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_lchmod.hpp"
 #include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -31,33 +34,38 @@
 
 
 static
-void
+int
 _chmod_loop_core(const std::string &basepath_,
                  const fs::path    &fusepath_,
-                 const mode_t       mode_,
-                 PolicyRV          *prv_)
+                 const mode_t       mode_)
 {
   int rv;
-  fs::path fullpath;
-
-  fullpath = basepath_ / fusepath_;
+  const fs::PathBuf fullpath(basepath_,fusepath_);
 
-  rv = fs::lchmod(fullpath,mode_);
+  rv = fs::lchmod(fullpath.c_str(),mode_);
 
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_chmod_loop(const std::vector<Branch*> &branches_,
-            const fs::path             &fusepath_,
-            const mode_t                mode_,
-            PolicyRV                   *prv_)
+_chmod_loop(const BranchPtrVec &branches_,
+            const fs::path     &fusepath_,
+            const mode_t        mode_,
+            PolicyRV           *prv_)
 {
-  for(auto &branch : branches_)
-    {
-      ::_chmod_loop_core(branch->path,fusepath_,mode_,prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_chmod_loop_core(branch_.path,fusepath_,mode_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -70,7 +78,7 @@ _chmod(const Policy::Action &actionFunc_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = actionFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -20,9 +20,12 @@
 
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_lchown.hpp"
 #include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -31,35 +34,40 @@
 
 
 static
-void
+int
 _chown_loop_core(const fs::path &basepath_,
                  const fs::path &fusepath_,
                  const uid_t     uid_,
-                 const gid_t     gid_,
-                 PolicyRV       *prv_)
+                 const gid_t     gid_)
 {
   int rv;
-  fs::path fullpath;
-
-  fullpath = basepath_ / fusepath_;
+  const fs::PathBuf fullpath(basepath_,fusepath_);
 
-  rv = fs::lchown(fullpath,uid_,gid_);
+  rv = fs::lchown(fullpath.c_str(),uid_,gid_);
 
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_chown_loop(const std::vector<Branch*> &branches_,
-            const fs::path             &fusepath_,
-            const uid_t                 uid_,
-            const gid_t                 gid_,
-            PolicyRV                   *prv_)
+_chown_loop(const BranchPtrVec &branches_,
+            const fs::path     &fusepath_,
+            const uid_t         uid_,
+            const gid_t         gid_,
+            PolicyRV           *prv_)
 {
-  for(const auto &branch : branches_)
-    {
-      ::_chown_loop_core(branch->path,fusepath_,uid_,gid_,prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_chown_loop_core(branch_.path,fusepath_,uid_,gid_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -73,7 +81,7 @@ _chown(const Policy::Action &actionFunc_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = actionFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -45,6 +45,8 @@
 
 #include "fuse_create.hpp"
 
+#include "attr_cache.hpp"
+#include "branch_stats.hpp"
 #include "state.hpp"
 #include "config.hpp"
 
@@ -186,12 +188,15 @@ _create_core(const ugid_t      ugid_,
              const mode_t      umask_)
 {
   int rv;
+  u64 start;
   FileInfo *fi;
   fs::path fullpath;
 
   fullpath = branch_->path / fusepath_;
 
+  start = fuse_stats_now_ns();
   rv = ::_create_core(ugid_,fullpath,mode_,umask_,ffi_->flags);
+  BranchStats::record(branch_->path.native(),BranchStats::OPEN,rv,start);
   if(rv < 0)
     return rv;
 
@@ -216,8 +221,8 @@ _create(const ugid_t          ugid_,
   int rv;
   fs::path fullpath;
   fs::path fusedirpath;
-  std::vector<Branch*> createpaths;
-  std::vector<Branch*> existingpaths;
+  BranchPtrVec createpaths;
+  BranchPtrVec existingpaths;
 
   fusedirpath = fusepath_.parent_path();
 
@@ -299,6 +304,9 @@ _create(const fuse_req_ctx_t *ctx_,
   if(not fi)
     return -EBADF;
 
+  fi->writable = !::_rdonly(ffi_->flags);
+  fi->writers.store(fi->writable,std::memory_order_relaxed);
+
   switch(_(cfg.passthrough_io,ffi_->flags))
     {
     case _(PassthroughIO::ENUM::RO,O_RDONLY):
@@ -349,7 +357,12 @@ FUSE::create(const fuse_req_ctx_t *ctx_,
              mode_t                mode_,
              fuse_file_info_t     *ffi_)
 {
+  int rv;
   const fs::path fusepath{fusepath_};
 
-  return ::_create(ctx_,fusepath,mode_,ffi_);
+  rv = ::_create(ctx_,fusepath,mode_,ffi_);
+
+  AttrCache::invalidate(ctx_->nodeid);
+
+  return rv;
 }
@@ -18,8 +18,12 @@
 
 #include "fuse_destroy.hpp"
 
+#include "branch_watch.hpp"
+#include "stats_shm.hpp"
+
 void
 FUSE::destroy(void)
 {
-
+  BranchWatch::stop();
+  StatsShm::enable(false);
 }
@@ -18,11 +18,14 @@
 
 #include "fuse_fallocate.hpp"
 
+#include "attr_cache.hpp"
 #include "state.hpp"
 
 #include "errno.hpp"
 #include "fileinfo.hpp"
 #include "fs_fallocate.hpp"
+#include "fuse_write.hpp"
+#include "relocation.hpp"
 
 #include "fuse.h"
 
@@ -55,14 +58,27 @@ FUSE::fallocate(const fuse_req_ctx_t *ctx_,
                 off_t                 offset_,
                 off_t                 len_)
 {
+  int rv;
   FileInfo *fi;
+  Relocation *r;
 
   fi = state.get_fi(ctx_,fh_);
   if(not fi)
     return -EBADF;
 
-  return ::_fallocate(fi->fd,
-                      mode_,
-                      offset_,
-                      len_);
+  rv = FUSE::write_coalesce_flush(fi);
+  if(rv < 0)
+    return rv;
+
+  r  = fi->relocation.load(std::memory_order_acquire);
+  rv = (r ?
+        r->fallocate(mode_,offset_,len_) :
+        ::_fallocate(fi->fd,
+                     mode_,
+                     offset_,
+                     len_));
+
+  AttrCache::invalidate(ctx_->nodeid);
+
+  return rv;
 }
@@ -18,14 +18,18 @@
 
 #include "fuse_fgetattr.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "fileinfo.hpp"
 #include "fs_fstat.hpp"
 #include "fs_inode.hpp"
+#include "fuse_write.hpp"
+#include "relocation.hpp"
 #include "state.hpp"
 
 #include "fuse.h"
+#include "fuse_kernel.h"
 
 
 static
@@ -34,8 +38,10 @@ _fgetattr(const FileInfo  *fi_,
           struct stat     *st_)
 {
   int rv;
+  Relocation *r;
 
-  rv = fs::fstat(fi_->fd,st_);
+  r  = fi_->relocation.load(std::memory_order_acquire);
+  rv = (r ? r->fstat(st_) : fs::fstat(fi_->fd,st_));
   if(rv < 0)
     return rv;
 
@@ -66,7 +72,13 @@ FUSE::fgetattr(const fuse_req_ctx_t *ctx_,
   if(not fi)
     return -EBADF;
 
-  rv = ::_fgetattr(fi,st_);
+  if(ctx_->opcode == FUSE_SETATTR)
+    AttrCache::invalidate(ctx_->nodeid);
+
+  // Buffered writes would otherwise be missing from st_size.
+  rv = FUSE::write_coalesce_flush(fi);
+  if(rv == 0)
+    rv = ::_fgetattr(fi,st_);
 
   timeout_->entry = ((rv >= 0) ?
                      cfg.cache_entry :
@@ -22,6 +22,7 @@
 #include "fileinfo.hpp"
 #include "fs_close.hpp"
 #include "fs_dup.hpp"
+#include "fuse_write.hpp"
 #include "state.hpp"
 
 #include "fuse.h"
@@ -51,11 +52,16 @@ int
 FUSE::flush(const fuse_req_ctx_t   *ctx_,
             const fuse_file_info_t *ffi_)
 {
+  int err;
   FileInfo *fi;
 
   fi = state.get_fi(ctx_,ffi_->fh);
   if(not fi)
     return -EBADF;
 
+  err = FUSE::write_coalesce_flush(fi);
+  if(err < 0)
+    return err;
+
   return ::_flush(fi->fd);
 }
@@ -18,10 +18,13 @@
 
 #include "fuse_fsync.hpp"
 
+#include "branch_stats.hpp"
 #include "errno.hpp"
 #include "fileinfo.hpp"
 #include "fs_fdatasync.hpp"
 #include "fs_fsync.hpp"
+#include "fuse_write.hpp"
+#include "relocation.hpp"
 #include "state.hpp"
 #include "to_neg_errno.hpp"
 
@@ -57,11 +60,26 @@ FUSE::fsync(const fuse_req_ctx_t *ctx_,
             cu64                  fh_,
             int                   isdatasync_)
 {
+  int err;
+  u64 start;
   FileInfo *fi;
+  Relocation *r;
 
   fi = state.get_fi(ctx_,fh_);
   if(not fi)
     return -EBADF;
 
-  return ::_fsync(fi->fd,isdatasync_);
+  err = FUSE::write_coalesce_flush(fi);
+  if(err < 0)
+    return err;
+
+  start = fuse_stats_now_ns();
+  r = fi->relocation.load(std::memory_order_acquire);
+  if(r)
+    err = r->fsync(isdatasync_);
+  else
+    err = ::_fsync(fi->fd,isdatasync_);
+  BranchStats::record(fi->stats,BranchStats::SYNC,err,start);
+
+  return err;
 }
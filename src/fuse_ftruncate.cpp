@@ -21,6 +21,8 @@
 #include "errno.hpp"
 #include "fileinfo.hpp"
 #include "fs_ftruncate.hpp"
+#include "fuse_write.hpp"
+#include "relocation.hpp"
 #include "state.hpp"
 
 #include "fuse.h"
@@ -50,11 +52,21 @@ FUSE::ftruncate(const fuse_req_ctx_t *ctx_,
                 cu64                  fh_,
                 off_t                 size_)
 {
+  int err;
   FileInfo *fi;
+  Relocation *r;
 
   fi = state.get_fi(ctx_,fh_);
   if(not fi)
     return -EBADF;
 
+  err = FUSE::write_coalesce_flush(fi);
+  if(err < 0)
+    return err;
+
+  r = fi->relocation.load(std::memory_order_acquire);
+  if(r)
+    return r->ftruncate(size_);
+
   return ::_ftruncate(fi->fd,size_);
 }
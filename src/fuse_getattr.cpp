@@ -18,6 +18,7 @@
 
 #include "fuse_getattr.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "fs_fstat.hpp"
@@ -26,24 +27,28 @@
 #include "fs_path.hpp"
 #include "fs_stat.hpp"
 #include "fuse_fgetattr.hpp"
+#include "fuse_write.hpp"
+#include "hot_nodes.hpp"
 #include "state.hpp"
 #include "str.hpp"
 #include "symlinkify.hpp"
 
 #include "fuse.h"
+#include "fuse_kernel.h"
 
 #include <string>
 
 
 static
 void
-_set_stat_if_leads_to_dir(const fs::path &path_,
+_set_stat_if_leads_to_dir(const Branch   &branch_,
+                          const fs::path &fusepath_,
                           struct stat    *st_)
 {
   int rv;
   struct stat st;
 
-  rv = fs::stat(path_,&st);
+  rv = fs::stat(branch_,fusepath_,&st);
   if(rv < 0)
     return;
 
@@ -55,13 +60,14 @@ _set_stat_if_leads_to_dir(const fs::path &path_,
 
 static
 void
-_set_stat_if_leads_to_reg(const fs::path &path_,
+_set_stat_if_leads_to_reg(const Branch   &branch_,
+                          const fs::path &fusepath_,
                           struct stat    *st_)
 {
   int rv;
   struct stat st;
 
-  rv = fs::stat(path_,&st);
+  rv = fs::stat(branch_,fusepath_,&st);
   if(rv < 0)
     return;
 
@@ -133,11 +139,14 @@ _getattr(const Policy::Search &searchFunc_,
          struct stat          *st_,
          const bool            symlinkify_,
          const time_t          symlinkify_timeout_,
-         FollowSymlinks        followsymlinks_)
+         FollowSymlinks        followsymlinks_,
+         AttrCache::Entry     *entry_)
 {
   int rv;
   fs::path fullpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
+  bool cacheable;
+  u64 fingerprint;
 
   rv = searchFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -145,47 +154,79 @@ _getattr(const Policy::Search &searchFunc_,
   if(branches.empty())
     return -ENOENT;
 
-  fullpath = branches[0]->path / fusepath_;
+  const Branch &branch = *branches[0];
 
+  // Only results which can be revalidated with a single syscall
+  // against the same branch path are cacheable. A symlink resolved
+  // for the DIRECTORY and REGULAR modes depends on the target as well
+  // as the link.
+  cacheable   = true;
+  fingerprint = 0;
   switch(followsymlinks_)
     {
     case FollowSymlinks::ENUM::NEVER:
-      rv = fs::lstat(fullpath,st_);
+      rv = fs::lstat(branch,fusepath_,st_);
       break;
     case FollowSymlinks::ENUM::DIRECTORY:
-      rv = fs::lstat(fullpath,st_);
+      rv = fs::lstat(branch,fusepath_,st_);
       if((rv >= 0) && S_ISLNK(st_->st_mode))
-        ::_set_stat_if_leads_to_dir(fullpath,st_);
+        {
+          cacheable = false;
+          ::_set_stat_if_leads_to_dir(branch,fusepath_,st_);
+        }
       break;
     case FollowSymlinks::ENUM::REGULAR:
-      rv = fs::lstat(fullpath,st_);
+      rv = fs::lstat(branch,fusepath_,st_);
       if((rv >= 0) && S_ISLNK(st_->st_mode))
-        ::_set_stat_if_leads_to_reg(fullpath,st_);
+        {
+          cacheable = false;
+          ::_set_stat_if_leads_to_reg(branch,fusepath_,st_);
+        }
       break;
     case FollowSymlinks::ENUM::ALL:
-      rv = fs::stat(fullpath,st_);
+      rv = fs::stat(branch,fusepath_,st_);
       if(rv < 0)
-        rv = fs::lstat(fullpath,st_);
+        {
+          cacheable = false;
+          rv = fs::lstat(branch,fusepath_,st_);
+        }
       break;
     }
 
   if(rv < 0)
     return rv;
 
+  if(entry_ && cacheable)
+    fingerprint = AttrCache::fingerprint(*st_);
+
   if(symlinkify_ && symlinkify::can_be_symlink(*st_,symlinkify_timeout_))
-    symlinkify::convert(fullpath,st_);
+    {
+      fullpath = branch.path / fusepath_;
+      symlinkify::convert(fullpath,st_);
+    }
 
-  fs::inode::calc(branches[0]->path,
+  fs::inode::calc(branch.path,
                   fusepath_,
                   st_);
 
+  if(entry_ && cacheable)
+    {
+      entry_->fusepath    = fusepath_;
+      entry_->branch      = branch.path;
+      entry_->follow      = (followsymlinks_ == FollowSymlinks::ENUM::ALL);
+      entry_->fingerprint = fingerprint;
+      entry_->st          = *st_;
+    }
+
   return 0;
 }
 
+static
 int
-_getattr(const fs::path  &fusepath_,
-         struct stat     *st_,
-         fuse_timeouts_t *timeout_)
+_getattr(const fs::path   &fusepath_,
+         struct stat      *st_,
+         fuse_timeouts_t  *timeout_,
+         AttrCache::Entry *entry_ = nullptr)
 {
   int rv;
 
@@ -195,7 +236,8 @@ _getattr(const fs::path  &fusepath_,
                   st_,
                   cfg.symlinkify,
                   cfg.symlinkify_timeout,
-                  cfg.follow_symlinks);
+                  cfg.follow_symlinks,
+                  entry_);
   if((rv < 0) && Config::is_rootdir(fusepath_))
     return ::_getattr_fake_root(st_,timeout_);
 
@@ -207,6 +249,36 @@ _getattr(const fs::path  &fusepath_,
   return rv;
 }
 
+static
+int
+_getattr_cached(cu64             nodeid_,
+                const fs::path  &fusepath_,
+                struct stat     *st_,
+                fuse_timeouts_t *timeout_)
+{
+  int rv;
+  bool hit;
+  AttrCache::Entry entry;
+
+  hit = AttrCache::get(nodeid_,
+                       fusepath_,
+                       cfg.cache_attr_user,
+                       cfg.cache_attr_user_validate,
+                       st_);
+  if(hit)
+    {
+      timeout_->entry = cfg.cache_entry;
+      timeout_->attr  = cfg.cache_attr;
+      return 0;
+    }
+
+  rv = ::_getattr(fusepath_,st_,timeout_,&entry);
+  if((rv >= 0) && !entry.branch.empty())
+    AttrCache::set(nodeid_,std::move(entry));
+
+  return rv;
+}
+
 int
 FUSE::getattr(const fuse_req_ctx_t *ctx_,
               const char           *fusepath_,
@@ -224,6 +296,25 @@ FUSE::getattr(const fuse_req_ctx_t *ctx_,
               struct stat          *st_,
               fuse_timeouts_t      *timeout_)
 {
+  // The size must include writes buffered on an open handle.
+  if(cfg.write_coalesce &&
+     ((ctx_->opcode == FUSE_GETATTR) || (ctx_->opcode == FUSE_SETATTR)))
+    FUSE::write_coalesce_flush(ctx_->nodeid);
+
+  // SETATTR always finishes with a getattr of the same node.
+  if(ctx_->opcode == FUSE_SETATTR)
+    AttrCache::invalidate(ctx_->nodeid);
+  // Lookups count toward the directory searched.
+  else if(ctx_->opcode == FUSE_LOOKUP)
+    HotNodes::touch(ctx_->nodeid);
+
+  // Only GETATTR requests carry the nodeid of the file being
+  // queried. Others (LOOKUP, LINK, etc.) carry the parent.
+  if((cfg.cache_attr_user > 0) &&
+     (ctx_->opcode == FUSE_GETATTR) &&
+     !Config::is_ctrl_file(fusepath_))
+    return ::_getattr_cached(ctx_->nodeid,fusepath_,st_,timeout_);
+
   return FUSE::getattr(fusepath_,st_,timeout_);
 }
 
@@ -152,7 +152,7 @@ _getxattr(const Policy::Search &searchFunc_,
 {
   int rv;
   fs::path fullpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = searchFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -18,16 +18,27 @@
 
 #include "fuse_init.hpp"
 
+#include "attr_cache.hpp"
+#include "branch_watch.hpp"
 #include "config.hpp"
+#include "fanout.hpp"
+#include "fd_cache.hpp"
+#include "fs_copydata_readwrite.hpp"
 #include "fs_readahead.hpp"
+#include "fs_statvfs_cache.hpp"
+#include "fuse_statfs.hpp"
+#include "hot_nodes.hpp"
+#include "maintenance_thread.hpp"
 #include "procfs.hpp"
 #include "state.hpp"
+#include "stats_shm.hpp"
 #include "syslog.hpp"
 
 #include "fs_path.hpp"
 #include "fs_exists.hpp"
 
 #include "fuse.h"
+#include "fuse_slowlog.hpp"
 
 #include <algorithm>
 #include <fstream>
@@ -184,6 +195,58 @@ _spawn_thread_to_set_readahead()
   readahead_thread.detach();
 }
 
+static
+void
+_prune_attr_cache(u64 count_)
+{
+  (void)count_;
+
+  AttrCache::prune(cfg.cache_attr_user);
+}
+
+static
+void
+_decay_hot_nodes(u64 count_)
+{
+  (void)count_;
+
+  HotNodes::decay();
+}
+
+static
+void
+_prune_fd_cache(u64 count_)
+{
+  (void)count_;
+
+  FdCache::prune(60);
+}
+
+static
+void
+_refresh_statfs_cache(u64 count_)
+{
+  (void)count_;
+
+  FUSE::statfs_cache_refresh();
+}
+
+static
+void
+_revalidate_branch_fds(u64 count_)
+{
+  Branches::Ptr branches;
+
+  (void)count_;
+
+  if(!Branch::fds_enabled())
+    return;
+
+  branches = cfg.branches;
+  for(const auto &branch : *branches)
+    branch.revalidate_fd();
+}
+
 void *
 FUSE::init(fuse_conn_info_t *conn_)
 {
@@ -212,6 +275,23 @@ FUSE::init(fuse_conn_info_t *conn_)
 
   ::_spawn_thread_to_set_readahead();
 
+  Branch::fds_enabled(cfg.cache_branch_fds);
+  BranchWatch::sync(cfg.cache_branch_watch,cfg.branches);
+  fs::statvfs_cache_timeout(cfg.cache_statfs);
+  FdCache::capacity(cfg.cache_fd_reuse);
+  Fanout::threads(cfg.fanout_thread_count);
+  fuse_slowlog_threshold_ms(cfg.log_slow_ops);
+  HotNodes::enable(cfg.stats_hot_nodes);
+  StatsShm::enable(cfg.stats_shm);
+  fs::copydata_readwrite_config(cfg.copy_chunk_size * 1024,
+                                cfg.copy_inflight);
+
+  MaintenanceThread::push_job(::_prune_attr_cache);
+  MaintenanceThread::push_job(::_prune_fd_cache);
+  MaintenanceThread::push_job(::_decay_hot_nodes);
+  MaintenanceThread::push_job(::_revalidate_branch_fds);
+  MaintenanceThread::push_job(::_refresh_statfs_cache);
+
   if(!(conn_->capable & FUSE_CAP_PASSTHROUGH) &&
      (cfg.passthrough_io != PassthroughIO::ENUM::OFF))
     {
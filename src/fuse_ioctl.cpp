@@ -33,6 +33,7 @@
 #include "fs_path.hpp"
 #include "mergerfs_ioctl.hpp"
 #include "state.hpp"
+#include "stats_snapshot.hpp"
 #include "str.hpp"
 
 #include <string>
@@ -139,7 +140,7 @@ _ioctl_dir_base(const Policy::Search &searchFunc_,
   int fd;
   int rv;
   fs::path fullpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = searchFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -181,6 +182,24 @@ _ioctl_dir(const fuse_req_ctx_t   *ctx_,
                            out_bufsz_);
 }
 
+static
+int
+_ioctl_stats(void *data_,
+             u32  *out_bufsz_)
+{
+  mergerfs_ioctl_t *ioc;
+  mergerfs_stats_req_t req;
+
+  if((data_ == NULL) || (*out_bufsz_ < sizeof(mergerfs_ioctl_t)))
+    return -EINVAL;
+
+  ioc = (mergerfs_ioctl_t*)data_;
+  memcpy(&req,ioc->buf,sizeof(req));
+  ioc->size = StatsSnapshot::fill(ioc->buf,sizeof(ioc->buf),req.branch_offset);
+
+  return 0;
+}
+
 static
 bool
 _is_btrfs_ioctl_cmd(const unsigned long cmd_)
@@ -199,6 +218,8 @@ FUSE::ioctl(const fuse_req_ctx_t   *ctx_,
 {
   if(::_is_btrfs_ioctl_cmd(cmd_))
     return -ENOTTY;
+  if(cmd_ == MERGERFS_IOCTL_STATS)
+    return ::_ioctl_stats(data_,out_bufsz_);
 
   if(flags_ & FUSE_IOCTL_DIR)
     return ::_ioctl_dir(ctx_,ffi_,cmd_,data_,out_bufsz_);
@@ -18,6 +18,7 @@
 
 #include "fuse_link.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "fs_clonepath.hpp"
@@ -36,11 +37,11 @@
 
 static
 int
-_link_create_path_loop(const std::vector<Branch*> &oldbranches_,
-                       const Branch               *newbranch_,
-                       const fs::path             &oldfusepath_,
-                       const fs::path             &newfusepath_,
-                       const fs::path             &newfusedirpath_)
+_link_create_path_loop(const BranchPtrVec &oldbranches_,
+                       const Branch       *newbranch_,
+                       const fs::path     &oldfusepath_,
+                       const fs::path     &newfusepath_,
+                       const fs::path     &newfusedirpath_)
 {
   int rv;
   int err;
@@ -80,8 +81,8 @@ _link_create_path(const Policy::Search &searchFunc_,
 {
   int rv;
   fs::path newfusedirpath;
-  std::vector<Branch*> oldbranches;
-  std::vector<Branch*> newbranches;
+  BranchPtrVec oldbranches;
+  BranchPtrVec newbranches;
 
   rv = actionFunc_(ibranches_,oldfusepath_,oldbranches);
   if(rv < 0)
@@ -127,10 +128,10 @@ _link_preserve_path_core(const fs::path &oldbasepath_,
 
 static
 int
-_link_preserve_path_loop(const std::vector<Branch*> &oldbranches_,
-                         const fs::path             &oldfusepath_,
-                         const fs::path             &newfusepath_,
-                         struct stat                *st_)
+_link_preserve_path_loop(const BranchPtrVec &oldbranches_,
+                         const fs::path     &oldfusepath_,
+                         const fs::path     &newfusepath_,
+                         struct stat        *st_)
 {
   int rv;
   int err;
@@ -158,7 +159,7 @@ _link_preserve_path(const Policy::Action &actionFunc_,
                     struct stat          *st_)
 {
   int rv;
-  std::vector<Branch*> oldbranches;
+  BranchPtrVec oldbranches;
 
   rv = actionFunc_(branches_,oldfusepath_,oldbranches);
   if(rv < 0)
@@ -246,7 +247,7 @@ _link_exdev_abs_base_symlink(const fuse_req_ctx_t *ctx_,
 {
   int rv;
   fs::path target;
-  std::vector<Branch*> obranches;
+  BranchPtrVec obranches;
 
   rv = openPolicy_(ibranches_,oldpath_,obranches);
   if(rv < 0)
@@ -346,5 +347,8 @@ FUSE::link(const fuse_req_ctx_t *ctx_,
   if(rv == -EXDEV)
     rv = ::_link_exdev(ctx_,oldpath,newpath,st_,timeouts_);
 
+  AttrCache::invalidate(ctx_->nodeid);
+  AttrCache::invalidate_links(oldpath);
+
   return rv;
 }
@@ -21,6 +21,7 @@
 #include "config.hpp"
 #include "errno.hpp"
 #include "fs_llistxattr.hpp"
+#include "fs_pathbuf.hpp"
 #include "xattr.hpp"
 
 #include "fuse.h"
@@ -32,13 +33,12 @@
 
 static
 ssize_t
-_listxattr_size(const std::vector<Branch*> &branches_,
-                const fs::path             &fusepath_)
+_listxattr_size(const BranchPtrVec &branches_,
+                const fs::path     &fusepath_)
 {
   ssize_t size;
   ssize_t err;
   bool success;
-  fs::path fullpath;
 
   if(branches_.empty())
     return -ENOENT;
@@ -50,9 +50,9 @@ _listxattr_size(const std::vector<Branch*> &branches_,
     {
       ssize_t rv;
 
-      fullpath = branch->path / fusepath_;
+      const fs::PathBuf fullpath(branch->path,fusepath_);
 
-      rv = fs::llistxattr(fullpath,NULL,0);
+      rv = fs::llistxattr(fullpath.c_str(),NULL,0);
       if(rv < 0)
         {
           if(err == -ENOENT)
@@ -72,16 +72,15 @@ _listxattr_size(const std::vector<Branch*> &branches_,
 
 static
 ssize_t
-_listxattr(const std::vector<Branch*> &branches_,
-           const fs::path             &fusepath_,
-           char                       *list_,
-           size_t                      size_)
+_listxattr(const BranchPtrVec &branches_,
+           const fs::path     &fusepath_,
+           char               *list_,
+           size_t              size_)
 {
   ssize_t rv;
   ssize_t size;
   ssize_t err;
   bool success;
-  fs::path fullpath;
 
   if(size_ == 0)
     return ::_listxattr_size(branches_,fusepath_);
@@ -91,9 +90,9 @@ _listxattr(const std::vector<Branch*> &branches_,
   success = false;
   for(const auto branch : branches_)
     {
-      fullpath = branch->path / fusepath_;
+      const fs::PathBuf fullpath(branch->path,fusepath_);
 
-      rv = fs::llistxattr(fullpath,list_,size_);
+      rv = fs::llistxattr(fullpath.c_str(),list_,size_);
       if(rv < 0)
         {
           if(rv == -ERANGE)
@@ -127,7 +126,7 @@ _listxattr(const Policy::Search &searchFunc_,
            const size_t          size_)
 {
   int rv;
-  std::vector<Branch*> obranches;
+  BranchPtrVec obranches;
 
   rv = searchFunc_(ibranches_,fusepath_,obranches);
   if(rv < 0)
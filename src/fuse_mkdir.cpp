@@ -18,6 +18,7 @@
 
 #include "fuse_mkdir.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "error.hpp"
@@ -66,13 +67,13 @@ _mkdir_loop_core(const ugid_t    ugid_,
 
 static
 int
-_mkdir_loop(const ugid_t                ugid_,
-            const Branch               *existingbranch_,
-            const std::vector<Branch*> &createbranches_,
-            const fs::path             &fusepath_,
-            const fs::path             &fusedirpath_,
-            const mode_t                mode_,
-            const mode_t                umask_)
+_mkdir_loop(const ugid_t        ugid_,
+            const Branch       *existingbranch_,
+            const BranchPtrVec &createbranches_,
+            const fs::path     &fusepath_,
+            const fs::path     &fusedirpath_,
+            const mode_t        mode_,
+            const mode_t        umask_)
 {
   int rv;
   Err err;
@@ -110,8 +111,8 @@ _mkdir(const ugid_t          ugid_,
 {
   int rv;
   fs::path fusedirpath;
-  std::vector<Branch*> createbranches;
-  std::vector<Branch*> existingbranches;
+  BranchPtrVec createbranches;
+  BranchPtrVec existingbranches;
 
   fusedirpath = fusepath_.parent_path();
 
@@ -163,5 +164,7 @@ FUSE::mkdir(const fuse_req_ctx_t *ctx_,
                     ctx_->umask);
     }
 
+  AttrCache::invalidate(ctx_->nodeid);
+
   return rv;
 }
@@ -18,6 +18,7 @@
 
 #include "fuse_mknod.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "error.hpp"
@@ -69,14 +70,14 @@ _mknod_loop_core(const ugid_t    ugid_,
 
 static
 int
-_mknod_loop(const ugid_t                ugid_,
-            const fs::path             &existingbranch_,
-            const std::vector<Branch*> &createbranches_,
-            const fs::path             &fusepath_,
-            const fs::path             &fusedirpath_,
-            const mode_t                mode_,
-            const mode_t                umask_,
-            const dev_t                 dev_)
+_mknod_loop(const ugid_t        ugid_,
+            const fs::path     &existingbranch_,
+            const BranchPtrVec &createbranches_,
+            const fs::path     &fusepath_,
+            const fs::path     &fusedirpath_,
+            const mode_t        mode_,
+            const mode_t        umask_,
+            const dev_t         dev_)
 {
   int rv;
   Err err;
@@ -116,8 +117,8 @@ _mknod(const ugid_t          ugid_,
 {
   int rv;
   fs::path fusedirpath;
-  std::vector<Branch*> createbranches;
-  std::vector<Branch*> existingbranches;
+  BranchPtrVec createbranches;
+  BranchPtrVec existingbranches;
 
   fusedirpath = fusepath_.parent_path();
 
@@ -173,5 +174,7 @@ FUSE::mknod(const fuse_req_ctx_t *ctx_,
                     rdev_);
     }
 
+  AttrCache::invalidate(ctx_->nodeid);
+
   return rv;
 }
@@ -86,10 +86,13 @@
 
 #include "state.hpp"
 
+#include "branch_stats.hpp"
 #include "config.hpp"
 #include "errno.hpp"
+#include "fd_cache.hpp"
 #include "fileinfo.hpp"
 #include "fuse_release.hpp"
+#include "fuse_write.hpp"
 #include "fs_close.hpp"
 #include "fs_cow.hpp"
 #include "fs_fchmod.hpp"
@@ -100,13 +103,16 @@
 #include "fs_path.hpp"
 #include "fs_stat.hpp"
 #include "fuse_passthrough.hpp"
+#include "kernel_notify.hpp"
 #include "procfs.hpp"
+#include "replica_balance.hpp"
 #include "stat_util.hpp"
 
 #include "fuse.h"
 
 #include <sched.h>
 
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -262,18 +268,20 @@ _config_to_ffi_flags(const int         tid_,
 
 static
 int
-_open_path(const fs::path    &filepath_,
-           const Branch      *branch_,
+_open_path(const Branch      *branch_,
            const fs::path    &fusepath_,
            fuse_file_info_t  *ffi_,
            const NFSOpenHack  nfsopenhack_)
 {
   int fd;
+  u64 start;
   FileInfo *fi;
 
-  fd = fs::openat(AT_FDCWD,filepath_,ffi_->flags);
+  start = fuse_stats_now_ns();
+  fd = fs::openat(*branch_,fusepath_,ffi_->flags);
   if(fd == -EACCES)
-    fd = ::_nfsopenhack(filepath_,ffi_->flags,nfsopenhack_);
+    fd = ::_nfsopenhack(branch_->path / fusepath_,ffi_->flags,nfsopenhack_);
+  BranchStats::record(branch_->path.native(),BranchStats::OPEN,fd,start);
   if(fd < 0)
     return fd;
 
@@ -305,6 +313,39 @@ _open_fd(const int         fd_,
   return 0;
 }
 
+// A hit on the released fd cache skips the policy and the open.
+static
+int
+_open_reuse(cu64              nodeid_,
+            const fs::path   &fusepath_,
+            fuse_file_info_t *ffi_)
+{
+  int fd;
+  FileInfo *fi;
+  std::optional<Branch> branch;
+
+  if(!::_rdonly(ffi_->flags))
+    return -ENOENT;
+
+  fd = FdCache::take(nodeid_,fusepath_,ffi_->flags,&branch);
+  if(fd < 0)
+    return -ENOENT;
+
+  fi = new FileInfo(fd,*branch,fusepath_,ffi_->direct_io);
+
+  ffi_->fh = fi->to_fh();
+
+  return 0;
+}
+
+static
+bool
+_should_balance(const bool              replica_balance_,
+                const fuse_file_info_t *ffi_)
+{
+  return (replica_balance_ && ((ffi_->flags & O_ACCMODE) == O_RDONLY));
+}
+
 static
 int
 _open(const Policy::Search &searchFunc_,
@@ -312,11 +353,15 @@ _open(const Policy::Search &searchFunc_,
       const fs::path       &fusepath_,
       fuse_file_info_t     *ffi_,
       const bool            link_cow_,
-      const NFSOpenHack     nfsopenhack_)
+      const NFSOpenHack     nfsopenhack_,
+      const bool            replica_balance_)
 {
   int rv;
+  dev_t dev;
   fs::path filepath;
-  std::vector<Branch*> obranches;
+  const Branch *branch;
+  const Branch *replica;
+  BranchPtrVec obranches;
 
   rv = searchFunc_(ibranches_,fusepath_,obranches);
   if(rv < 0)
@@ -324,16 +369,28 @@ _open(const Policy::Search &searchFunc_,
   if(obranches.empty())
     return -ENOENT;
 
-  filepath = obranches[0]->path / fusepath_;
+  if(link_cow_)
+    {
+      filepath = obranches[0]->path / fusepath_;
+      if(fs::cow::is_eligible(filepath,ffi_->flags) &&
+         (fs::cow::break_link(filepath) == 0))
+        KernelNotify::expire(fusepath_);
+    }
 
-  if(link_cow_ && fs::cow::is_eligible(filepath,ffi_->flags))
-    fs::cow::break_link(filepath);
+  replica = nullptr;
+  if(::_should_balance(replica_balance_,ffi_))
+    replica = ReplicaBalance::select(ibranches_,fusepath_,obranches[0],&dev);
+  branch = (replica ? replica : obranches[0]);
 
-  rv = ::_open_path(filepath,
-                    obranches[0],
+  rv = ::_open_path(branch,
                     fusepath_,
                     ffi_,
                     nfsopenhack_);
+  if(rv < 0)
+    return rv;
+
+  if(replica)
+    FileInfo::from_fh(ffi_->fh)->replica.acquire(dev);
 
   return rv;
 }
@@ -362,6 +419,7 @@ _open(const fuse_req_ctx_t *ctx_,
 
   for(int i = 0; i < MAX_OPEN_RETRIES; i++)
     {
+      u32 writers = 0;
       FileInfo *fi = nullptr;
       int backing_id = INVALID_BACKING_ID;
 
@@ -382,15 +440,43 @@ _open(const fuse_req_ctx_t *ctx_,
                  v_.second.ref_count.fetch_add(1,std::memory_order_relaxed);
                  fi = v_.second.fi;
                  backing_id = v_.second.backing_id;
+                 if(!::_rdonly(ffi_->flags))
+                   fi->writers.fetch_add(1,std::memory_order_relaxed);
+                 writers = fi->writers.load(std::memory_order_relaxed);
                });
 
       // If the file is already open...
       if(fi)
         {
-          rv = ::_open_fd(fi->fd,
-                          &fi->branch,
-                          fusepath_,
-                          ffi_);
+          // Another handle now exists so any buffered writes must be
+          // visible to it.
+          if(cfg.write_coalesce)
+            FUSE::write_coalesce_flush(ctx_->nodeid);
+
+          // Without a shared passthrough backing file each handle is
+          // free to use whichever replica is least loaded. Not while
+          // any handle is writing though as the other replicas would
+          // not see those writes.
+          if(::_should_balance(cfg.replica_balance,ffi_) &&
+             !fuse_backing_id_is_valid(backing_id) &&
+             (writers == 0))
+            {
+              rv = ::_open(cfg.func.open.policy,
+                           cfg.branches,
+                           fusepath_,
+                           ffi_,
+                           false,
+                           cfg.nfsopenhack,
+                           true);
+              if((rv == 0) &&
+                 (FileInfo::from_fh(ffi_->fh)->branch.path != fi->branch.path))
+                FileInfo::from_fh(ffi_->fh)->canonical = fi;
+            }
+          else
+            rv = ::_open_fd(fi->fd,
+                            &fi->branch,
+                            fusepath_,
+                            ffi_);
 
           // If we fail to reopen the already open file we need to
           // treat it similarly to fuse_release. Since we increased
@@ -400,10 +486,14 @@ _open(const fuse_req_ctx_t *ctx_,
           // happen hence no retries. Just being careful.
           if(rv < 0)
             {
+              if(!::_rdonly(ffi_->flags))
+                fi->writers.fetch_sub(1,std::memory_order_relaxed);
               FUSE::release(ctx_->nodeid);
               return rv;
             }
 
+          FileInfo::from_fh(ffi_->fh)->writable = !::_rdonly(ffi_->flags);
+
           switch(_(cfg.passthrough_io,ffi_->flags))
             {
             case _(PassthroughIO::ENUM::RO,O_RDONLY):
@@ -424,12 +514,18 @@ _open(const fuse_req_ctx_t *ctx_,
 
       // Was not open, do first open, try to insert, if someone beat us
       // to it in another thread then throw it away and try again.
-      rv = ::_open(cfg.func.open.policy,
-                   cfg.branches,
-                   fusepath_,
-                   ffi_,
-                   cfg.link_cow,
-                   cfg.nfsopenhack);
+      //
+      // The first open becomes canonical and later writable opens
+      // duplicate its fd so it is never balanced onto a replica.
+      rv = ::_open_reuse(ctx_->nodeid,fusepath_,ffi_);
+      if(rv < 0)
+        rv = ::_open(cfg.func.open.policy,
+                     cfg.branches,
+                     fusepath_,
+                     ffi_,
+                     cfg.link_cow,
+                     cfg.nfsopenhack,
+                     false);
       if(rv < 0)
         return rv;
 
@@ -437,6 +533,9 @@ _open(const fuse_req_ctx_t *ctx_,
       if(not fi)
         return -EBADF;
 
+      fi->writable = !::_rdonly(ffi_->flags);
+      fi->writers.store(fi->writable,std::memory_order_relaxed);
+
       switch(_(cfg.passthrough_io,ffi_->flags))
         {
         case _(PassthroughIO::ENUM::RO,O_RDONLY):
@@ -18,14 +18,23 @@
 
 #include "fuse_read.hpp"
 
+#include "branch_stats.hpp"
+#include "config.hpp"
 #include "errno.hpp"
 #include "fileinfo.hpp"
+#include "fs_close.hpp"
+#include "fs_fadvise.hpp"
+#include "fs_open_fd.hpp"
 #include "fs_pread.hpp"
+#include "fuse_write.hpp"
+#include "hot_nodes.hpp"
 #include "ioprio.hpp"
+#include "relocation.hpp"
 #include "state.hpp"
 
 #include "fuse.h"
 
+#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -58,6 +67,62 @@ _read_cached(const int     fd_,
   return rv;
 }
 
+// When a stream looks sequential hint the branch filesystem to start
+// reading ahead of the client. The window starts small and doubles
+// while the stream stays sequential up to `readahead.prefetch` KiB.
+static
+void
+_prefetch(FileInfo     *fi_,
+          const size_t  size_,
+          const off_t   offset_)
+{
+  u64 len;
+  u64 max_window;
+  off_t start;
+
+  max_window = (cfg.readahead_prefetch * 1024);
+  if(max_window == 0)
+    return;
+
+  len = fi_->read_stream.advance(offset_,size_,max_window,&start);
+  if(len == 0)
+    return;
+
+  fs::fadvise_willneed(fi_->fd,start,len);
+}
+
+// A handle balanced onto a replica reads from the canonical branch
+// once the node has a writer as the replica won't see those writes.
+static
+int
+_read_fd(FileInfo *fi_)
+{
+  int fd;
+  int expected;
+
+  if(!fi_->canonical)
+    return fi_->fd;
+  if(fi_->canonical->writers.load(std::memory_order_relaxed) == 0)
+    return fi_->fd;
+
+  fd = fi_->primary_fd.load(std::memory_order_acquire);
+  if(fd >= 0)
+    return fd;
+
+  fd = fs::open_fd(fi_->canonical->fd,O_RDONLY);
+  if(fd < 0)
+    return fi_->fd;
+
+  expected = -1;
+  if(!fi_->primary_fd.compare_exchange_strong(expected,fd))
+    {
+      fs::close(fd);
+      return expected;
+    }
+
+  return fd;
+}
+
 int
 FUSE::read(const fuse_req_ctx_t   *ctx_,
            const fuse_file_info_t *ffi_,
@@ -65,17 +130,38 @@ FUSE::read(const fuse_req_ctx_t   *ctx_,
            size_t                  size_,
            off_t                   offset_)
 {
+  int rv;
+  int fd;
+  u64 start;
   ioprio::SetFrom iop(ctx_->pid);
   FileInfo *fi;
+  Relocation *r;
 
   fi = state.get_fi(ctx_,ffi_->fh);
   if(not fi)
     return -EBADF;
 
-  if(fi->direct_io)
-    return ::_read_direct_io(fi->fd,buf_,size_,offset_);
+  rv = FUSE::write_coalesce_flush(fi);
+  if(rv < 0)
+    return rv;
+
+  ::_prefetch(fi,size_,offset_);
+  HotNodes::touch(ctx_->nodeid);
+
+  start = fuse_stats_now_ns();
+  fi->replica.read_begin();
+  fd = ::_read_fd(fi);
+  r  = fi->relocation.load(std::memory_order_acquire);
+  if(r)
+    rv = r->pread(buf_,size_,offset_);
+  else if(fi->direct_io)
+    rv = ::_read_direct_io(fd,buf_,size_,offset_);
+  else
+    rv = ::_read_cached(fd,buf_,size_,offset_);
+  fi->replica.read_end();
+  BranchStats::record(fi->stats,BranchStats::READ,rv,start);
 
-  return ::_read_cached(fi->fd,buf_,size_,offset_);
+  return rv;
 }
 
 int
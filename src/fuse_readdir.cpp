@@ -26,6 +26,8 @@
 
 #include "config.hpp"
 
+#include "fuse_usdt.hpp"
+
 #include <cstring>
 
 #include <dirent.h>
@@ -120,7 +122,9 @@ FUSE::ReadDir::operator()(const fuse_req_ctx_t   *ctx_,
   if(!readdir)
     fatal::abort("readdir impl is null");
 
+  FUSE_USDT1(readdir_begin,ctx_->nodeid);
   rv = (*readdir)(ctx_,ffi_,buf_);
+  FUSE_USDT3(readdir_end,ctx_->nodeid,rv,kv_size(buf_->offs));
   if(rv == -ENOENT)
     return ::_handle_ENOENT(ffi_,buf_);
 
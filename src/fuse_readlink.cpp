@@ -87,7 +87,7 @@ _readlink(const Policy::Search &searchFunc_,
           const time_t          symlinkify_timeout_)
 {
   ssize_t rv;
-  std::vector<Branch*> obranches;
+  BranchPtrVec obranches;
 
   rv = searchFunc_(ibranches_,fusepath_,obranches);
   if(rv < 0)
@@ -44,13 +44,51 @@
 #include "state.hpp"
 
 #include "config.hpp"
+#include "fd_cache.hpp"
 #include "fileinfo.hpp"
 #include "fs_close.hpp"
+#include "fs_dup.hpp"
 #include "fs_fadvise.hpp"
 #include "fuse_passthrough.hpp"
+#include "fuse_write.hpp"
+#include "relocation.hpp"
+#include "release_reaper.hpp"
+#include "syslog.hpp"
 
 #include "fuse.h"
 
+#include <string.h>
+
+
+// The double fadvise is necessary insofar as according to nocache
+// author (https://github.com/Feh/nocache#limitations) the first one
+// doesn't always work due to timing issues.
+static
+void
+_dropcache(const int fd_)
+{
+  fs::fadvise_dontneed(fd_);
+  fs::fadvise_dontneed(fd_);
+}
+
+// The reaper works on a dup so it doesn't matter if the handle's own
+// fd is closed, or reused by a later open, before it gets to it.
+static
+void
+_dropcache_async(const int fd_)
+{
+  int fd;
+
+  fd = fs::dup(fd_);
+  if(fd < 0)
+    return ::_dropcache(fd_);
+
+  ReleaseReaper::run([fd]()
+  {
+    ::_dropcache(fd);
+    fs::close(fd);
+  });
+}
 
 static
 int
@@ -58,18 +96,69 @@ _release(cu64        nodeid_,
          FileInfo   *fi_,
          const bool  dropcacheonclose_)
 {
-  // The double fadvise is necessary insofar as according to nocache
-  // author (https://github.com/Feh/nocache#limitations) the first one
-  // doesn't always work due to timing issues.
+  int err;
+
+  // The kernel ignores release's return value and won't have sent a
+  // flush with flush-on-close=never so log anything still pending.
+  err = FUSE::write_coalesce_flush(fi_);
+  if(err < 0)
+    SysLog::error("write-coalesce flush failed on release: {}: {}",
+                  fi_->fusepath.string(),
+                  strerror(-err));
+
   if(dropcacheonclose_)
     {
-      fs::fadvise_dontneed(fi_->fd);
-      fs::fadvise_dontneed(fi_->fd);
+      if(cfg.release_async == ReleaseAsync::ENUM::OFF)
+        ::_dropcache(fi_->fd);
+      else
+        ::_dropcache_async(fi_->fd);
     }
 
   FUSE::release(nodeid_,fi_);
 
-  return 0;
+  return err;
+}
+
+// Read-only fds may be kept for reuse by a later open. Not those on a
+// balanced replica as a reused fd becomes canonical.
+static
+void
+_close(cu64      nodeid_,
+       FileInfo *fi_)
+{
+  if(fi_->primary_fd >= 0)
+    fs::close(fi_->primary_fd);
+  if(!fi_->canonical &&
+     FdCache::put(nodeid_,fi_->fusepath,fi_->branch,fi_->fd))
+    return;
+
+  fs::close(fi_->fd);
+}
+
+static
+void
+_free(cu64      nodeid_,
+      FileInfo *fi_)
+{
+  Relocation::finish(fi_);
+  ::_close(nodeid_,fi_);
+  delete fi_;
+}
+
+// By now the FileInfo is unreachable: out of open_files and the
+// kernel is done with the handle.
+static
+void
+_free_maybe_async(cu64      nodeid_,
+                  FileInfo *fi_)
+{
+  if(cfg.release_async != ReleaseAsync::ENUM::CLOSE)
+    return ::_free(nodeid_,fi_);
+
+  ReleaseReaper::run([nodeid_,fi_]()
+  {
+    ::_free(nodeid_,fi_);
+  });
 }
 
 void
@@ -95,8 +184,12 @@ FUSE::release(cu64             nodeid_,
               {
                 const int prev =
                   v_.second.ref_count.fetch_sub(1,std::memory_order_acq_rel);
+                if(v_.second.wc_fi == fi_)
+                  v_.second.wc_fi = nullptr;
                 if(prev > 1)
                   {
+                    if(fi_ && fi_->writable)
+                      v_.second.fi->writers.fetch_sub(1,std::memory_order_relaxed);
                     if(fi_ != v_.second.fi)
                       fh_fi_to_free = fi_;
                     return false;
@@ -112,15 +205,9 @@ FUSE::release(cu64             nodeid_,
 
   FUSE::passthrough_close(backing_id);
   if(fh_fi_to_free)
-    {
-      fs::close(fh_fi_to_free->fd);
-      delete fh_fi_to_free;
-    }
+    ::_free_maybe_async(nodeid_,fh_fi_to_free);
   if(canonical_fi)
-    {
-      fs::close(canonical_fi->fd);
-      delete canonical_fi;
-    }
+    ::_free_maybe_async(nodeid_,canonical_fi);
 }
 
 int
@@ -18,11 +18,14 @@
 
 #include "fuse_removexattr.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_lremovexattr.hpp"
 #include "fs_path.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -30,11 +33,10 @@
 
 
 static
-void
+int
 _removexattr_loop_core(const fs::path &basepath_,
                        const fs::path &fusepath_,
-                       const char     *attrname_,
-                       PolicyRV       *prv_)
+                       const char     *attrname_)
 {
   int rv;
   fs::path fullpath;
@@ -43,20 +45,28 @@ _removexattr_loop_core(const fs::path &basepath_,
 
   rv = fs::lremovexattr(fullpath,attrname_);
 
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_removexattr_loop(const std::vector<Branch*> &branches_,
-                  const fs::path             &fusepath_,
-                  const char                 *attrname_,
-                  PolicyRV                   *prv_)
+_removexattr_loop(const BranchPtrVec &branches_,
+                  const fs::path     &fusepath_,
+                  const char         *attrname_,
+                  PolicyRV           *prv_)
 {
-  for(auto &branch : branches_)
-    {
-      ::_removexattr_loop_core(branch->path,fusepath_,attrname_,prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_removexattr_loop_core(branch_.path,fusepath_,attrname_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -69,7 +79,7 @@ _removexattr(const Policy::Action &actionFunc_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> obranches;
+  BranchPtrVec obranches;
 
   rv = actionFunc_(ibranches_,fusepath_,obranches);
   if(rv < 0)
@@ -98,6 +108,7 @@ FUSE::removexattr(const fuse_req_ctx_t *ctx_,
                   const char           *fusepath_,
                   const char           *attrname_)
 {
+  int rv;
   const fs::path fusepath{fusepath_};
 
   if(Config::is_ctrl_file(fusepath))
@@ -106,9 +117,13 @@ FUSE::removexattr(const fuse_req_ctx_t *ctx_,
   if(cfg.xattr.to_int())
     return -cfg.xattr.to_int();
 
-  return ::_removexattr(cfg.func.removexattr.policy,
-                        cfg.func.getxattr.policy,
-                        cfg.branches,
-                        fusepath,
-                        attrname_);
+  rv = ::_removexattr(cfg.func.removexattr.policy,
+                      cfg.func.getxattr.policy,
+                      cfg.branches,
+                      fusepath,
+                      attrname_);
+
+  AttrCache::invalidate(ctx_->nodeid);
+
+  return rv;
 }
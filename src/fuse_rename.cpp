@@ -18,9 +18,11 @@
 
 #include "fuse_rename.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "error.hpp"
 #include "errno.hpp"
+#include "fd_cache.hpp"
 #include "fs_clonepath.hpp"
 #include "fs_link.hpp"
 #include "fs_mkdir_as.hpp"
@@ -30,6 +32,7 @@
 #include "fs_symlink.hpp"
 #include "fs_unlink.hpp"
 #include "fuse_symlink.hpp"
+#include "kernel_notify.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -39,8 +42,8 @@
 
 static
 bool
-_contains(const std::vector<Branch*> &haystack_,
-          const char                 *needle_)
+_contains(const BranchPtrVec &haystack_,
+          const char         *needle_)
 {
   for(auto &hay : haystack_)
     {
@@ -53,8 +56,8 @@ _contains(const std::vector<Branch*> &haystack_,
 
 static
 bool
-_contains(const std::vector<Branch*> &haystack_,
-          const std::string          &needle_)
+_contains(const BranchPtrVec &haystack_,
+          const std::string  &needle_)
 {
   return ::_contains(haystack_,needle_.c_str());
 }
@@ -78,8 +81,8 @@ _rename_create_path(const Policy::Search &searchPolicy_,
   int rv;
   Err err;
   StrVec toremove;
-  std::vector<Branch*> newbranches;
-  std::vector<Branch*> oldbranches;
+  BranchPtrVec newbranches;
+  BranchPtrVec oldbranches;
   fs::path oldfullpath;
   fs::path newfullpath;
 
@@ -138,7 +141,7 @@ _rename_preserve_path(const Policy::Action &actionPolicy_,
   int rv;
   bool success;
   StrVec toremove;
-  std::vector<Branch*> oldbranches;
+  BranchPtrVec oldbranches;
   fs::path oldfullpath;
   fs::path newfullpath;
 
@@ -180,8 +183,8 @@ _rename_preserve_path(const Policy::Action &actionPolicy_,
 
 static
 void
-_rename_exdev_rename_back(const std::vector<Branch*> &branches_,
-                          const fs::path             &oldfusepath_)
+_rename_exdev_rename_back(const BranchPtrVec &branches_,
+                          const fs::path     &oldfusepath_)
 {
   fs::path oldpath;
   fs::path newpath;
@@ -204,7 +207,7 @@ int
 _rename_exdev_rename_target(const Policy::Action &actionPolicy_,
                             const Branches::Ptr   ibranches_,
                             const fs::path       &oldfusepath_,
-                            std::vector<Branch*> &obranches_)
+                            BranchPtrVec         &obranches_)
 {
   int rv;
   fs::path clonesrc;
@@ -246,6 +249,16 @@ _rename_exdev_rename_target(const Policy::Action &actionPolicy_,
   return -EXDEV;
 }
 
+// The kernel moves its entry for the old path to the new one but it
+// is now a symlink and the hidden directory may have been created.
+static
+void
+_rename_exdev_notify(const fs::path &newfusepath_)
+{
+  KernelNotify::invalidate(newfusepath_);
+  KernelNotify::invalidate("/.mergerfs_rename_exdev");
+}
+
 static
 int
 _rename_exdev_rel_symlink(const fuse_req_ctx_t *ctx_,
@@ -257,7 +270,7 @@ _rename_exdev_rel_symlink(const fuse_req_ctx_t *ctx_,
   int rv;
   fs::path target;
   fs::path linkpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = ::_rename_exdev_rename_target(actionPolicy_,branches_,oldfusepath_,branches);
   if(rv < 0)
@@ -271,6 +284,8 @@ _rename_exdev_rel_symlink(const fuse_req_ctx_t *ctx_,
   rv = FUSE::symlink(ctx_,target.c_str(),linkpath);
   if(rv < 0)
     ::_rename_exdev_rename_back(branches,oldfusepath_);
+  else
+    ::_rename_exdev_notify(newfusepath_);
 
   return rv;
 }
@@ -287,7 +302,7 @@ _rename_exdev_abs_symlink(const fuse_req_ctx_t *ctx_,
   int rv;
   fs::path target;
   fs::path linkpath;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = ::_rename_exdev_rename_target(actionPolicy_,branches_,oldfusepath_,branches);
   if(rv < 0)
@@ -301,6 +316,8 @@ _rename_exdev_abs_symlink(const fuse_req_ctx_t *ctx_,
   rv = FUSE::symlink(ctx_,target.c_str(),linkpath);
   if(rv < 0)
     ::_rename_exdev_rename_back(branches,oldfusepath_);
+  else
+    ::_rename_exdev_notify(newfusepath_);
 
   return rv;
 }
@@ -362,7 +379,14 @@ FUSE::rename(const fuse_req_ctx_t *ctx_,
 
   rv = ::_rename(oldfusepath,newfusepath);
   if(rv == -EXDEV)
-    return ::_rename_exdev(ctx_,oldfusepath,newfusepath);
+    rv = ::_rename_exdev(ctx_,oldfusepath,newfusepath);
+
+  AttrCache::invalidate(ctx_->nodeid);
+  AttrCache::invalidate(newfusepath.parent_path());
+  AttrCache::invalidate_links(oldfusepath);
+  AttrCache::invalidate_links(newfusepath);
+  FdCache::invalidate(oldfusepath);
+  FdCache::invalidate(newfusepath);
 
   return rv;
 }
@@ -18,11 +18,14 @@
 
 #include "fuse_rmdir.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_path.hpp"
 #include "fs_rmdir.hpp"
 #include "fs_unlink.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -105,16 +108,23 @@ _rmdir_core(const fs::path       &basepath_,
 
 static
 int
-_rmdir_loop(const std::vector<Branch*> &branches_,
-            const fs::path             &fusepath_,
-            const FollowSymlinks        followsymlinks_)
+_rmdir_loop(const BranchPtrVec   &branches_,
+            const fs::path       &fusepath_,
+            const FollowSymlinks  followsymlinks_)
 {
   RmdirErr err;
+  SmallVec<int,8> rvs;
 
-  for(const auto &branch : branches_)
-    {
-      err = ::_rmdir_core(branch->path,fusepath_,followsymlinks_);
-    }
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_rmdir_core(branch_.path,fusepath_,followsymlinks_);
+              });
+
+  for(const auto rv : rvs)
+    err = rv;
 
   return err;
 }
@@ -127,7 +137,7 @@ _rmdir(const Policy::Action &actionFunc_,
        const fs::path       &fusepath_)
 {
   int rv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = actionFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -140,10 +150,16 @@ int
 FUSE::rmdir(const fuse_req_ctx_t *ctx_,
             const char           *fusepath_)
 {
+  int rv;
   const fs::path  fusepath{fusepath_};
 
-  return ::_rmdir(cfg.func.rmdir.policy,
-                  cfg.branches,
-                  cfg.follow_symlinks,
-                  fusepath);
+  rv = ::_rmdir(cfg.func.rmdir.policy,
+                cfg.branches,
+                cfg.follow_symlinks,
+                fusepath);
+
+  AttrCache::invalidate(ctx_->nodeid);
+  AttrCache::invalidate(fusepath);
+
+  return rv;
 }
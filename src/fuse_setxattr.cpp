@@ -18,18 +18,28 @@
 
 #include "fuse_setxattr.hpp"
 
+#include "attr_cache.hpp"
+#include "branch_watch.hpp"
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
+#include "fd_cache.hpp"
+#include "fs_copydata_readwrite.hpp"
 #include "fs_glob.hpp"
 #include "fs_lsetxattr.hpp"
 #include "fs_path.hpp"
 #include "fs_statvfs_cache.hpp"
+#include "fuse_statfs.hpp"
+#include "hot_nodes.hpp"
 #include "num.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
+#include "stats_shm.hpp"
 #include "str.hpp"
 #include "syslog.hpp"
 
 #include "fuse.h"
+#include "fuse_slowlog.hpp"
 
 #include <cstring>
 #include <string>
@@ -96,19 +106,30 @@ _setxattr_ctrl_file(const char *attrname_,
     return rv;
 
   fs::statvfs_cache_timeout(cfg.cache_statfs);
+  fs::copydata_readwrite_config(cfg.copy_chunk_size * 1024,
+                                cfg.copy_inflight);
+  Branch::fds_enabled(cfg.cache_branch_fds);
+  BranchWatch::sync(cfg.cache_branch_watch,cfg.branches);
+  Fanout::threads(cfg.fanout_thread_count);
+  fuse_slowlog_threshold_ms(cfg.log_slow_ops);
+  HotNodes::enable(cfg.stats_hot_nodes);
+  StatsShm::enable(cfg.stats_shm);
+  AttrCache::clear();
+  FdCache::capacity(cfg.cache_fd_reuse);
+  FdCache::clear();
+  FUSE::statfs_cache_clear();
 
   return rv;
 }
 
 static
-void
+int
 _setxattr_loop_core(const fs::path &basepath_,
                     const fs::path &fusepath_,
                     const char     *attrname_,
                     const char     *attrval_,
                     const size_t    attrvalsize_,
-                    const int       flags_,
-                    PolicyRV       *prv_)
+                    const int       flags_)
 {
   int rv;
   fs::path fullpath;
@@ -117,28 +138,36 @@ _setxattr_loop_core(const fs::path &basepath_,
 
   rv = fs::lsetxattr(fullpath,attrname_,attrval_,attrvalsize_,flags_);
 
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_setxattr_loop(const std::vector<Branch*> &branches_,
-               const fs::path             &fusepath_,
-               const char                 *attrname_,
-               const char                 *attrval_,
-               const size_t                attrvalsize_,
-               const int                   flags_,
-               PolicyRV                   *prv_)
+_setxattr_loop(const BranchPtrVec &branches_,
+               const fs::path     &fusepath_,
+               const char         *attrname_,
+               const char         *attrval_,
+               const size_t        attrvalsize_,
+               const int           flags_,
+               PolicyRV           *prv_)
 {
-  for(auto &branch : branches_)
-    {
-      ::_setxattr_loop_core(branch->path,
-                            fusepath_,
-                            attrname_,
-                            attrval_,attrvalsize_,
-                            flags_,
-                            prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_setxattr_loop_core(branch_.path,
+                                             fusepath_,
+                                             attrname_,
+                                             attrval_,
+                                             attrvalsize_,
+                                             flags_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -154,7 +183,7 @@ _setxattr(const Policy::Action &setxattrPolicy_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = setxattrPolicy_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -213,6 +242,7 @@ FUSE::setxattr(const fuse_req_ctx_t *ctx_,
                size_t                attrvalsize_,
                int                   flags_)
 {
+  int rv;
   const fs::path fusepath{fusepath_};
 
   if(Config::is_ctrl_file(fusepath))
@@ -221,10 +251,14 @@ FUSE::setxattr(const fuse_req_ctx_t *ctx_,
                                  attrvalsize_,
                                  flags_);
 
-  return ::_setxattr(ctx_,
-                     fusepath,
-                     attrname_,
-                     attrval_,
-                     attrvalsize_,
-                     flags_);
+  rv = ::_setxattr(ctx_,
+                   fusepath,
+                   attrname_,
+                   attrval_,
+                   attrvalsize_,
+                   flags_);
+
+  AttrCache::invalidate(ctx_->nodeid);
+
+  return rv;
 }
@@ -23,6 +23,7 @@
 #include "fs_lstat.hpp"
 #include "fs_path.hpp"
 #include "fs_lstatvfs.hpp"
+#include "fs_statvfs_cache.hpp"
 #include "statvfs_util.hpp"
 
 #include "fuse.h"
@@ -31,8 +32,30 @@
 #include <algorithm>
 #include <limits>
 #include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
+#include <time.h>
+
+
+// The merged result is keyed by everything which changes it. In
+// `statfs=base` mode the fusepath is irrelevant and left empty so
+// every request shares one entry.
+typedef std::tuple<StatFS::ENUM,StatFSIgnore::ENUM,std::string> StatFSCacheKey;
+
+struct StatFSCacheElement
+{
+  u64            updated;
+  u64            accessed;
+  struct statvfs st;
+};
+
+typedef std::map<StatFSCacheKey,StatFSCacheElement> StatFSCacheMap;
+
+static std::mutex     g_statfs_cache_mutex;
+static StatFSCacheMap g_statfs_cache;
+
 
 static
 void
@@ -109,7 +132,12 @@ _statfs(const Branches::Ptr  branches_,
       if(rv < 0)
         continue;
 
-      rv = fs::lstatvfs(fullpath,&stvfs);
+      // The branch root snapshots are shared with the create
+      // policies via the statvfs cache.
+      if(mode_ == StatFS::ENUM::FULL)
+        rv = fs::lstatvfs(fullpath,&stvfs);
+      else
+        rv = fs::statvfs_cache(fullpath,&stvfs);
       if(rv < 0)
         continue;
 
@@ -146,6 +174,117 @@ _statfs(const Branches::Ptr  branches_,
   return 0;
 }
 
+static
+u64
+_get_time(void)
+{
+  return ::time(NULL);
+}
+
+// Entries are refreshed once they are `timeout_` seconds old and
+// dropped if nothing has asked for them in a few refresh periods so
+// `statfs=full` doesn't accumulate every path ever queried.
+static
+void
+_statfs_cache_refresh(const u64 timeout_)
+{
+  u64 now;
+  std::vector<StatFSCacheKey> keys;
+
+  now = ::_get_time();
+
+  {
+    std::lock_guard<std::mutex> lk(g_statfs_cache_mutex);
+
+    for(auto it = g_statfs_cache.begin(); it != g_statfs_cache.end();)
+      {
+        if((timeout_ == 0) || ((now - it->second.accessed) > (timeout_ * 4)))
+          {
+            it = g_statfs_cache.erase(it);
+            continue;
+          }
+
+        if((now - it->second.updated) >= timeout_)
+          keys.emplace_back(it->first);
+        ++it;
+      }
+  }
+
+  for(const auto &key : keys)
+    {
+      struct statvfs st = {};
+
+      ::_statfs(cfg.branches,
+                std::get<2>(key),
+                std::get<0>(key),
+                std::get<1>(key),
+                &st);
+
+      std::lock_guard<std::mutex> lk(g_statfs_cache_mutex);
+
+      auto it = g_statfs_cache.find(key);
+      if(it == g_statfs_cache.end())
+        continue;
+
+      it->second.st      = st;
+      it->second.updated = ::_get_time();
+    }
+}
+
+static
+int
+_statfs_cached(const fs::path     &fusepath_,
+               const StatFS        mode_,
+               const StatFSIgnore  ignore_,
+               struct statvfs     *st_)
+{
+  u64 now;
+  StatFSCacheKey key;
+
+  key = {mode_,
+         ignore_,
+         ((mode_ == StatFS::ENUM::FULL) ? fusepath_.native() : std::string())};
+  now = ::_get_time();
+
+  {
+    std::lock_guard<std::mutex> lk(g_statfs_cache_mutex);
+
+    // The maintenance thread only runs once a minute so shorter
+    // timeouts are enforced here.
+    auto it = g_statfs_cache.find(key);
+    if((it != g_statfs_cache.end()) &&
+       ((now - it->second.updated) < fs::statvfs_cache_timeout()))
+      {
+        it->second.accessed = now;
+        *st_ = it->second.st;
+        return 0;
+      }
+  }
+
+  *st_ = {};
+  ::_statfs(cfg.branches,fusepath_,mode_,ignore_,st_);
+
+  std::lock_guard<std::mutex> lk(g_statfs_cache_mutex);
+
+  g_statfs_cache[key] = StatFSCacheElement{now,now,*st_};
+
+  return 0;
+}
+
+void
+FUSE::statfs_cache_refresh(void)
+{
+  ::_statfs_cache_refresh(fs::statvfs_cache_timeout());
+}
+
+void
+FUSE::statfs_cache_clear(void)
+{
+  std::lock_guard<std::mutex> lk(g_statfs_cache_mutex);
+
+  g_statfs_cache.clear();
+}
+
 int
 FUSE::statfs(const fuse_req_ctx_t *ctx_,
              const char           *fusepath_,
@@ -153,6 +292,12 @@ FUSE::statfs(const fuse_req_ctx_t *ctx_,
 {
   const fs::path fusepath{fusepath_};
 
+  if(cfg.cache_statfs)
+    return ::_statfs_cached(fusepath,
+                            cfg.statfs,
+                            cfg.statfs_ignore,
+                            st_);
+
   return ::_statfs(cfg.branches,
                    fusepath,
                    cfg.statfs,
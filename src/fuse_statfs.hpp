@@ -25,6 +25,12 @@
 
 namespace FUSE
 {
+  void
+  statfs_cache_clear(void);
+
+  void
+  statfs_cache_refresh(void);
+
   int
   statfs(const fuse_req_ctx_t *ctx,
          const char           *fusepath,
@@ -18,6 +18,7 @@
 
 #include "fuse_symlink.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "error.hpp"
@@ -63,13 +64,13 @@ _symlink_loop_core(const ugid_t    ugid_,
 
 static
 int
-_symlink_loop(const ugid_t                ugid_,
-              const fs::path             &existingbranch_,
-              const std::vector<Branch*> &newbranches_,
-              const char                 *target_,
-              const fs::path             &linkpath_,
-              const fs::path             &newdirpath_,
-              struct stat                *st_)
+_symlink_loop(const ugid_t        ugid_,
+              const fs::path     &existingbranch_,
+              const BranchPtrVec &newbranches_,
+              const char         *target_,
+              const fs::path     &linkpath_,
+              const fs::path     &newdirpath_,
+              struct stat        *st_)
 {
   int rv;
   Err err;
@@ -104,8 +105,8 @@ _symlink(const ugid_t          ugid_,
 {
   int rv;
   fs::path newdirpath;
-  std::vector<Branch*> newbranches;
-  std::vector<Branch*> existingbranches;
+  BranchPtrVec newbranches;
+  BranchPtrVec existingbranches;
 
   newdirpath = linkpath_.parent_path();
 
@@ -158,6 +159,8 @@ FUSE::symlink(const fuse_req_ctx_t *ctx_,
                       st_);
     }
 
+  AttrCache::invalidate(ctx_->nodeid);
+
   if(timeouts_ != NULL)
     {
       switch(cfg.follow_symlinks)
@@ -20,9 +20,13 @@
 
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_path.hpp"
+#include "fs_pathbuf.hpp"
 #include "fs_truncate.hpp"
+#include "fuse_write.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -31,33 +35,38 @@
 
 
 static
-void
+int
 _truncate_loop_core(const fs::path &basepath_,
                     const fs::path &fusepath_,
-                    const off_t     size_,
-                    PolicyRV       *prv_)
+                    const off_t     size_)
 {
   int rv;
-  fs::path fullpath;
+  const fs::PathBuf fullpath(basepath_,fusepath_);
 
-  fullpath = basepath_ / fusepath_;
+  rv = fs::truncate(fullpath.c_str(),size_);
 
-  rv = fs::truncate(fullpath,size_);
-
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_truncate_loop(const std::vector<Branch*> &branches_,
-               const fs::path             &fusepath_,
-               const off_t                 size_,
-               PolicyRV                   *prv_)
+_truncate_loop(const BranchPtrVec &branches_,
+               const fs::path     &fusepath_,
+               const off_t         size_,
+               PolicyRV           *prv_)
 {
-  for(auto &branch : branches_)
-    {
-      ::_truncate_loop_core(branch->path,fusepath_,size_,prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_truncate_loop_core(branch_.path,fusepath_,size_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -70,7 +79,7 @@ _truncate(const Policy::Action &actionFunc_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = actionFunc_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -101,6 +110,10 @@ FUSE::truncate(const fuse_req_ctx_t *ctx_,
 {
   const fs::path fusepath{fusepath_};
 
+  // Buffered writes would otherwise land after the truncate.
+  if(cfg.write_coalesce)
+    FUSE::write_coalesce_flush(ctx_->nodeid);
+
   return ::_truncate(cfg.func.truncate.policy,
                      cfg.func.getattr.policy,
                      cfg.branches,
@@ -18,11 +18,15 @@
 
 #include "fuse_unlink.hpp"
 
+#include "attr_cache.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "error.hpp"
+#include "fanout.hpp"
+#include "fd_cache.hpp"
 #include "fs_path.hpp"
 #include "fs_unlink.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -33,18 +37,22 @@
 
 static
 int
-_unlink_loop(const std::vector<Branch*> &branches_,
-             const fs::path             &fusepath_)
+_unlink_loop(const BranchPtrVec &branches_,
+             const fs::path     &fusepath_)
 {
   Err err;
-  fs::path fullpath;
+  SmallVec<int,8> rvs;
 
-  for(const auto &branch : branches_)
-    {
-      fullpath = branch->path / fusepath_;
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return fs::unlink(branch_,fusepath_);
+              });
 
-      err = fs::unlink(fullpath);
-    }
+  for(const auto rv : rvs)
+    err = rv;
 
   return err;
 }
@@ -56,7 +64,7 @@ _unlink(const Policy::Action &unlinkPolicy_,
         const fs::path       &fusepath_)
 {
   int rv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = unlinkPolicy_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -69,9 +77,16 @@ int
 FUSE::unlink(const fuse_req_ctx_t *ctx_,
              const char           *fusepath_)
 {
+  int rv;
   const fs::path fusepath{fusepath_};
 
-  return ::_unlink(cfg.func.unlink.policy,
-                   cfg.branches,
-                   fusepath);
+  rv = ::_unlink(cfg.func.unlink.policy,
+                 cfg.branches,
+                 fusepath);
+
+  AttrCache::invalidate(ctx_->nodeid);
+  AttrCache::invalidate_links(fusepath);
+  FdCache::invalidate(fusepath);
+
+  return rv;
 }
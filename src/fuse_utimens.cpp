@@ -20,9 +20,11 @@
 
 #include "config.hpp"
 #include "errno.hpp"
+#include "fanout.hpp"
 #include "fs_lutimens.hpp"
 #include "fs_path.hpp"
 #include "policy_rv.hpp"
+#include "smallvec.hpp"
 
 #include "fuse.h"
 
@@ -30,11 +32,10 @@
 
 
 static
-void
+int
 _utimens_loop_core(const fs::path &basepath_,
                    const fs::path &fusepath_,
-                   const timespec  ts_[2],
-                   PolicyRV       *prv_)
+                   const timespec  ts_[2])
 {
   int rv;
   fs::path fullpath;
@@ -43,20 +44,28 @@ _utimens_loop_core(const fs::path &basepath_,
 
   rv = fs::lutimens(fullpath,ts_);
 
-  prv_->insert(rv,basepath_);
+  return rv;
 }
 
 static
 void
-_utimens_loop(const std::vector<Branch*> &branches_,
-              const fs::path             &fusepath_,
-              const timespec              ts_[2],
-              PolicyRV                   *prv_)
+_utimens_loop(const BranchPtrVec &branches_,
+              const fs::path     &fusepath_,
+              const timespec      ts_[2],
+              PolicyRV           *prv_)
 {
-  for(auto &branch : branches_)
-    {
-      ::_utimens_loop_core(branch->path,fusepath_,ts_,prv_);
-    }
+  SmallVec<int,8> rvs;
+
+  rvs.resize(branches_.size());
+  Fanout::run(branches_,
+              rvs.data(),
+              [&](const Branch &branch_)
+              {
+                return ::_utimens_loop_core(branch_.path,fusepath_,ts_);
+              });
+
+  for(u64 i = 0; i < branches_.size(); i++)
+    prv_->insert(rvs[i],branches_[i]->path);
 }
 
 static
@@ -69,7 +78,7 @@ _utimens(const Policy::Action &utimensPolicy_,
 {
   int rv;
   PolicyRV prv;
-  std::vector<Branch*> branches;
+  BranchPtrVec branches;
 
   rv = utimensPolicy_(branches_,fusepath_,branches);
   if(rv < 0)
@@ -18,6 +18,8 @@
 
 #include "fuse_write.hpp"
 
+#include "attr_cache.hpp"
+#include "branch_stats.hpp"
 #include "config.hpp"
 #include "errno.hpp"
 #include "fileinfo.hpp"
@@ -26,7 +28,10 @@
 #include "fs_movefile_and_open.hpp"
 #include "fs_pwrite.hpp"
 #include "fs_pwriten.hpp"
+#include "hot_nodes.hpp"
 #include "ioprio.hpp"
+#include "kernel_notify.hpp"
+#include "relocation.hpp"
 #include "state.hpp"
 
 #include "scope_guard/scope_guard.hpp"
@@ -59,6 +64,17 @@ _move_and_pwrite(const char   *buf_,
   if(cfg.moveonenospc.enabled == false)
     return err_;
 
+  if(cfg.moveonenospc_async)
+    {
+      rv = Relocation::start(cfg.moveonenospc.policy,
+                             cfg.branches,
+                             fi_);
+      if(rv < 0)
+        return err_;
+
+      return fi_->relocation.load()->pwrite(buf_,count_,offset_);
+    }
+
   rv = fs::movefile_and_open_as_root(cfg.moveonenospc.policy,
                                      cfg.branches,
                                      fi_->branch.path,
@@ -72,6 +88,8 @@ _move_and_pwrite(const char   *buf_,
   if(err < 0)
     return err_;
 
+  KernelNotify::expire(fi_->fusepath);
+
   return fs::pwrite(fi_->fd,buf_,count_,offset_);
 }
 
@@ -90,6 +108,23 @@ _move_and_pwriten(char const    *buf_,
   if(cfg.moveonenospc.enabled == false)
     return err_;
 
+  if(cfg.moveonenospc_async)
+    {
+      rv = Relocation::start(cfg.moveonenospc.policy,
+                             cfg.branches,
+                             fi_);
+      if(rv < 0)
+        return err_;
+
+      rv = fi_->relocation.load()->pwrite(buf_ + written_,
+                                          count_ - written_,
+                                          offset_ + written_);
+      if(rv < 0)
+        return rv;
+
+      return (written_ + rv);
+    }
+
   rv = fs::movefile_and_open_as_root(cfg.moveonenospc.policy,
                                      cfg.branches,
                                      fi_->branch.path,
@@ -103,6 +138,8 @@ _move_and_pwriten(char const    *buf_,
   if(err < 0)
     return err_;
 
+  KernelNotify::expire(fi_->fusepath);
+
   rv = fs::pwriten(fi_->fd,
                    buf_ + written_,
                    count_ - written_,
@@ -127,53 +164,223 @@ _move_and_pwriten(char const    *buf_,
 // See libfuse/include/fuse.h for more details
 
 static
+ssize_t
+_write_direct_io(FileInfo     *fi_,
+                 const char   *buf_,
+                 const size_t  count_,
+                 const off_t   offset_)
+{
+  ssize_t rv;
+  Relocation *r;
+
+  {
+    std::shared_lock<std::shared_mutex> slk(fi_->mutex);
+    r = fi_->relocation.load(std::memory_order_acquire);
+    if(r)
+      return r->pwrite(buf_,count_,offset_);
+    rv = fs::pwrite(fi_->fd,buf_,count_,offset_);
+  }
+
+  if(not ::_out_of_space(rv))
+    return rv;
+
+  std::unique_lock<std::shared_mutex> ulk(fi_->mutex);
+  // Re-check under exclusive lock: another writer may have
+  // already moved the file and retired. If so the pwrite should
+  // now succeed without our own move call.
+  r = fi_->relocation.load(std::memory_order_acquire);
+  if(r)
+    return r->pwrite(buf_,count_,offset_);
+  rv = fs::pwrite(fi_->fd,buf_,count_,offset_);
+  if(::_out_of_space(rv))
+    rv = ::_move_and_pwrite(buf_,count_,offset_,fi_,rv);
+  return rv;
+}
+
+// Writes out the coalesce buffer. Must be called with wc.mutex
+// held. The buffer's contents have already been acknowledged to the
+// client so a short write is retried and any error is kept in
+// wc.err until the handle reports it.
+static
+void
+_wc_flush_locked(FileInfo *fi_)
+{
+  int err;
+  size_t done;
+  ssize_t rv;
+  WriteCoalesce &wc = fi_->wc;
+
+  err  = 0;
+  done = 0;
+  while(done < wc.buf.size())
+    {
+      rv = ::_write_direct_io(fi_,
+                              &wc.buf[done],
+                              wc.buf.size() - done,
+                              wc.offset + done);
+      if(rv <= 0)
+        {
+          err = ((rv < 0) ? rv : -EIO);
+          break;
+        }
+
+      done += rv;
+    }
+
+  wc.buf.clear();
+  wc.pending.store(false,std::memory_order_release);
+  if(err < 0)
+    wc.err.store(err,std::memory_order_release);
+}
+
+// Coalescing is only safe while this is the only open handle on the
+// node. Otherwise reads and writes through the other handles would
+// not see the buffered data. The handle is recorded so ops on the
+// node can flush it. Handles not in open_files are private to the
+// caller.
+static
+bool
+_wc_claim(cu64      nodeid_,
+          FileInfo *fi_)
+{
+  bool sole;
+
+  sole = true;
+  state.open_files.visit(nodeid_,
+                         [&](auto &v_)
+                         {
+                           sole = (v_.second.ref_count.load(std::memory_order_relaxed) == 1);
+                           if(sole)
+                             v_.second.wc_fi = fi_;
+                         });
+
+  return sole;
+}
+
+// Small writes which continue the buffered run are appended and
+// acknowledged immediately. Anything else flushes the buffer first:
+// a gap, a write which wouldn't fit or one as large as the buffer
+// which is written through. A failed flush fails the write which
+// triggered it, as with write-back IO errors.
+static
+ssize_t
+_write_coalesced(cu64          nodeid_,
+                 FileInfo     *fi_,
+                 const char   *buf_,
+                 const size_t  count_,
+                 const off_t   offset_,
+                 const size_t  capacity_)
+{
+  int err;
+  bool sole;
+  WriteCoalesce &wc = fi_->wc;
+
+  sole = ::_wc_claim(nodeid_,fi_);
+
+  std::lock_guard<std::mutex> lk(wc.mutex);
+
+  if(!wc.buf.empty() &&
+     (!sole ||
+      (offset_ != (off_t)(wc.offset + wc.buf.size())) ||
+      ((wc.buf.size() + count_) > capacity_)))
+    ::_wc_flush_locked(fi_);
+
+  err = wc.err.exchange(0,std::memory_order_acq_rel);
+  if(err < 0)
+    return err;
+
+  if(!sole || (count_ >= capacity_))
+    return ::_write_direct_io(fi_,buf_,count_,offset_);
+
+  if(wc.buf.empty())
+    {
+      wc.buf.reserve(capacity_);
+      wc.offset = offset_;
+    }
+  wc.buf.insert(wc.buf.end(),buf_,buf_ + count_);
+  wc.pending.store(true,std::memory_order_release);
+
+  if(wc.buf.size() == capacity_)
+    {
+      ::_wc_flush_locked(fi_);
+      err = wc.err.exchange(0,std::memory_order_acq_rel);
+      if(err < 0)
+        return err;
+    }
+
+  return count_;
+}
+
 int
-_write(const fuse_req_ctx_t   *ctx_,
-       const fuse_file_info_t *ffi_,
-       const char             *buf_,
-       const size_t            count_,
-       const off_t             offset_)
+FUSE::write_coalesce_flush(FileInfo *fi_)
 {
-  FileInfo *fi;
+  WriteCoalesce &wc = fi_->wc;
 
-  fi = state.get_fi(ctx_,ffi_->fh);
-  if(not fi)
-    return -EBADF;
+  if(wc.pending.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::mutex> lk(wc.mutex);
+
+      ::_wc_flush_locked(fi_);
+    }
+
+  return wc.err.exchange(0,std::memory_order_acq_rel);
+}
+
+// Any error stays with the handle which buffered the data.
+void
+FUSE::write_coalesce_flush(cu64 nodeid_)
+{
+  state.open_files.visit(nodeid_,
+                         [](auto &v_)
+                         {
+                           FileInfo *fi = v_.second.wc_fi;
+
+                           if(!fi || !fi->wc.pending.load(std::memory_order_acquire))
+                             return;
+
+                           std::lock_guard<std::mutex> lk(fi->wc.mutex);
 
+                           ::_wc_flush_locked(fi);
+                         });
+}
+
+static
+int
+_write(cu64          nodeid_,
+       FileInfo     *fi_,
+       const char   *buf_,
+       const size_t  count_,
+       const off_t   offset_)
+{
   // Concurrent writes can only happen if:
   // 1) writeback-cache is enabled and using page caching
   // 2) parallel_direct_writes is enabled and file has
   // `direct_io=true`
 
-  ssize_t rv;
-
-  if(fi->direct_io)
+  if(fi_->direct_io)
     {
-      {
-        std::shared_lock<std::shared_mutex> slk(fi->mutex);
-        rv = fs::pwrite(fi->fd,buf_,count_,offset_);
-      }
-
-      if(not ::_out_of_space(rv))
-        return rv;
-
-      std::unique_lock<std::shared_mutex> ulk(fi->mutex);
-      // Re-check under exclusive lock: another writer may have
-      // already moved the file and retired. If so the pwrite should
-      // now succeed without our own move call.
-      rv = fs::pwrite(fi->fd,buf_,count_,offset_);
-      if(::_out_of_space(rv))
-        rv = ::_move_and_pwrite(buf_,count_,offset_,fi,rv);
-      return rv;
+      if(cfg.write_coalesce)
+        return ::_write_coalesced(nodeid_,
+                                  fi_,
+                                  buf_,
+                                  count_,
+                                  offset_,
+                                  cfg.write_coalesce * 1024);
+
+      return ::_write_direct_io(fi_,buf_,count_,offset_);
     }
   else
     {
       int err;
       ssize_t written;
+      Relocation *r;
 
       {
-        std::shared_lock<std::shared_mutex> slk(fi->mutex);
-        written = fs::pwriten(fi->fd,buf_,count_,offset_,&err);
+        std::shared_lock<std::shared_mutex> slk(fi_->mutex);
+        r = fi_->relocation.load(std::memory_order_acquire);
+        if(r)
+          return r->pwrite(buf_,count_,offset_);
+        written = fs::pwriten(fi_->fd,buf_,count_,offset_,&err);
       }
 
       if(err == 0)
@@ -181,16 +388,19 @@ _write(const fuse_req_ctx_t   *ctx_,
       if(err && not ::_out_of_space(err))
         return err;
 
-      std::unique_lock<std::shared_mutex> ulk(fi->mutex);
+      std::unique_lock<std::shared_mutex> ulk(fi_->mutex);
       // Re-check under exclusive lock as another move may have
       // already run.
-      written = fs::pwriten(fi->fd,buf_,count_,offset_,&err);
+      r = fi_->relocation.load(std::memory_order_acquire);
+      if(r)
+        return r->pwrite(buf_,count_,offset_);
+      written = fs::pwriten(fi_->fd,buf_,count_,offset_,&err);
       if(err == 0)
         return written;
       if(err && not ::_out_of_space(err))
         return err;
 
-      return ::_move_and_pwriten(buf_,count_,offset_,fi,err,written);
+      return ::_move_and_pwriten(buf_,count_,offset_,fi_,err,written);
     }
 }
 
@@ -201,9 +411,23 @@ FUSE::write(const fuse_req_ctx_t   *ctx_,
             size_t                  count_,
             off_t                   offset_)
 {
+  int rv;
+  u64 start;
   ioprio::SetFrom iop(ctx_->pid);
+  FileInfo *fi;
+
+  fi = state.get_fi(ctx_,ffi_->fh);
+  if(not fi)
+    return -EBADF;
+
+  start = fuse_stats_now_ns();
+  rv    = ::_write(ctx_->nodeid,fi,buf_,count_,offset_);
+  BranchStats::record(fi->stats,BranchStats::WRITE,rv,start);
+
+  AttrCache::invalidate(ctx_->nodeid);
+  HotNodes::touch(ctx_->nodeid);
 
-  return ::_write(ctx_,ffi_,buf_,count_,offset_);
+  return rv;
 }
 
 int
@@ -18,11 +18,25 @@
 
 #pragma once
 
+#include "base_types.h"
+
 #include "fuse.h"
 
 
+class FileInfo;
+
 namespace FUSE
 {
+  // Write out anything buffered by write-coalesce on the handle.
+  // Returns 0 or the -errno of this or an earlier deferred flush.
+  int
+  write_coalesce_flush(FileInfo *fi);
+
+  // Write out anything buffered by whichever handle on the node is
+  // coalescing so path based ops see the current file.
+  void
+  write_coalesce_flush(cu64 nodeid);
+
   int
   write(const fuse_req_ctx_t   *ctx,
         const fuse_file_info_t *ffi,
@@ -0,0 +1,213 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "hot_nodes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+
+#define HOT_NODES_DEPTH      4
+#define HOT_NODES_WIDTH_BITS 12
+#define HOT_NODES_WIDTH      (1 << HOT_NODES_WIDTH_BITS)
+#define HOT_NODES_TOPK       64
+
+static_assert((HOT_NODES_DEPTH * 16) <= 64);
+static_assert(HOT_NODES_WIDTH_BITS <= 16);
+
+static std::atomic<bool> g_enabled{false};
+static std::atomic<u32>  g_sketch[HOT_NODES_DEPTH][HOT_NODES_WIDTH];
+
+// The table is small enough that a linear scan beats anything
+// cleverer. g_threshold is the smallest score in a full table, or 0,
+// and is what touch() checks before trying for the lock.
+static std::mutex         g_mutex;
+static HotNodes::Entry    g_topk[HOT_NODES_TOPK];
+static u32                g_topk_count = 0;
+static std::atomic<u64>   g_threshold{0};
+
+
+static
+inline
+u64
+_hash(u64 x_)
+{
+  x_ += 0x9E3779B97F4A7C15ULL;
+  x_ = (x_ ^ (x_ >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x_ = (x_ ^ (x_ >> 27)) * 0x94D049BB133111EBULL;
+
+  return (x_ ^ (x_ >> 31));
+}
+
+static
+void
+_update_threshold_locked()
+{
+  u64 min;
+
+  if(g_topk_count < HOT_NODES_TOPK)
+    {
+      g_threshold.store(0,std::memory_order_relaxed);
+      return;
+    }
+
+  min = g_topk[0].score;
+  for(u32 i = 1; i < g_topk_count; i++)
+    min = std::min(min,g_topk[i].score);
+
+  g_threshold.store(min,std::memory_order_relaxed);
+}
+
+static
+void
+_topk_update_locked(cu64 nodeid_,
+                    cu64 score_)
+{
+  u32 min_idx;
+
+  for(u32 i = 0; i < g_topk_count; i++)
+    {
+      if(g_topk[i].nodeid != nodeid_)
+        continue;
+      g_topk[i].score = std::max(g_topk[i].score,score_);
+      return;
+    }
+
+  if(g_topk_count < HOT_NODES_TOPK)
+    {
+      g_topk[g_topk_count++] = {nodeid_,score_};
+      ::_update_threshold_locked();
+      return;
+    }
+
+  min_idx = 0;
+  for(u32 i = 1; i < g_topk_count; i++)
+    {
+      if(g_topk[i].score < g_topk[min_idx].score)
+        min_idx = i;
+    }
+
+  if(score_ <= g_topk[min_idx].score)
+    return;
+
+  g_topk[min_idx] = {nodeid_,score_};
+  ::_update_threshold_locked();
+}
+
+void
+HotNodes::enable(const bool enabled_)
+{
+  if(enabled_ == g_enabled.load(std::memory_order_relaxed))
+    return;
+
+  HotNodes::clear();
+  g_enabled.store(enabled_,std::memory_order_relaxed);
+}
+
+void
+HotNodes::touch(cu64 nodeid_)
+{
+  u64 h;
+  u64 est;
+
+  if(!g_enabled.load(std::memory_order_relaxed))
+    return;
+
+  h   = ::_hash(nodeid_);
+  est = ~0ULL;
+  for(u32 d = 0; d < HOT_NODES_DEPTH; d++)
+    {
+      u32 idx;
+      u64 val;
+
+      idx = ((h >> (d * 16)) & (HOT_NODES_WIDTH - 1));
+      val = (g_sketch[d][idx].fetch_add(1,std::memory_order_relaxed) + 1);
+      est = std::min(est,val);
+    }
+
+  if(est < g_threshold.load(std::memory_order_relaxed))
+    return;
+
+  std::unique_lock<std::mutex> lk(g_mutex,std::try_to_lock);
+  if(!lk.owns_lock())
+    return;
+
+  ::_topk_update_locked(nodeid_,est);
+}
+
+void
+HotNodes::decay()
+{
+  u32 n;
+
+  if(!g_enabled.load(std::memory_order_relaxed))
+    return;
+
+  // Racing increments may be lost which is fine for an estimate.
+  for(auto &row : g_sketch)
+    for(auto &c : row)
+      c.store(c.load(std::memory_order_relaxed) >> 1,
+              std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  n = 0;
+  for(u32 i = 0; i < g_topk_count; i++)
+    {
+      g_topk[i].score >>= 1;
+      if(g_topk[i].score)
+        g_topk[n++] = g_topk[i];
+    }
+  g_topk_count = n;
+
+  ::_update_threshold_locked();
+}
+
+void
+HotNodes::clear()
+{
+  for(auto &row : g_sketch)
+    for(auto &c : row)
+      c.store(0,std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  g_topk_count = 0;
+  ::_update_threshold_locked();
+}
+
+std::vector<HotNodes::Entry>
+HotNodes::top()
+{
+  std::vector<Entry> rv;
+
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+
+    rv.assign(&g_topk[0],&g_topk[g_topk_count]);
+  }
+
+  std::sort(rv.begin(),rv.end(),
+            [](const Entry &a_, const Entry &b_)
+            {
+              return (a_.score > b_.score);
+            });
+
+  return rv;
+}
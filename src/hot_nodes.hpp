@@ -0,0 +1,66 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  HOT NODES
+  =========
+
+  Tracks which nodes see the most reads, writes and lookups so tiering
+  tools can find what is hot without scanning access times. Reads and
+  writes are counted against the file and lookups against the
+  directory being searched so both hot files and hot directories show
+  up.
+
+  Counts go into a count-min sketch: DEPTH rows of WIDTH counters each
+  indexed by a different slice of the nodeid's hash. The estimate for
+  a node is the smallest of its counters, which can overcount due to
+  collisions but never undercounts. Memory is fixed regardless of how
+  many files are touched.
+
+  Alongside sits a small table of the TOPK nodes with the largest
+  estimates. Updating the sketch is a few relaxed atomic adds. Only a
+  node whose estimate reaches the smallest in the table tries for the
+  table's lock, and if it is busy the update is skipped rather than
+  waited on.
+
+  Every counter is halved once a minute so scores follow recent
+  activity with a half-life of about a minute.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include <vector>
+
+
+namespace HotNodes
+{
+  struct Entry
+  {
+    u64 nodeid;
+    u64 score;
+  };
+
+  void enable(const bool enabled);
+  void touch(cu64 nodeid);
+  void decay();
+  void clear();
+
+  std::vector<Entry> top();
+}
@@ -0,0 +1,68 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "kernel_notify.hpp"
+
+#include "attr_cache.hpp"
+#include "thread_pool.hpp"
+
+#include "fuse.h"
+
+
+#define KERNEL_NOTIFY_THREADS     1
+#define KERNEL_NOTIFY_QUEUE_DEPTH 4096
+
+// Created on first use so nothing is spawned unless needed.
+static
+ThreadPool&
+_pool()
+{
+  static ThreadPool tp(KERNEL_NOTIFY_THREADS,
+                       KERNEL_NOTIFY_QUEUE_DEPTH,
+                       "kernel.notify");
+
+  return tp;
+}
+
+static
+void
+_notify(const fs::path &fusepath_,
+        const u32       flags_)
+{
+  ::_pool().try_enqueue_work([fusepath = fusepath_,flags_]()
+  {
+    int rv;
+    u64 nodeid;
+
+    rv = fuse_invalidate_path(fusepath.c_str(),flags_,&nodeid);
+    if((rv == 0) && nodeid)
+      AttrCache::invalidate(nodeid);
+  });
+}
+
+void
+KernelNotify::expire(const fs::path &fusepath_)
+{
+  ::_notify(fusepath_,FUSE_INVAL_EXPIRE_ONLY|FUSE_INVAL_ATTR_ONLY);
+}
+
+void
+KernelNotify::invalidate(const fs::path &fusepath_)
+{
+  ::_notify(fusepath_,0);
+}
@@ -0,0 +1,39 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "fs_path.hpp"
+
+
+// Tells the kernel that what it has cached for a path is stale after
+// mergerfs itself changed the path behind its back: moving a file to
+// another branch, breaking a hardlink, or replacing the target of a
+// rename with a symlink. The kernel must not be notified from within
+// a request touching the same inode so notifications are sent from a
+// dedicated thread. If its queue is full the notification is dropped
+// and the kernel's caches time out as they otherwise would.
+namespace KernelNotify
+{
+  // The content is the same but the file lives elsewhere: the entry
+  // is expired and attributes dropped while the page cache is kept.
+  void expire(const fs::path &fusepath);
+
+  // The path now refers to something else entirely.
+  void invalidate(const fs::path &fusepath);
+}
@@ -0,0 +1,112 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "mem_branch.hpp"
+
+#include "errno.hpp"
+#include "syslog.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+#include <unistd.h>
+
+
+#define MEM_BRANCH_PREFIX "@mem"
+
+static std::mutex                         g_mutex;
+static std::map<std::string,std::string> g_dirs;
+
+
+static
+void
+_cleanup(void)
+{
+  std::error_code ec;
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  for(const auto &[name,dir] : g_dirs)
+    std::filesystem::remove_all(dir,ec);
+  g_dirs.clear();
+}
+
+// /dev/shm is tmpfs on practically every Linux system. Fall back to
+// $TMPDIR or /tmp which may or may not be.
+static
+std::string
+_base_dir(void)
+{
+  const char *tmpdir;
+  std::error_code ec;
+
+  if(std::filesystem::is_directory("/dev/shm",ec) &&
+     (::access("/dev/shm",W_OK) == 0))
+    return "/dev/shm";
+
+  tmpdir = ::getenv("TMPDIR");
+  if(tmpdir && *tmpdir)
+    return tmpdir;
+
+  return "/tmp";
+}
+
+bool
+MemBranch::is_mem(const std::string_view spec_)
+{
+  std::string_view rest;
+
+  if(spec_.substr(0,sizeof(MEM_BRANCH_PREFIX)-1) != MEM_BRANCH_PREFIX)
+    return false;
+
+  rest = spec_.substr(sizeof(MEM_BRANCH_PREFIX)-1);
+
+  return (rest.empty() || (rest[0] == '.'));
+}
+
+int
+MemBranch::path(const std::string_view  spec_,
+                std::string            *path_)
+{
+  std::string tmpl;
+  std::lock_guard<std::mutex> lk(g_mutex);
+
+  auto i = g_dirs.find(std::string{spec_});
+  if(i != g_dirs.end())
+    {
+      *path_ = i->second;
+      return 0;
+    }
+
+  tmpl = ::_base_dir() + "/mergerfs.mem.XXXXXX";
+  if(::mkdtemp(tmpl.data()) == NULL)
+    return -errno;
+
+  if(g_dirs.empty())
+    std::atexit(::_cleanup);
+  g_dirs.emplace(spec_,tmpl);
+
+  SysLog::info("memory branch `{}` created at {}",
+               spec_,
+               tmpl);
+
+  *path_ = tmpl;
+
+  return 0;
+}
@@ -0,0 +1,35 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+
+// `@mem` style branches for benchmarking and testing. This is a
+// convenience over tmpfs, not an in-process backend: each distinct
+// name (`@mem`, `@mem.2`, ...) is a temporary directory on /dev/shm
+// created the first time the name is used and removed when mergerfs
+// exits. Nothing is mounted so all of them share that filesystem.
+namespace MemBranch
+{
+  bool is_mem(const std::string_view spec);
+  int  path(const std::string_view  spec,
+            std::string            *path);
+}
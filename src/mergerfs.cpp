@@ -19,6 +19,7 @@
 #include "mergerfs.hpp"
 #include "mergerfs_fsck.hpp"
 #include "mergerfs_collect_info.hpp"
+#include "mergerfs_stats.hpp"
 
 #include "caps.hpp"
 #include "config.hpp"
@@ -386,6 +387,8 @@ _pick_app_and_run(int    argc_,
     return mergerfs::fsck::main(argc_,argv_);
   if(appname == "mergerfs.collect-info")
     return mergerfs::collect_info::main(argc_,argv_);
+  if(appname == "mergerfs.stats")
+    return mergerfs::stats::main(argc_,argv_);
 
   return ::_main(argc_,argv_);
 }
@@ -90,6 +90,32 @@ mergerfs::api::allpaths(const std::string        &input_path_,
   return 0;
 }
 
+// Returns just the branch paths. Mode and minfreespace are dropped.
+int
+mergerfs::api::branches(const fs::path           &mountpoint_,
+                        std::vector<std::string> &paths_)
+{
+  int rv;
+  std::string val;
+  fs::path dot_mergerfs_filepath;
+
+  dot_mergerfs_filepath = mountpoint_ / ".mergerfs";
+
+  rv = ::_lgetxattr(dot_mergerfs_filepath,"branches",val);
+  if(rv < 0)
+    return rv;
+
+  paths_.clear();
+  for(const auto &branch : str::split(val,':'))
+    {
+      if(branch.empty())
+        continue;
+      paths_.emplace_back(str::rsplit1(branch,'=')[0]);
+    }
+
+  return 0;
+}
+
 int
 mergerfs::api::basepath(const std::string &input_path_,
                         std::string       &basepath_)
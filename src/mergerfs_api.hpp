@@ -48,5 +48,8 @@ namespace mergerfs
     int
     allpaths(const std::string        &path,
              std::vector<std::string> &paths);
+    int
+    branches(const fs::path           &mountpoint,
+             std::vector<std::string> &paths);
   }
 }
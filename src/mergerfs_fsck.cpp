@@ -26,6 +26,8 @@
 #include "fs_lgetxattr.hpp"
 #include "fs_lstat.hpp"
 #include "fs_open.hpp"
+#include "fsck_index.hpp"
+#include "fsck_scan.hpp"
 #include "mergerfs_api.hpp"
 #include "str.hpp"
 
@@ -35,23 +37,15 @@
 
 #include "base_types.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <thread>
 
 namespace FS = std::filesystem;
 
-struct PathStat
-{
-  PathStat(const std::string &path_)
-    : path(path_),
-      st{}
-  {
-  }
-
-  std::string path;
-  struct stat st;
-};
-
-using PathStatVec = std::vector<PathStat>;
 using FixFunc = std::function<void(const PathStatVec&,const bool)>;
 
 static
@@ -126,28 +120,18 @@ _file_type(const mode_t mode_)
   return "unknown";
 }
 
+// Expects pathstats_ to have already been stat'ed. Returns true if
+// the files differed.
 static
-void
-_compare_files(const std::string &mergerfs_path_,
-               PathStatVec       &pathstats_,
-               const FixFunc      fix_func_,
-               const bool         check_size_,
-               const bool         copy_file_)
+bool
+_report_and_fix(const std::string &mergerfs_path_,
+                const PathStatVec &pathstats_,
+                const FixFunc      fix_func_,
+                const bool         check_size_,
+                const bool         copy_file_)
 {
-  int rv;
-
-  if(pathstats_.size() <= 1)
-    return;
-
-  for(auto &pathstat : pathstats_)
-    {
-      rv = fs::lstat(pathstat.path,&pathstat.st);
-      if(rv < 0)
-        pathstat.st.st_size = rv;
-    }
-
   if(!::_files_differ(pathstats_,check_size_))
-    return;
+    return false;
 
   fmt::println("* {}",mergerfs_path_);
   for(u64 i = 0; i < pathstats_.size(); i++)
@@ -177,13 +161,42 @@ _compare_files(const std::string &mergerfs_path_,
     }
 
   if(!fix_func_)
-    return;
+    return true;
 
   if(::_files_same_type(pathstats_))
     fix_func_(pathstats_,copy_file_);
   else
     fmt::println("  X: WARNING - files are of different types."
                  " Requires manual intervention.");
+
+  return true;
+}
+
+static
+void
+_compare_files(const std::string &mergerfs_path_,
+               PathStatVec       &pathstats_,
+               const FixFunc      fix_func_,
+               const bool         check_size_,
+               const bool         copy_file_)
+{
+  int rv;
+
+  if(pathstats_.size() <= 1)
+    return;
+
+  for(auto &pathstat : pathstats_)
+    {
+      rv = fs::lstat(pathstat.path,&pathstat.st);
+      if(rv < 0)
+        pathstat.st.st_size = rv;
+    }
+
+  ::_report_and_fix(mergerfs_path_,
+                    pathstats_,
+                    fix_func_,
+                    check_size_,
+                    copy_file_);
 }
 
 static
@@ -408,6 +421,179 @@ _fsck(const FS::path &path_,
     }
 }
 
+static
+FS::path
+_find_mountpoint(const FS::path &path_)
+{
+  FS::path path;
+
+  path = FS::absolute(path_).lexically_normal();
+  while(true)
+    {
+      if(mergerfs::api::is_mergerfs(path))
+        return path;
+      if(path == path.root_path())
+        return {};
+      path = path.parent_path();
+    }
+}
+
+static
+void
+_print_progress(FsckScan::Scan &scan_,
+                const double   secs_,
+                FILE          *output_)
+{
+  u64 dirs    = scan_.dirs.load(std::memory_order_relaxed);
+  u64 entries = scan_.entries.load(std::memory_order_relaxed);
+
+  fmt::println(output_,
+               "scanned {} dirs, {} entries in {:.1f}s"
+               " ({:.0f} dirs/s, {:.0f} entries/s);"
+               " {} unchanged; {} on multiple branches, {} mismatched",
+               dirs,
+               entries,
+               secs_,
+               (dirs / std::max(secs_,0.001)),
+               (entries / std::max(secs_,0.001)),
+               scan_.skipped.load(std::memory_order_relaxed),
+               scan_.duplicates.load(std::memory_order_relaxed),
+               scan_.mismatches.load(std::memory_order_relaxed));
+}
+
+// The index is only valid for the same branches, in the same order,
+// and the same comparison options.
+static
+u64
+_index_confighash(const FsckScan::Scan &scan_,
+                  const bool            check_size_)
+{
+  std::string s;
+
+  for(const auto &branch : scan_.branches)
+    s += branch + '\0';
+  s += (check_size_ ? "check-size" : "");
+
+  return FsckIndex::hash(s);
+}
+
+static
+int
+_fsck_branches(const FS::path    &path_,
+               const FixFunc      fix_func_,
+               const bool         check_size_,
+               const bool         copy_file_,
+               const u64          threads_,
+               const std::string &index_)
+{
+  int rv;
+  std::string relpath;
+  FsckScan::Scan scan;
+  std::atomic<u64> finished;
+  std::vector<std::thread> threads;
+
+  scan.mountpoint = ::_find_mountpoint(path_);
+  if(scan.mountpoint.empty())
+    {
+      fmt::println(stderr,"ERROR: {} is not within a mergerfs mount",path_.string());
+      return 1;
+    }
+
+  rv = mergerfs::api::branches(scan.mountpoint,scan.branches);
+  if(rv < 0)
+    {
+      fmt::println(stderr,
+                   "ERROR: unable to read branches from {} - {}",
+                   scan.mountpoint.string(),
+                   strerror(-rv));
+      return 1;
+    }
+
+  scan.report =
+    [&](const std::string &mergerfs_path_,
+        const PathStatVec &pathstats_)
+    {
+      return ::_report_and_fix(mergerfs_path_,
+                               pathstats_,
+                               fix_func_,
+                               check_size_,
+                               copy_file_);
+    };
+
+  if(!index_.empty())
+    {
+      rv = scan.index_in.open(index_,
+                              ::_index_confighash(scan,check_size_),
+                              scan.branches.size());
+      if(rv == 0)
+        fmt::println(stderr,
+                     "loaded index {} with {} files",
+                     index_,
+                     scan.index_in.count());
+      else if(rv != -ENOENT)
+        fmt::println(stderr,
+                     "WARNING: ignoring index {} - {}",
+                     index_,
+                     ((rv == -EINVAL) ?
+                      "incompatible or for different branches/options" :
+                      strerror(-rv)));
+      scan.index_out = std::make_unique<FsckIndex::Writer>(scan.branches.size());
+    }
+
+  relpath = FS::absolute(path_).lexically_normal().lexically_relative(scan.mountpoint).string();
+  if(relpath == ".")
+    relpath.clear();
+  if(!relpath.empty() && (relpath.back() == '/'))
+    relpath.pop_back();
+
+  FsckScan::DirQueue queue(threads_);
+
+  queue.push(0,std::move(relpath));
+
+  finished = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(u64 i = 0; i < threads_; i++)
+    threads.emplace_back([&,i]()
+                         {
+                           FsckScan::scan_thread(scan,queue,i);
+                           finished.fetch_add(1);
+                         });
+
+  auto elapsed =
+    [&]()
+    {
+      std::chrono::duration<double> d = (std::chrono::steady_clock::now() - start);
+      return d.count();
+    };
+
+  for(u64 n = 1; finished.load() < threads_; n++)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if((n % 1000) == 0)
+        ::_print_progress(scan,elapsed(),stderr);
+    }
+
+  for(auto &thread : threads)
+    thread.join();
+
+  ::_print_progress(scan,elapsed(),stdout);
+
+  if(scan.index_out)
+    {
+      rv = scan.index_out->write(index_,::_index_confighash(scan,check_size_));
+      if(rv < 0)
+        {
+          fmt::println(stderr,
+                       "ERROR: unable to write index {} - {}",
+                       index_,
+                       strerror(-rv));
+          return 1;
+        }
+    }
+
+  return 0;
+}
+
 int
 mergerfs::fsck::main(int    argc_,
                      char **argv_)
@@ -417,6 +603,9 @@ mergerfs::fsck::main(int    argc_,
   std::string fix;
   bool check_size;
   bool copy_file;
+  bool branches;
+  u64 threads;
+  std::string index;
   FixFunc fix_func;
 
   app.description("fsck.mergerfs:"
@@ -443,6 +632,16 @@ mergerfs::fsck::main(int    argc_,
     ->description("Copy file rather than chown/chmod to fix")
     ->default_val(false)
     ->default_str("false");
+  app.add_flag("--branches",branches)
+    ->description("Scan the branches directly and in parallel rather than"
+                  " through the mergerfs mount");
+  app.add_option("--threads",threads)
+    ->description("Number of threads used with --branches")
+    ->check(CLI::PositiveNumber)
+    ->default_val(std::max(1U,std::thread::hardware_concurrency()));
+  app.add_option("--index",index)
+    ->description("Index file used to skip comparing files unchanged since"
+                  " the last run. Implies --branches");
 
   try
     {
@@ -458,6 +657,14 @@ mergerfs::fsck::main(int    argc_,
 
   fix_func = ::_select_fix_func(fix);
 
+  if(branches || !index.empty())
+    return ::_fsck_branches(path,
+                            fix_func,
+                            check_size,
+                            copy_file,
+                            threads,
+                            index);
+
   ::_fsck(path,
           fix_func,
           check_size,
@@ -43,3 +43,117 @@ struct mergerfs_ioctl_t
 #define MERGERFS_IOCTL_APP_TYPE 0xDF
 #define MERGERFS_IOCTL_GET      _IOWR(MERGERFS_IOCTL_APP_TYPE,0,mergerfs_ioctl_t)
 #define MERGERFS_IOCTL_SET      _IOWR(MERGERFS_IOCTL_APP_TYPE,1,mergerfs_ioctl_t)
+#define MERGERFS_IOCTL_STATS    _IOWR(MERGERFS_IOCTL_APP_TYPE,2,mergerfs_ioctl_t)
+
+/*
+  MERGERFS_IOCTL_STATS takes a `mergerfs_stats_req_t` at the start of
+  `mergerfs_ioctl_t::buf`, replaces it with a binary snapshot and sets
+  `size` to the number of bytes used. It can be issued against any
+  file or directory in the mount including the mountpoint itself.
+
+  The snapshot starts with a header followed by `op_count` records of
+  `op_size` bytes and then `branch_count` branch records. Each branch
+  record is `branch_size` bytes followed by `path_len` bytes of path
+  (not NUL terminated). Readers should use the sizes from the header
+  rather than sizeof() so newer versions can append fields. Only
+  opcodes which have been seen are included.
+
+  Branches are paged: the snapshot holds branches `branch_offset` to
+  `branch_offset + branch_count` of `branch_total`. To get the rest
+  issue the ioctl again with `branch_offset` advanced by
+  `branch_count`. Op records are only included when `branch_offset`
+  is 0. A page always has room for at least one branch so this makes
+  progress for any path length. The TRUNCATED flag is set if not all
+  op records fit or a path had to be cut.
+*/
+#define MERGERFS_STATS_MAGIC          0x5453464DU /* "MFST" */
+#define MERGERFS_STATS_VERSION        2
+#define MERGERFS_STATS_HIST_BUCKETS   24
+#define MERGERFS_STATS_FLAG_TRUNCATED (1 << 0)
+
+#define MERGERFS_STATS_BRANCH_OP_READ  0
+#define MERGERFS_STATS_BRANCH_OP_WRITE 1
+#define MERGERFS_STATS_BRANCH_OP_OPEN  2
+#define MERGERFS_STATS_BRANCH_OP_SYNC  3
+#define MERGERFS_STATS_BRANCH_OPS      4
+
+#pragma pack(push,1)
+struct mergerfs_stats_req_t
+{
+  u32 branch_offset;
+};
+
+struct mergerfs_stats_hdr_t
+{
+  u32 magic;
+  u16 version;
+  u16 flags;
+  u32 size;
+  u32 hdr_size;
+  u64 time_ns;
+  u32 op_count;
+  u32 op_size;
+  u32 branch_count;
+  u32 branch_size;
+
+  u64 msgbuf_bufsize;
+  u64 msgbuf_allocated;
+  u64 nodes;
+  u64 node_table_size;
+  u32 read_threads;
+  u32 process_threads;
+  u32 fanout_threads;
+  u32 reserved;
+
+  u64 attr_cache_hits;
+  u64 attr_cache_misses;
+  u64 attr_cache_size;
+  u64 fd_cache_hits;
+  u64 fd_cache_misses;
+  u64 fd_cache_evictions;
+  u64 fd_cache_size;
+
+  u32 branch_offset;
+  u32 branch_total;
+};
+
+// Latency bucket 0 is < 1us, bucket N is [2^(N-1),2^N)us, and the
+// last bucket is everything slower.
+struct mergerfs_stats_op_t
+{
+  u32 opcode;
+  u32 reserved;
+  u64 count;
+  u64 errors;
+  u64 total_ns;
+  u64 hist[MERGERFS_STATS_HIST_BUCKETS];
+};
+
+// Space figures come from periodic statvfs probes of the branch.
+// probe_start_ns is non-zero while a probe is outstanding so a branch
+// which stops responding can be seen as such. Times are
+// CLOCK_MONOTONIC like the header's time_ns.
+//
+// The IO counters cover reads, writes, fsyncs on files opened from
+// the branch and the opens and creates themselves, indexed by
+// MERGERFS_STATS_BRANCH_OP_*. `hist` covers all of them.
+struct mergerfs_stats_branch_t
+{
+  u32  mode;
+  s32  probe_err;
+  u64  minfreespace;
+  u64  spaceavail;
+  u64  spaceused;
+  u64  probe_start_ns;
+  u64  probe_done_ns;
+  u64  probe_latency_ns;
+  u32  path_len;
+  u32  reserved;
+  u64  ops[MERGERFS_STATS_BRANCH_OPS];
+  u64  errors[MERGERFS_STATS_BRANCH_OPS];
+  u64  total_ns[MERGERFS_STATS_BRANCH_OPS];
+  u64  read_bytes;
+  u64  write_bytes;
+  u64  hist[MERGERFS_STATS_HIST_BUCKETS];
+};
+#pragma pack(pop)
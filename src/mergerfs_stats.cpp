@@ -0,0 +1,440 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "mergerfs_stats.hpp"
+
+#include "branch.hpp"
+#include "mergerfs_ioctl.hpp"
+#include "num.hpp"
+#include "stats_shm.hpp"
+
+#include "debug.hpp"
+
+#include "CLI11/CLI11.hpp"
+#include "fmt/core.h"
+
+#include "base_types.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// A probe outstanding for longer than this is reported as stalled.
+#define STALLED_NS (5ULL * 1000 * 1000 * 1000)
+
+namespace l
+{
+  struct Branch
+  {
+    mergerfs_stats_branch_t rec;
+    std::string             path;
+  };
+}
+
+
+static
+u64
+_now_ns()
+{
+  timespec ts;
+
+  ::clock_gettime(CLOCK_MONOTONIC,&ts);
+
+  return ((u64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+static
+std::string
+_fmt_ns(cu64 ns_)
+{
+  if(ns_ < 1000ULL)
+    return fmt::format("{}ns",ns_);
+  if(ns_ < 1000000ULL)
+    return fmt::format("{:.1f}us",ns_ / 1000.0);
+  if(ns_ < 1000000000ULL)
+    return fmt::format("{:.1f}ms",ns_ / 1000000.0);
+  return fmt::format("{:.1f}s",ns_ / 1000000000.0);
+}
+
+static
+std::string
+_fmt_bytes(cu64 bytes_)
+{
+  const char *units = "KMGTPE";
+  double v;
+
+  if(bytes_ < 1024)
+    return fmt::format("{}B",bytes_);
+
+  v = bytes_;
+  for(int i = 0; units[i]; i++)
+    {
+      v /= 1024;
+      if((v < 1024) || (units[i + 1] == '\0'))
+        return fmt::format("{:.1f}{}",v,units[i]);
+    }
+
+  return {};
+}
+
+// Returns the upper bound of the histogram bucket containing the
+// requested percentile. Bucket 0 is < 1us and bucket N is
+// [2^(N-1),2^N)us so the result is a power of two in us.
+static
+std::string
+_percentile(const u64    *hist_,
+            cu64          count_,
+            const double  pct_)
+{
+  u64 sum;
+  u64 target;
+
+  if(count_ == 0)
+    return "-";
+
+  sum    = 0;
+  target = (u64)(count_ * pct_);
+  for(int i = 0; i < MERGERFS_STATS_HIST_BUCKETS; i++)
+    {
+      sum += hist_[i];
+      if(sum <= target)
+        continue;
+      if(i == (MERGERFS_STATS_HIST_BUCKETS - 1))
+        return fmt::format(">{}",::_fmt_ns((1ULL << (i - 1)) * 1000));
+      return fmt::format("<{}",::_fmt_ns((1ULL << i) * 1000));
+    }
+
+  return "-";
+}
+
+static
+std::string
+_health(const mergerfs_stats_branch_t &br_,
+        cu64                           now_ns_)
+{
+  if(br_.probe_start_ns && ((now_ns_ - br_.probe_start_ns) > STALLED_NS))
+    return fmt::format("stalled for {}",
+                       ::_fmt_ns(now_ns_ - br_.probe_start_ns));
+  if(br_.probe_done_ns == 0)
+    return "unknown";
+  if(br_.probe_err < 0)
+    return fmt::format("error: {}",strerror(-br_.probe_err));
+  return fmt::format("ok ({})",::_fmt_ns(br_.probe_latency_ns));
+}
+
+static
+const char*
+_mode(cu32 mode_)
+{
+  switch((Branch::Mode)mode_)
+    {
+    case Branch::Mode::RW:
+      return "RW";
+    case Branch::Mode::RO:
+      return "RO";
+    case Branch::Mode::NC:
+      return "NC";
+    }
+
+  return "??";
+}
+
+static
+void
+_print(const mergerfs_stats_shm_t *shm_,
+       const char                 *buf_,
+       cu32                        size_)
+{
+  u64 now_ns;
+  u32 offset;
+  mergerfs_stats_hdr_t hdr;
+  std::vector<l::Branch> branches;
+
+  if(size_ < sizeof(hdr))
+    return;
+  std::memcpy(&hdr,buf_,sizeof(hdr));
+  if((hdr.magic != MERGERFS_STATS_MAGIC) ||
+     (hdr.version != MERGERFS_STATS_VERSION))
+    {
+      fmt::print("pid {}: unsupported stats version\n",shm_->pid);
+      return;
+    }
+
+  now_ns = ::_now_ns();
+
+  fmt::print("pid:         {}\n"
+             "mountpoint:  {}\n"
+             "age:         {}\n"
+             "threads:     read={} process={} fanout={}\n"
+             "msgbufs:     {} x {}\n"
+             "nodes:       {} (table size {})\n"
+             "attr cache:  hits={} misses={} size={}\n"
+             "fd cache:    hits={} misses={} evictions={} size={}\n",
+             shm_->pid,
+             shm_->mountpoint,
+             ::_fmt_ns(now_ns - hdr.time_ns),
+             hdr.read_threads,
+             hdr.process_threads,
+             hdr.fanout_threads,
+             hdr.msgbuf_allocated,
+             num::humanize(hdr.msgbuf_bufsize),
+             hdr.nodes,
+             hdr.node_table_size,
+             hdr.attr_cache_hits,
+             hdr.attr_cache_misses,
+             hdr.attr_cache_size,
+             hdr.fd_cache_hits,
+             hdr.fd_cache_misses,
+             hdr.fd_cache_evictions,
+             hdr.fd_cache_size);
+  if((hdr.flags & MERGERFS_STATS_FLAG_TRUNCATED) ||
+     (hdr.branch_count < hdr.branch_total))
+    fmt::print("note:        snapshot truncated\n");
+
+  offset = hdr.hdr_size;
+
+  fmt::print("\n{:<16} {:>12} {:>10} {:>10} {:>10} {:>10}\n",
+             "op","count","errors","avg","p50","p99");
+  for(u32 i = 0; i < hdr.op_count; i++)
+    {
+      mergerfs_stats_op_t op = {};
+
+      if((offset + hdr.op_size) > size_)
+        return;
+      std::memcpy(&op,&buf_[offset],std::min<u32>(sizeof(op),hdr.op_size));
+      offset += hdr.op_size;
+
+      fmt::print("{:<16} {:>12} {:>10} {:>10} {:>10} {:>10}\n",
+                 fuse_debug_opcode_name(op.opcode),
+                 op.count,
+                 op.errors,
+                 ::_fmt_ns(op.count ? (op.total_ns / op.count) : 0),
+                 ::_percentile(op.hist,op.count,0.50),
+                 ::_percentile(op.hist,op.count,0.99));
+    }
+
+  branches.reserve(hdr.branch_count);
+  for(u32 i = 0; i < hdr.branch_count; i++)
+    {
+      l::Branch br = {};
+
+      if((offset + hdr.branch_size) > size_)
+        break;
+      std::memcpy(&br.rec,&buf_[offset],std::min<u32>(sizeof(br.rec),hdr.branch_size));
+      offset += hdr.branch_size;
+      if((offset + br.rec.path_len) > size_)
+        break;
+      br.path.assign(&buf_[offset],br.rec.path_len);
+      offset += br.rec.path_len;
+
+      branches.emplace_back(std::move(br));
+    }
+
+  fmt::print("\n{:<4} {:>10} {:>10} {:>10}  {:<24} {}\n",
+             "mode","avail","used","minfree","health","path");
+  for(const auto &b : branches)
+    fmt::print("{:<4} {:>10} {:>10} {:>10}  {:<24} {}\n",
+               ::_mode(b.rec.mode),
+               num::humanize(b.rec.spaceavail),
+               num::humanize(b.rec.spaceused),
+               num::humanize(b.rec.minfreespace),
+               ::_health(b.rec,now_ns),
+               b.path);
+
+  fmt::print("\n{:>10} {:>10} {:>10} {:>10} {:>8} {:>8} {:>10} {:>10}  {}\n",
+             "reads","read","writes","written","opens","errors","avg","p99","path");
+  for(const auto &b : branches)
+    {
+      const mergerfs_stats_branch_t &br = b.rec;
+      u64 ops;
+      u64 errors;
+      u64 total_ns;
+
+      ops = errors = total_ns = 0;
+      for(u32 i = 0; i < MERGERFS_STATS_BRANCH_OPS; i++)
+        {
+          ops      += br.ops[i];
+          errors   += br.errors[i];
+          total_ns += br.total_ns[i];
+        }
+
+      fmt::print("{:>10} {:>10} {:>10} {:>10} {:>8} {:>8} {:>10} {:>10}  {}\n",
+                 br.ops[MERGERFS_STATS_BRANCH_OP_READ],
+                 ::_fmt_bytes(br.read_bytes),
+                 br.ops[MERGERFS_STATS_BRANCH_OP_WRITE],
+                 ::_fmt_bytes(br.write_bytes),
+                 br.ops[MERGERFS_STATS_BRANCH_OP_OPEN],
+                 errors,
+                 ::_fmt_ns(ops ? (total_ns / ops) : 0),
+                 ::_percentile(br.hist,ops,0.99),
+                 b.path);
+    }
+}
+
+static
+int
+_show(const std::string &path_,
+      const pid_t        pid_,
+      const std::string &mountpoint_)
+{
+  int fd;
+  int rv;
+  void *mem;
+  struct stat st;
+  const mergerfs_stats_shm_t *shm;
+  std::unique_ptr<char[]> buf;
+
+  fd = ::open(path_.c_str(),O_RDONLY|O_NOFOLLOW|O_CLOEXEC);
+  if(fd < 0)
+    return -errno;
+
+  // Mapping past the end of the file would SIGBUS on access.
+  rv = ::fstat(fd,&st);
+  if(rv < 0)
+    rv = -errno;
+  else if(!S_ISREG(st.st_mode) ||
+          (st.st_size < (off_t)sizeof(mergerfs_stats_shm_t)))
+    rv = -EINVAL;
+  if(rv < 0)
+    {
+      ::close(fd);
+      return rv;
+    }
+
+  mem = ::mmap(NULL,sizeof(mergerfs_stats_shm_t),PROT_READ,MAP_SHARED,fd,0);
+  ::close(fd);
+  if(mem == MAP_FAILED)
+    return -errno;
+
+  shm = (const mergerfs_stats_shm_t*)mem;
+  if((shm->magic != MERGERFS_STATS_SHM_MAGIC) ||
+     (shm->version != MERGERFS_STATS_SHM_VERSION))
+    rv = -EINVAL;
+  else if((pid_ > 0) && ((pid_t)shm->pid != pid_))
+    rv = -ENOENT;
+  else if(!mountpoint_.empty() && (mountpoint_ != shm->mountpoint))
+    rv = -ENOENT;
+  else if((::kill(shm->pid,0) < 0) && (errno == ESRCH))
+    rv = -ESRCH;
+  else
+    {
+      buf.reset(new char[sizeof(shm->data)]);
+      rv = StatsShm::read(shm,buf.get(),sizeof(shm->data));
+      if(rv >= 0)
+        ::_print(shm,buf.get(),rv);
+    }
+
+  ::munmap(mem,sizeof(mergerfs_stats_shm_t));
+
+  return rv;
+}
+
+int
+mergerfs::stats::main(int    argc_,
+                      char **argv_)
+{
+  int rv;
+  int shown;
+  pid_t pid;
+  CLI::App app;
+  std::string mountpoint;
+  std::vector<std::string> paths;
+
+  pid = 0;
+  app.description("mergerfs.stats:"
+                  " Print stats published by mergerfs instances"
+                  " with stats.shm=true");
+  app.name("USAGE: mergerfs.stats");
+  app.add_option("-p,--pid",pid)
+    ->description("Only show the instance with this pid");
+  app.add_option("mountpoint",mountpoint)
+    ->description("Only show the instance mounted here")
+    ->type_name("PATH");
+
+  try
+    {
+      app.parse(argc_,argv_);
+    }
+  catch(const CLI::ParseError &e)
+    {
+      return app.exit(e);
+    }
+
+  // Normalized lexically only. Resolving the path would stat the
+  // mount itself and hang if it is wedged, which is exactly when this
+  // tool is needed.
+  if(!mountpoint.empty())
+    {
+      std::error_code ec;
+      std::filesystem::path p;
+
+      p = std::filesystem::absolute(mountpoint,ec);
+      if(!ec)
+        mountpoint = p.lexically_normal().string();
+      while((mountpoint.size() > 1) && (mountpoint.back() == '/'))
+        mountpoint.pop_back();
+    }
+
+  {
+    std::error_code ec;
+    std::filesystem::directory_iterator iter(MERGERFS_STATS_SHM_DIR,ec);
+
+    for(const auto &de : iter)
+      {
+        if(de.path().filename().string().rfind(MERGERFS_STATS_SHM_PREFIX,0) != 0)
+          continue;
+        paths.emplace_back(de.path().string());
+      }
+  }
+
+  std::sort(paths.begin(),paths.end());
+
+  shown = 0;
+  for(const auto &path : paths)
+    {
+      if(shown)
+        fmt::print("\n");
+      rv = ::_show(path,pid,mountpoint);
+      if(rv == -EAGAIN)
+        fmt::print(stderr,"{}: segment busy, try again\n",path);
+      if(rv >= 0)
+        shown++;
+    }
+
+  if(shown == 0)
+    {
+      fmt::print(stderr,
+                 "mergerfs.stats: no mergerfs instances found publishing"
+                 " stats. Enable with -o stats.shm=true\n");
+      return 1;
+    }
+
+  return 0;
+}
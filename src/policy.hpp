@@ -19,9 +19,13 @@
 #pragma once
 
 #include "branches.hpp"
+#include "branchptrvec.hpp"
 #include "strvec.hpp"
 #include "fs_path.hpp"
 
+#include "fuse_slowlog.hpp"
+#include "fuse_usdt.hpp"
+
 #include <string>
 #include <memory>
 #include <vector>
@@ -29,6 +33,29 @@
 
 namespace Policy
 {
+  // Runs the policy and reports its decision to the slow request log
+  // and the policy_decision probe.
+  template<typename ImplT>
+  inline
+  int
+  _traced(const ImplT         &impl_,
+          const Branches::Ptr &branches_,
+          const fs::path      &fusepath_,
+          BranchPtrVec        &output_)
+  {
+    int rv;
+    u64 start;
+    const char *branch;
+
+    start  = fuse_slowlog_start();
+    rv     = impl_(branches_,fusepath_,output_);
+    branch = (output_.empty() ? NULL : output_[0]->path.c_str());
+    fuse_slowlog_policy(impl_.name.c_str(),branch,rv,start);
+    FUSE_USDT3(policy_decision,impl_.name.c_str(),branch,rv);
+
+    return rv;
+  }
+
   class ActionImpl
   {
   public:
@@ -41,7 +68,7 @@ namespace Policy
     std::string name;
     virtual int operator()(const Branches::Ptr&,
                            const fs::path&,
-                           std::vector<Branch*>&) const = 0;
+                           BranchPtrVec&) const = 0;
   };
 
   class Action
@@ -66,11 +93,11 @@ namespace Policy
     }
 
     int
-    operator()(const Branches::Ptr  &branches_,
-               const fs::path       &fusepath_,
-               std::vector<Branch*> &output_) const
+    operator()(const Branches::Ptr &branches_,
+               const fs::path      &fusepath_,
+               BranchPtrVec        &output_) const
     {
-      return (*impl)(branches_,fusepath_,output_);
+      return Policy::_traced(*impl,branches_,fusepath_,output_);
     }
 
     operator bool() const
@@ -95,7 +122,7 @@ namespace Policy
     virtual bool path_preserving(void) const = 0;
     virtual int operator()(const Branches::Ptr&,
                            const fs::path&,
-                           std::vector<Branch*>&) const = 0;
+                           BranchPtrVec&) const = 0;
   };
 
   class Create
@@ -126,11 +153,11 @@ namespace Policy
     }
 
     int
-    operator()(const Branches::Ptr  &branches_,
-               const fs::path       &fusepath_,
-               std::vector<Branch*> &output_) const
+    operator()(const Branches::Ptr &branches_,
+               const fs::path      &fusepath_,
+               BranchPtrVec        &output_) const
     {
-      return (*impl)(branches_,fusepath_,output_);
+      return Policy::_traced(*impl,branches_,fusepath_,output_);
     }
 
     operator bool() const
@@ -154,7 +181,7 @@ namespace Policy
     std::string name;
     virtual int operator()(const Branches::Ptr&,
                            const fs::path&,
-                           std::vector<Branch*>&) const = 0;
+                           BranchPtrVec&) const = 0;
   };
 
   class Search
@@ -179,11 +206,11 @@ namespace Policy
     }
 
     int
-    operator()(const Branches::Ptr  &branches_,
-               const fs::path       &fusepath_,
-               std::vector<Branch*> &output_) const
+    operator()(const Branches::Ptr &branches_,
+               const fs::path      &fusepath_,
+               BranchPtrVec        &output_) const
     {
-      return (*impl)(branches_,fusepath_,output_);
+      return Policy::_traced(*impl,branches_,fusepath_,output_);
     }
 
     operator bool() const
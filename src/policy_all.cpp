@@ -31,8 +31,8 @@
 
 static
 int
-_create(const Branches::Ptr  &ibranches_,
-        std::vector<Branch*> &obranches_)
+_create(const Branches::Ptr &ibranches_,
+        BranchPtrVec        &obranches_)
 {
   int rv;
   int error;
@@ -61,25 +61,25 @@ _create(const Branches::Ptr  &ibranches_,
 }
 
 int
-Policy::All::Action::operator()(const Branches::Ptr  &ibranches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &obranches_) const
+Policy::All::Action::operator()(const Branches::Ptr &ibranches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &obranches_) const
 {
   return Policies::Action::epall(ibranches_,fusepath_,obranches_);
 }
 
 int
-Policy::All::Create::operator()(const Branches::Ptr  &ibranches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &obranches_) const
+Policy::All::Create::operator()(const Branches::Ptr &ibranches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &obranches_) const
 {
   return ::_create(ibranches_,obranches_);
 }
 
 int
-Policy::All::Search::operator()(const Branches::Ptr  &ibranches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &obranches_) const
+Policy::All::Search::operator()(const Branches::Ptr &ibranches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &obranches_) const
 {
   return Policies::Search::epall(ibranches_,fusepath_,obranches_);
 }
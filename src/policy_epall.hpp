@@ -35,7 +35,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
 
     class Create final : public Policy::CreateImpl
@@ -49,7 +49,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
       bool path_preserving(void) const final { return true; }
     };
 
@@ -64,7 +64,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
   }
 }
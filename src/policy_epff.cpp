@@ -34,9 +34,9 @@ using std::vector;
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -47,7 +47,7 @@ _create(const Branches::Ptr  &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -67,9 +67,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -80,7 +80,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::statvfs_cache_readonly(branch.path,&readonly);
       if(rv < 0)
@@ -98,13 +98,13 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
 
       paths_.emplace_back(&branch);
@@ -116,25 +116,25 @@ _search(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPFF::Action::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::EPFF::Action::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPFF::Create::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::EPFF::Create::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPFF::Search::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::EPFF::Search::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
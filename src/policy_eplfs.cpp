@@ -35,9 +35,9 @@ using std::vector;
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -52,7 +52,7 @@ _create(const Branches::Ptr  &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -78,9 +78,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -95,7 +95,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -119,9 +119,9 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   u64 eplfs;
@@ -132,7 +132,7 @@ _search(const Branches::Ptr  &branches_,
   eplfs = std::numeric_limits<u64>::max();
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
       rv = fs::statvfs_cache_spaceavail(branch.path,&spaceavail);
       if(rv < 0)
@@ -153,9 +153,9 @@ _search(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPLFS::Action::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::EPLFS::Action::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
@@ -163,7 +163,7 @@ Policy::EPLFS::Action::operator()(const Branches::Ptr  &branches_,
 int
 Policy::EPLFS::Create::operator()(const Branches::Ptr &branches_,
                                   const fs::path      &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+                                  BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
@@ -171,7 +171,7 @@ Policy::EPLFS::Create::operator()(const Branches::Ptr &branches_,
 int
 Policy::EPLFS::Search::operator()(const Branches::Ptr &branches_,
                                   const fs::path      &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+                                  BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
@@ -31,9 +31,9 @@
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -48,7 +48,7 @@ _create(const Branches::Ptr  &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -74,9 +74,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -91,7 +91,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -115,9 +115,9 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   u64 eplus;
@@ -128,7 +128,7 @@ _search(const Branches::Ptr  &branches_,
   eplus = std::numeric_limits<u64>::max();
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
       rv = fs::statvfs_cache_spaceused(branch.path,&spaceused);
       if(rv < 0)
@@ -151,7 +151,7 @@ _search(const Branches::Ptr  &branches_,
 int
 Policy::EPLUS::Action::operator()(const Branches::Ptr &branches_,
                                   const fs::path      &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+                                  BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
@@ -159,7 +159,7 @@ Policy::EPLUS::Action::operator()(const Branches::Ptr &branches_,
 int
 Policy::EPLUS::Create::operator()(const Branches::Ptr &branches_,
                                   const fs::path      &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+                                  BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
@@ -167,7 +167,7 @@ Policy::EPLUS::Create::operator()(const Branches::Ptr &branches_,
 int
 Policy::EPLUS::Search::operator()(const Branches::Ptr &branches_,
                                   const fs::path      &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+                                  BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
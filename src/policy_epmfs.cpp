@@ -33,9 +33,9 @@
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -50,7 +50,7 @@ _create(const Branches::Ptr  &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -76,9 +76,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -93,7 +93,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -117,9 +117,9 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   u64 epmfs;
@@ -130,7 +130,7 @@ _search(const Branches::Ptr  &branches_,
   epmfs = 0;
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
       rv = fs::statvfs_cache_spaceavail(branch.path,&spaceavail);
       if(rv < 0)
@@ -151,25 +151,25 @@ _search(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPMFS::Action::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::EPMFS::Action::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPMFS::Create::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::EPMFS::Create::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPMFS::Search::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::EPMFS::Search::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
@@ -56,7 +56,7 @@ _get_branchinfo_create(const Branches::Ptr &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -91,7 +91,7 @@ _get_branchinfo_action(const Branches::Ptr &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -120,7 +120,7 @@ _get_branchinfo_search(const Branches::Ptr &branches_,
   *sum_ = 0;
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
       rv = fs::statvfs_cache_spaceavail(branch.path,&spaceavail);
       if(rv < 0)
@@ -165,9 +165,9 @@ _get_branch(const BranchInfoVec &branchinfo_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int err;
   u64 sum;
@@ -186,9 +186,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int err;
   u64 sum;
@@ -207,9 +207,9 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int err;
   u64 sum;
@@ -227,25 +227,25 @@ _search(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPPFRD::Action::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPPFRD::Action::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPPFRD::Create::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPPFRD::Create::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::EPPFRD::Search::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPPFRD::Search::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
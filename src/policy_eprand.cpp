@@ -26,9 +26,9 @@
 
 
 int
-Policy::EPRand::Action::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPRand::Action::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 
 {
   int rv;
@@ -41,9 +41,9 @@ Policy::EPRand::Action::operator()(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPRand::Create::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPRand::Create::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   int rv;
 
@@ -55,9 +55,9 @@ Policy::EPRand::Create::operator()(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::EPRand::Search::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::EPRand::Search::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   int rv;
 
@@ -25,25 +25,25 @@
 
 
 int
-Policy::ERoFS::Action::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::ERoFS::Action::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return -EROFS;
 }
 
 int
-Policy::ERoFS::Create::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::ERoFS::Create::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return -EROFS;
 }
 
 int
-Policy::ERoFS::Search::operator()(const Branches::Ptr  &branches_,
-                                  const fs::path       &fusepath_,
-                                  std::vector<Branch*> &paths_) const
+Policy::ERoFS::Search::operator()(const Branches::Ptr &branches_,
+                                  const fs::path      &fusepath_,
+                                  BranchPtrVec        &paths_) const
 {
   return -EROFS;
 }
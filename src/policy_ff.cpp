@@ -31,8 +31,8 @@
 
 static
 int
-_create(const Branches::Ptr  &ibranches_,
-        std::vector<Branch*> &obranches_)
+_create(const Branches::Ptr &ibranches_,
+        BranchPtrVec        &obranches_)
 {
   int rv;
   int error;
@@ -60,29 +60,29 @@ _create(const Branches::Ptr  &ibranches_,
 }
 
 int
-Policy::FF::Action::operator()(const Branches::Ptr  &branches_,
-                               const fs::path       &fusepath_,
-                               std::vector<Branch*> &paths_) const
+Policy::FF::Action::operator()(const Branches::Ptr &branches_,
+                               const fs::path      &fusepath_,
+                               BranchPtrVec        &paths_) const
 {
   return Policies::Action::epff(branches_,fusepath_,paths_);
 }
 
 int
-Policy::FF::Create::operator()(const Branches::Ptr  &branches_,
-                               const fs::path       &fusepath_,
-                               std::vector<Branch*> &paths_) const
+Policy::FF::Create::operator()(const Branches::Ptr &branches_,
+                               const fs::path      &fusepath_,
+                               BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,paths_);
 }
 
 int
-Policy::FF::Search::operator()(const Branches::Ptr  &branches_,
-                               const fs::path       &fusepath_,
-                               std::vector<Branch*> &output_) const
+Policy::FF::Search::operator()(const Branches::Ptr &branches_,
+                               const fs::path      &fusepath_,
+                               BranchPtrVec        &output_) const
 {
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
 
       output_.emplace_back(&branch);
@@ -34,7 +34,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
 
     class Create final : public Policy::CreateImpl
@@ -48,7 +48,7 @@ namespace Policy
       bool path_preserving(void) const final { return false; }
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
 
     };
 
@@ -62,7 +62,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
   }
 }
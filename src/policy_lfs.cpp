@@ -33,8 +33,8 @@
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -72,25 +72,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::LFS::Action::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LFS::Action::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Action::eplfs(branches_,fusepath_,paths_);
 }
 
 int
-Policy::LFS::Create::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LFS::Create::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,paths_);
 }
 
 int
-Policy::LFS::Search::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LFS::Search::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Search::eplfs(branches_,fusepath_,paths_);
 }
@@ -34,9 +34,9 @@
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -54,7 +54,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -99,8 +99,8 @@ _action(const Branches::Ptr  &branches_,
 static
 int
 _search(const Branches::Ptr &branches_,
-        const fs::path &fusepath_,
-        std::vector<Branch *> &paths_)
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   u64 used;
@@ -115,7 +115,7 @@ _search(const Branches::Ptr &branches_,
 
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         continue;
       rv = fs::statvfs_cache_spaceused(branch.path,&used);
       if(rv < 0)
@@ -159,8 +159,8 @@ _search(const Branches::Ptr &branches_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -221,25 +221,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::LUP::Action::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUP::Action::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
 
 int
-Policy::LUP::Create::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUP::Create::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,paths_);
 }
 
 int
-Policy::LUP::Search::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUP::Search::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
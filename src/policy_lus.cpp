@@ -36,8 +36,8 @@ using std::vector;
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -75,25 +75,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::LUS::Action::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUS::Action::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Action::eplus(branches_,fusepath_,paths_);
 }
 
 int
-Policy::LUS::Create::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUS::Create::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,paths_);
 }
 
 int
-Policy::LUS::Search::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::LUS::Search::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Search::eplus(branches_,fusepath_,paths_);
 }
@@ -31,8 +31,8 @@
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int error;
@@ -70,25 +70,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::MFS::Action::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::MFS::Action::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Action::epmfs(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MFS::Create::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::MFS::Create::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,paths_);
 }
 
 int
-Policy::MFS::Search::operator()(const Branches::Ptr  &branches_,
-                                const fs::path       &fusepath_,
-                                std::vector<Branch*> &paths_) const
+Policy::MFS::Search::operator()(const Branches::Ptr &branches_,
+                                const fs::path      &fusepath_,
+                                BranchPtrVec        &paths_) const
 {
   return Policies::Search::epmfs(branches_,fusepath_,paths_);
 }
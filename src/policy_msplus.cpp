@@ -47,7 +47,7 @@ _create_1(const Branches::Ptr &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(*err_,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(*err_,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -68,9 +68,9 @@ _create_1(const Branches::Ptr &branches_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int err;
   Branch *branch;
@@ -97,25 +97,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::MSPLUS::Action::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPLUS::Action::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return Policies::Action::eplus(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPLUS::Create::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPLUS::Create::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPLUS::Search::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPLUS::Search::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return Policies::Search::eplus(branches_,fusepath_,paths_);
 }
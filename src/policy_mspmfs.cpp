@@ -50,7 +50,7 @@ _create_1(const Branches::Ptr &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(*err_,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(*err_,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -71,9 +71,9 @@ _create_1(const Branches::Ptr &branches_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int error;
   Branch *branch;
@@ -101,25 +101,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::MSPMFS::Action::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPMFS::Action::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return Policies::Action::epmfs(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPMFS::Create::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPMFS::Create::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPMFS::Search::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::MSPMFS::Search::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return Policies::Search::epmfs(branches_,fusepath_,paths_);
 }
@@ -34,7 +34,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
 
     class Create final : public Policy::CreateImpl
@@ -47,7 +47,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
       bool path_preserving() const final { return true; }
     };
 
@@ -61,7 +61,7 @@ namespace Policy
     public:
       int operator()(const Branches::Ptr&,
                      const fs::path&,
-                     std::vector<Branch*>&) const final;
+                     BranchPtrVec&) const final;
     };
   }
 }
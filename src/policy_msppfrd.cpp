@@ -57,7 +57,7 @@ _create_1(const Branches::Ptr &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(error,EROFS);
-      if(!fs::exists(branch.path,fusepath_))
+      if(!fs::exists(branch,fusepath_))
         error_and_continue(error,ENOENT);
       rv = fs::info(branch.path,&info);
       if(rv < 0)
@@ -127,9 +127,9 @@ _get_branch(const BranchInfoVec &branchinfo_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   u64 sum;
@@ -147,25 +147,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::MSPPFRD::Action::operator()(const Branches::Ptr  &branches_,
-                                    const fs::path       &fusepath_,
-                                    std::vector<Branch*> &paths_) const
+Policy::MSPPFRD::Action::operator()(const Branches::Ptr &branches_,
+                                    const fs::path      &fusepath_,
+                                    BranchPtrVec        &paths_) const
 {
   return Policies::Action::eppfrd(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPPFRD::Create::operator()(const Branches::Ptr  &branches_,
-                                    const fs::path       &fusepath_,
-                                    std::vector<Branch*> &paths_) const
+Policy::MSPPFRD::Create::operator()(const Branches::Ptr &branches_,
+                                    const fs::path      &fusepath_,
+                                    BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::MSPPFRD::Search::operator()(const Branches::Ptr  &branches_,
-                                    const fs::path       &fusepath_,
-                                    std::vector<Branch*> &paths_) const
+Policy::MSPPFRD::Search::operator()(const Branches::Ptr &branches_,
+                                    const fs::path      &fusepath_,
+                                    BranchPtrVec        &paths_) const
 {
   return Policies::Search::eppfrd(branches_,fusepath_,paths_);
 }
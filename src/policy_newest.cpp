@@ -33,9 +33,9 @@
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int err;
@@ -51,7 +51,7 @@ _create(const Branches::Ptr  &branches_,
     {
       if(branch.ro_or_nc())
         error_and_continue(err,EROFS);
-      if(!fs::exists(branch.path,fusepath_,&st))
+      if(!fs::exists(branch,fusepath_,&st))
         error_and_continue(err,ENOENT);
       if(st.st_mtime < newest)
         continue;
@@ -77,9 +77,9 @@ _create(const Branches::Ptr  &branches_,
 
 static
 int
-_action(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_action(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int rv;
   int err;
@@ -95,7 +95,7 @@ _action(const Branches::Ptr  &branches_,
     {
       if(branch.ro())
         error_and_continue(err,EROFS);
-      if(!fs::exists(branch.path,fusepath_,&st))
+      if(!fs::exists(branch,fusepath_,&st))
         error_and_continue(err,ENOENT);
       if(st.st_mtime < newest)
         continue;
@@ -119,9 +119,9 @@ _action(const Branches::Ptr  &branches_,
 
 static
 int
-_search(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_search(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   time_t newest;
   struct stat st;
@@ -131,7 +131,7 @@ _search(const Branches::Ptr  &branches_,
   newest = std::numeric_limits<time_t>::min();
   for(auto &branch : *branches_)
     {
-      if(!fs::exists(branch.path,fusepath_,&st))
+      if(!fs::exists(branch,fusepath_,&st))
         continue;
       if(st.st_mtime < newest)
         continue;
@@ -149,25 +149,25 @@ _search(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::Newest::Action::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::Newest::Action::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_action(branches_,fusepath_,paths_);
 }
 
 int
-Policy::Newest::Create::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::Newest::Create::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::Newest::Search::operator()(const Branches::Ptr  &branches_,
-                                   const fs::path       &fusepath_,
-                                   std::vector<Branch*> &paths_) const
+Policy::Newest::Search::operator()(const Branches::Ptr &branches_,
+                                   const fs::path      &fusepath_,
+                                   BranchPtrVec        &paths_) const
 {
   return ::_search(branches_,fusepath_,paths_);
 }
@@ -100,9 +100,9 @@ _get_branch(const BranchInfoVec &branchinfo_,
 
 static
 int
-_create(const Branches::Ptr  &branches_,
-        const fs::path       &fusepath_,
-        std::vector<Branch*> &paths_)
+_create(const Branches::Ptr &branches_,
+        const fs::path      &fusepath_,
+        BranchPtrVec        &paths_)
 {
   int err;
   u64 sum;
@@ -120,25 +120,25 @@ _create(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::PFRD::Action::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::PFRD::Action::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return Policies::Action::eppfrd(branches_,fusepath_,paths_);
 }
 
 int
-Policy::PFRD::Create::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::PFRD::Create::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return ::_create(branches_,fusepath_,paths_);
 }
 
 int
-Policy::PFRD::Search::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::PFRD::Search::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   return Policies::Search::eppfrd(branches_,fusepath_,paths_);
 }
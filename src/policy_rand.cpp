@@ -24,9 +24,9 @@
 #include "rnd.hpp"
 
 int
-Policy::Rand::Action::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::Rand::Action::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   int rv;
 
@@ -38,9 +38,9 @@ Policy::Rand::Action::operator()(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::Rand::Create::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::Rand::Create::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   int rv;
 
@@ -52,9 +52,9 @@ Policy::Rand::Create::operator()(const Branches::Ptr  &branches_,
 }
 
 int
-Policy::Rand::Search::operator()(const Branches::Ptr  &branches_,
-                                 const fs::path       &fusepath_,
-                                 std::vector<Branch*> &paths_) const
+Policy::Rand::Search::operator()(const Branches::Ptr &branches_,
+                                 const fs::path      &fusepath_,
+                                 BranchPtrVec        &paths_) const
 {
   int rv;
 
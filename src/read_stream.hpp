@@ -0,0 +1,114 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <sys/types.h>
+
+
+// Tracks the read pattern of an open file to decide when and how far
+// to prefetch into the branch's page cache. Reads which continue
+// where the last one ended (or land within the current window, as
+// happens with concurrent async reads) grow the window, anything else
+// collapses it. State is a handful of relaxed atomics: the worst a
+// race can do is issue a redundant or skipped hint.
+class ReadStream
+{
+public:
+  static constexpr u64 MIN_WINDOW = (128 * 1024);
+
+public:
+  // Returns the number of bytes past `offset_ + size_` which should
+  // be prefetched and sets `start_` to where to begin. 0 means
+  // nothing to do.
+  u64
+  advance(const off_t  offset_,
+          const u64    size_,
+          const u64    max_window_,
+          off_t       *start_)
+  {
+    u64 window;
+    off_t end;
+    off_t next;
+    off_t ahead;
+
+    end    = (offset_ + size_);
+    next   = _next.exchange(end,std::memory_order_relaxed);
+    window = _window.load(std::memory_order_relaxed);
+
+    if(!_sequential(offset_,next,window))
+      {
+        _window.store(0,std::memory_order_relaxed);
+        _ahead.store(0,std::memory_order_relaxed);
+        return 0;
+      }
+
+    if(window == 0)
+      window = std::max(MIN_WINDOW,size_ * 2);
+    else
+      window = (window * 2);
+    if(window > max_window_)
+      window = max_window_;
+    _window.store(window,std::memory_order_relaxed);
+
+    // Only issue a new hint once the reader has consumed half of the
+    // previous one so steady streams cost one fadvise per half window.
+    ahead = _ahead.load(std::memory_order_relaxed);
+    if((ahead - end) > (off_t)(window / 2))
+      return 0;
+    if(ahead < end)
+      ahead = end;
+
+    *start_ = ahead;
+    _ahead.store(end + window,std::memory_order_relaxed);
+
+    return ((end + window) - ahead);
+  }
+
+  u64
+  window() const
+  {
+    return _window.load(std::memory_order_relaxed);
+  }
+
+private:
+  static
+  bool
+  _sequential(const off_t offset_,
+              const off_t next_,
+              const u64   window_)
+  {
+    if(offset_ == next_)
+      return (next_ != 0);
+    if(window_ == 0)
+      return false;
+
+    return ((offset_ >= (next_ - (off_t)window_)) &&
+            (offset_ <= (next_ + (off_t)window_)));
+  }
+
+private:
+  std::atomic<off_t> _next{0};
+  std::atomic<u64>   _window{0};
+  std::atomic<off_t> _ahead{0};
+};
@@ -0,0 +1,44 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <utility>
+
+
+// Background queue for the slow tail of release: dropping the page
+// cache of a file and closing its branch fd, which can block on
+// network filesystems or while dirty pages are written back. The
+// queue is bounded; when it is full the caller does the work itself
+// which limits how far reaping can fall behind.
+namespace ReleaseReaper
+{
+  ThreadPool& pool();
+
+  template<typename FuncType>
+  void
+  run(FuncType &&func_)
+  {
+    if(pool().try_enqueue_work(func_))
+      return;
+
+    func_();
+  }
+}
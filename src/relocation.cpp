@@ -0,0 +1,607 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "relocation.hpp"
+
+#include "errno.hpp"
+#include "fileinfo.hpp"
+#include "fs_clonepath.hpp"
+#include "fs_close.hpp"
+#include "fs_copyfile.hpp"
+#include "fs_dup.hpp"
+#include "fs_dup2.hpp"
+#include "fs_fallocate.hpp"
+#include "fs_fdatasync.hpp"
+#include "fs_file_size.hpp"
+#include "fs_fstat.hpp"
+#include "fs_fsync.hpp"
+#include "fs_ftruncate.hpp"
+#include "fs_getfl.hpp"
+#include "fs_has_space.hpp"
+#include "fs_mktemp.hpp"
+#include "fs_open.hpp"
+#include "fs_pread.hpp"
+#include "fs_pwriten.hpp"
+#include "fs_rename.hpp"
+#include "fs_unlink.hpp"
+#include "kernel_notify.hpp"
+#include "syslog.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+
+
+#define RELOCATION_CHUNK_SIZE (1024 * 1024)
+
+
+static
+int
+_cleanup_flags(const int flags_)
+{
+  int rv;
+
+  rv = flags_;
+  rv = (rv & ~O_TRUNC);
+  rv = (rv & ~O_CREAT);
+  rv = (rv & ~O_EXCL);
+
+  return rv;
+}
+
+Relocation::Relocation(FileInfo       *fi_,
+                       const int       srcfd_,
+                       const int       dstfd_,
+                       const fs::path &src_filepath_,
+                       const fs::path &dst_filepath_,
+                       const fs::path &dst_tmppath_,
+                       const u64       size_)
+  : _fi(fi_),
+    _srcfd(srcfd_),
+    _dstfd(dstfd_),
+    _src_filepath(src_filepath_),
+    _dst_filepath(dst_filepath_),
+    _dst_tmppath(dst_tmppath_),
+    _size(size_),
+    _copied(0),
+    _err(0),
+    _state(State::COPYING)
+{
+}
+
+Relocation::~Relocation()
+{
+  if(_thread.joinable())
+    _thread.join();
+  if(_srcfd >= 0)
+    fs::close(_srcfd);
+  if(_dstfd >= 0)
+    fs::close(_dstfd);
+}
+
+// Called with FileInfo::mutex held exclusively by the writer which
+// hit ENOSPC. Returns 0 once writes can be redirected through
+// fi_->relocation.
+int
+Relocation::start(const Policy::Create &policy_,
+                  const Branches::Ptr  &branches_,
+                  FileInfo             *fi_)
+{
+  int rv;
+  int srcfd;
+  int dstfd;
+  s64 size;
+  fs::path dst_tmppath;
+  fs::path dst_filepath;
+  BranchPtrVec dst_branch;
+  Relocation *r;
+
+  if(fi_->relocation.load(std::memory_order_acquire))
+    return 0;
+
+  rv = policy_(branches_,fi_->fusepath,dst_branch);
+  if(rv < 0)
+    return rv;
+  if(dst_branch.empty())
+    return -ENOSPC;
+
+  size = fs::file_size(fi_->fd);
+  if(size < 0)
+    return size;
+
+  if(fs::has_space(dst_branch[0]->path,size) == false)
+    return -ENOSPC;
+
+  rv = fs::clonepath(fi_->branch.path,
+                     dst_branch[0]->path,
+                     fi_->fusepath.parent_path());
+  if(rv < 0)
+    return -ENOSPC;
+
+  dst_filepath = dst_branch[0]->path / fi_->fusepath;
+  std::tie(dstfd,dst_tmppath) = fs::mktemp(dst_filepath,O_RDWR);
+  if(dstfd < 0)
+    return -ENOSPC;
+
+  rv = fs::ftruncate(dstfd,size);
+  if(rv < 0)
+    {
+      fs::close(dstfd);
+      fs::unlink(dst_tmppath);
+      return -ENOSPC;
+    }
+
+  srcfd = fs::dup(fi_->fd);
+  if(srcfd < 0)
+    {
+      fs::close(dstfd);
+      fs::unlink(dst_tmppath);
+      return srcfd;
+    }
+
+  r = new Relocation(fi_,
+                     srcfd,
+                     dstfd,
+                     fi_->branch.path / fi_->fusepath,
+                     dst_filepath,
+                     dst_tmppath,
+                     size);
+  fi_->relocation.store(r,std::memory_order_release);
+  r->_thread = std::thread(&Relocation::_run,r);
+
+  return 0;
+}
+
+// Must only be called once nothing else can use the FileInfo, ie
+// from release, and before its fd is closed as the final step of a
+// relocation still in progress dup2's over it.
+void
+Relocation::finish(FileInfo *fi_)
+{
+  Relocation *r;
+
+  r = fi_->relocation.exchange(nullptr,std::memory_order_acq_rel);
+
+  delete r;
+}
+
+void
+Relocation::_run()
+{
+  int rv;
+  std::vector<char> buf(RELOCATION_CHUNK_SIZE);
+
+  pthread_setname_np(pthread_self(),"fs.relocate");
+
+  while(true)
+    {
+      std::lock_guard<std::mutex> lk(_mutex);
+
+      if(_copied >= _size)
+        break;
+
+      rv = _copy_chunk(buf.data(),buf.size());
+      if(rv < 0)
+        return _fail(rv);
+    }
+
+  rv = _finalize();
+  if(rv < 0)
+    {
+      std::lock_guard<std::mutex> lk(_mutex);
+      _fail(rv);
+    }
+}
+
+// Copies [_copied,_copied+bufsize_) skipping ranges written since the
+// relocation began. Called with _mutex held.
+int
+Relocation::_copy_chunk(char      *buf_,
+                        const u64  bufsize_)
+{
+  int err;
+  s64 rv;
+  off_t pos;
+  off_t end;
+  off_t wend;
+  off_t piece_end;
+
+  pos = _copied;
+  end = std::min(_size,_copied + bufsize_);
+  while(pos < end)
+    {
+      if(_written_at(pos,&wend))
+        {
+          pos = std::min(end,wend);
+          continue;
+        }
+
+      piece_end = end;
+      auto it = _written.upper_bound(pos);
+      if(it != _written.end())
+        piece_end = std::min(piece_end,it->first);
+
+      rv = fs::pread(_srcfd,buf_,piece_end - pos,pos);
+      if(rv < 0)
+        return rv;
+      if(rv == 0)
+        break;
+
+      fs::pwriten(_dstfd,buf_,rv,pos,&err);
+      if(err < 0)
+        return err;
+
+      pos += rv;
+    }
+
+  _copied = end;
+
+  return 0;
+}
+
+int
+Relocation::_finalize()
+{
+  int rv;
+  int fd;
+  int flags;
+  struct stat st;
+  std::unique_lock<std::shared_mutex> flk(_fi->mutex);
+  std::lock_guard<std::mutex> lk(_mutex);
+
+  rv = fs::fstat(_srcfd,&st);
+  if(rv < 0)
+    return rv;
+
+  rv = fs::copymeta(_srcfd,st,_dstfd);
+  if(rv < 0)
+    return rv;
+
+  flags = fs::getfl(_fi->fd);
+  if(flags < 0)
+    return flags;
+
+  rv = fs::rename(_dst_tmppath,_dst_filepath);
+  if(rv < 0)
+    return rv;
+
+  // The temp file was opened O_RDWR for the copy. The fd handed back
+  // to the FileInfo must carry the original's access mode and status
+  // flags (O_APPEND, O_SYNC, O_DIRECT, ...) as with the synchronous
+  // moveonenospc.
+  fd = fs::open(_dst_filepath,::_cleanup_flags(flags));
+  if(fd < 0)
+    {
+      fs::rename(_dst_filepath,_dst_tmppath);
+      return fd;
+    }
+
+  rv = fs::dup2(fd,_fi->fd);
+  fs::close(fd);
+  if(rv < 0)
+    {
+      fs::rename(_dst_filepath,_dst_tmppath);
+      return rv;
+    }
+
+  KernelNotify::expire(_fi->fusepath);
+
+  fs::unlink(_src_filepath);
+  fs::close(_srcfd);
+  fs::close(_dstfd);
+  _srcfd = -1;
+  _dstfd = -1;
+  _state = State::DONE;
+
+  return 0;
+}
+
+// Called with _mutex held. Acknowledged writes since the switch
+// only exist in the temp file so they are copied back to the source
+// after which the FileInfo's fd is used as if nothing happened. If
+// that fails too the temp file is the only copy of them and is left
+// in place for recovery with further IO failing.
+void
+Relocation::_fail(const int err_)
+{
+  int rv;
+
+  _err   = err_;
+  _state = State::FAILED;
+
+  rv = _revert();
+  if(rv < 0)
+    {
+      SysLog::error("moveonenospc.async: relocating {} failed: {};"
+                    " writing back to the source failed: {};"
+                    " data written since is in {}",
+                    _src_filepath.string(),
+                    -err_,
+                    -rv,
+                    _dst_tmppath.string());
+      return;
+    }
+
+  SysLog::error("moveonenospc.async: relocating {} to {} failed: {}",
+                _src_filepath.string(),
+                _dst_filepath.string(),
+                -err_);
+
+  fs::close(_dstfd);
+  fs::unlink(_dst_tmppath);
+  _dstfd = -1;
+  _state = State::REVERTED;
+}
+
+// Copies the ranges written since the switch from the destination
+// to the source and matches the source's size to the destination.
+int
+Relocation::_revert()
+{
+  int err;
+  s64 rv;
+  off_t pos;
+  off_t end;
+  struct stat st;
+  std::vector<char> buf(RELOCATION_CHUNK_SIZE);
+
+  rv = fs::fstat(_dstfd,&st);
+  if(rv < 0)
+    return rv;
+
+  for(const auto &[start,wend] : _written)
+    {
+      pos = start;
+      end = std::min(wend,st.st_size);
+      while(pos < end)
+        {
+          rv = fs::pread(_dstfd,buf.data(),std::min((off_t)buf.size(),end - pos),pos);
+          if(rv < 0)
+            return rv;
+          if(rv == 0)
+            break;
+
+          fs::pwriten(_srcfd,buf.data(),rv,pos,&err);
+          if(err < 0)
+            return err;
+
+          pos += rv;
+        }
+    }
+
+  return fs::ftruncate(_srcfd,st.st_size);
+}
+
+// Once finished or reverted all IO goes to the FileInfo's fd.
+bool
+Relocation::_fallthrough() const
+{
+  return ((_state == State::DONE) || (_state == State::REVERTED));
+}
+
+void
+Relocation::_add_written(off_t start_,
+                         off_t end_)
+{
+  auto it = _written.upper_bound(start_);
+  if((it != _written.begin()) && (std::prev(it)->second >= start_))
+    {
+      --it;
+      start_ = std::min(start_,it->first);
+      end_   = std::max(end_,it->second);
+      it     = _written.erase(it);
+    }
+
+  while((it != _written.end()) && (it->first <= end_))
+    {
+      end_ = std::max(end_,it->second);
+      it   = _written.erase(it);
+    }
+
+  _written[start_] = end_;
+}
+
+bool
+Relocation::_written_at(const off_t  pos_,
+                        off_t       *end_) const
+{
+  auto it = _written.upper_bound(pos_);
+  if(it == _written.begin())
+    return false;
+
+  --it;
+  if(it->second <= pos_)
+    return false;
+
+  *end_ = it->second;
+
+  return true;
+}
+
+s64
+Relocation::pread(void      *buf_,
+                  const u64  count_,
+                  const s64  offset_)
+{
+  s64 rv;
+  int fd;
+  u64 total;
+  off_t len;
+  off_t pos;
+  off_t end;
+  off_t wend;
+  off_t piece_end;
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_fallthrough())
+    {
+      lk.unlock();
+      return fs::pread(_fi->fd,buf_,count_,offset_);
+    }
+  if(_state == State::FAILED)
+    return _err;
+
+  total = 0;
+  pos   = offset_;
+  end   = (offset_ + count_);
+  while(pos < end)
+    {
+      if((pos < (off_t)_copied) || (pos >= (off_t)_size))
+        {
+          fd = _dstfd;
+          piece_end = (pos < (off_t)_copied) ? std::min(end,(off_t)_copied) : end;
+        }
+      else if(_written_at(pos,&wend))
+        {
+          fd = _dstfd;
+          piece_end = std::min(end,wend);
+        }
+      else
+        {
+          fd = _srcfd;
+          piece_end = std::min(end,(off_t)_size);
+          auto it = _written.upper_bound(pos);
+          if(it != _written.end())
+            piece_end = std::min(piece_end,it->first);
+        }
+
+      len = (piece_end - pos);
+      rv  = fs::pread(fd,(char*)buf_ + total,len,pos);
+      if(rv < 0)
+        return (total ? (s64)total : rv);
+
+      total += rv;
+      pos   += rv;
+      if(rv < len)
+        break;
+    }
+
+  return total;
+}
+
+s64
+Relocation::pwrite(const void *buf_,
+                   const u64   count_,
+                   const s64   offset_)
+{
+  int err;
+  s64 rv;
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_fallthrough())
+    {
+      lk.unlock();
+      rv = fs::pwriten(_fi->fd,buf_,count_,offset_,&err);
+      return ((err < 0) ? err : rv);
+    }
+  if(_state == State::FAILED)
+    return _err;
+
+  rv = fs::pwriten(_dstfd,buf_,count_,offset_,&err);
+  if(rv > 0)
+    _add_written(offset_,offset_ + rv);
+  if(err < 0)
+    return err;
+
+  return rv;
+}
+
+int
+Relocation::fstat(struct stat *st_)
+{
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_fallthrough())
+    {
+      lk.unlock();
+      return fs::fstat(_fi->fd,st_);
+    }
+  if(_state == State::FAILED)
+    return _err;
+
+  return fs::fstat(_dstfd,st_);
+}
+
+int
+Relocation::fsync(const bool datasync_)
+{
+  int fd;
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_state == State::FAILED)
+    return _err;
+
+  fd = (_fallthrough() ? _fi->fd : _dstfd);
+
+  return (datasync_ ? fs::fdatasync(fd) : fs::fsync(fd));
+}
+
+int
+Relocation::ftruncate(const off_t size_)
+{
+  int rv;
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_fallthrough())
+    {
+      lk.unlock();
+      return fs::ftruncate(_fi->fd,size_);
+    }
+  if(_state == State::FAILED)
+    return _err;
+
+  rv = fs::ftruncate(_dstfd,size_);
+  if(rv < 0)
+    return rv;
+
+  // Anything past the new size is gone, anything after the old size
+  // is zeros in the destination: either way nothing more to copy.
+  if((u64)size_ < _size)
+    _size = size_;
+
+  return 0;
+}
+
+int
+Relocation::fallocate(const int   mode_,
+                      const off_t offset_,
+                      const off_t len_)
+{
+  int rv;
+  std::unique_lock<std::mutex> lk(_mutex);
+
+  if(_fallthrough())
+    {
+      lk.unlock();
+      return fs::fallocate(_fi->fd,mode_,offset_,len_);
+    }
+  if(_state == State::FAILED)
+    return _err;
+
+  rv = fs::fallocate(_dstfd,mode_,offset_,len_);
+  if(rv < 0)
+    return rv;
+
+  _add_written(offset_,offset_ + len_);
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "branches.hpp"
+#include "fs_path.hpp"
+#include "policy.hpp"
+
+#include "base_types.h"
+
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+
+class FileInfo;
+
+// Background relocation of an open file for moveonenospc.async.
+//
+// On ENOSPC a temp file is created on the branch chosen by the
+// moveonenospc policy and sized to match the source. From then on all
+// writes go to the new file while a thread copies the existing data
+// across in chunks. Ranges written (or fallocated) since the switch
+// are tracked so the copy doesn't overwrite them and so reads are
+// served from whichever file holds the current data. Once everything
+// is copied the metadata is cloned, the temp file renamed into place,
+// reopened with the original fd's flags, dup2'ed over the FileInfo's
+// fd and the source unlinked. Should it
+// fail the ranges written since the switch are written back to the
+// source and the temp file removed.
+//
+// Lock order is FileInfo::mutex then Relocation::_mutex. The object
+// lives until the FileInfo is released (see finish()) so callers can
+// keep using it after the relocation completes, at which point the
+// calls fall through to the FileInfo's fd.
+class Relocation
+{
+public:
+  static int  start(const Policy::Create &policy,
+                    const Branches::Ptr  &branches,
+                    FileInfo             *fi);
+  static void finish(FileInfo *fi);
+
+public:
+  ~Relocation();
+
+public:
+  s64 pread(void *buf, const u64 count, const s64 offset);
+  s64 pwrite(const void *buf, const u64 count, const s64 offset);
+  int fstat(struct stat *st);
+  int fsync(const bool datasync);
+  int ftruncate(const off_t size);
+  int fallocate(const int mode, const off_t offset, const off_t len);
+
+private:
+  enum class State
+    {
+      COPYING,
+      DONE,
+      REVERTED,
+      FAILED
+    };
+
+private:
+  Relocation(FileInfo       *fi,
+             const int       srcfd,
+             const int       dstfd,
+             const fs::path &src_filepath,
+             const fs::path &dst_filepath,
+             const fs::path &dst_tmppath,
+             const u64       size);
+
+private:
+  void _run();
+  int  _copy_chunk(char *buf, const u64 bufsize);
+  int  _finalize();
+  void _fail(const int err);
+  int  _revert();
+  bool _fallthrough() const;
+  void _add_written(off_t start, off_t end);
+  bool _written_at(const off_t pos, off_t *end) const;
+
+private:
+  FileInfo *_fi;
+  int       _srcfd;
+  int       _dstfd;
+  fs::path  _src_filepath;
+  fs::path  _dst_filepath;
+  fs::path  _dst_tmppath;
+  u64       _size;
+  u64       _copied;
+  int       _err;
+  State     _state;
+  // start -> end of ranges written since the switch. Above `_copied`
+  // these are where the current data is in the destination rather
+  // than the source.
+  std::map<off_t,off_t> _written;
+  mutable std::mutex    _mutex;
+  std::thread           _thread;
+};
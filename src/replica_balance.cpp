@@ -0,0 +1,157 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "replica_balance.hpp"
+
+#include "fs_exists.hpp"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+
+typedef std::unordered_map<dev_t,std::unique_ptr<ReplicaBalance::DevLoad>> DevLoadMap;
+
+// Entries are never removed so the pointers held by Refs stay valid.
+// The number of devices is bounded by the branches ever configured.
+static std::shared_mutex g_devloads_mutex;
+static DevLoadMap        g_devloads;
+
+
+static
+ReplicaBalance::DevLoad*
+_devload(const dev_t dev_)
+{
+  {
+    std::shared_lock<std::shared_mutex> lk(g_devloads_mutex);
+
+    auto it = g_devloads.find(dev_);
+    if(it != g_devloads.end())
+      return it->second.get();
+  }
+
+  std::unique_lock<std::shared_mutex> lk(g_devloads_mutex);
+
+  auto &ptr = g_devloads[dev_];
+  if(!ptr)
+    ptr = std::make_unique<ReplicaBalance::DevLoad>();
+
+  return ptr.get();
+}
+
+static
+bool
+_same_file(const struct stat &a_,
+           const struct stat &b_)
+{
+  return (S_ISREG(b_.st_mode) &&
+          (a_.st_size == b_.st_size) &&
+          (a_.st_mtim.tv_sec == b_.st_mtim.tv_sec) &&
+          (a_.st_mtim.tv_nsec == b_.st_mtim.tv_nsec));
+}
+
+static
+std::tuple<s64,s64>
+_load(const dev_t dev_)
+{
+  ReplicaBalance::DevLoad *load;
+
+  load = ::_devload(dev_);
+
+  return {load->inflight.load(std::memory_order_relaxed),
+          load->opens.load(std::memory_order_relaxed)};
+}
+
+ReplicaBalance::Ref::~Ref()
+{
+  if(_load)
+    _load->opens.fetch_sub(1,std::memory_order_relaxed);
+}
+
+void
+ReplicaBalance::Ref::acquire(const dev_t dev_)
+{
+  if(_load)
+    _load->opens.fetch_sub(1,std::memory_order_relaxed);
+
+  _load = ::_devload(dev_);
+  _load->opens.fetch_add(1,std::memory_order_relaxed);
+}
+
+// Returns the replica of `fusepath_` on the least loaded device,
+// preferring reads in flight then open handles, with `primary_` (the
+// search policy's choice) winning ties. Returns nullptr if `primary_`
+// can't be stat'ed or isn't a regular file.
+const Branch*
+ReplicaBalance::select(const Branches::Ptr &branches_,
+                       const fs::path      &fusepath_,
+                       const Branch        *primary_,
+                       dev_t               *dev_)
+{
+  struct stat st;
+  struct stat pst;
+  const Branch *best;
+  std::tuple<s64,s64> load;
+  std::tuple<s64,s64> bestload;
+
+  if(!fs::exists(*primary_,fusepath_,&pst))
+    return nullptr;
+  if(!S_ISREG(pst.st_mode))
+    return nullptr;
+
+  best     = primary_;
+  *dev_    = pst.st_dev;
+  bestload = ::_load(pst.st_dev);
+  for(const auto &branch : *branches_)
+    {
+      if(&branch == primary_)
+        continue;
+      if(!fs::exists(branch,fusepath_,&st))
+        continue;
+      if(!::_same_file(pst,st))
+        continue;
+      if(st.st_dev == pst.st_dev)
+        continue;
+
+      load = ::_load(st.st_dev);
+      if(load >= bestload)
+        continue;
+
+      best     = &branch;
+      bestload = load;
+      *dev_    = st.st_dev;
+    }
+
+  return best;
+}
+
+s64
+ReplicaBalance::inflight(const dev_t dev_)
+{
+  return std::get<0>(::_load(dev_));
+}
+
+s64
+ReplicaBalance::opens(const dev_t dev_)
+{
+  return std::get<1>(::_load(dev_));
+}
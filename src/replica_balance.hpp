@@ -0,0 +1,81 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include "branches.hpp"
+#include "fs_path.hpp"
+
+#include "base_types.h"
+
+#include <atomic>
+
+#include <sys/types.h>
+
+
+// When enabled read-only opens of a file which exists identically
+// (same size and mtime) on several branches are spread across those
+// replicas. Load is tracked per device as the number of reads in
+// flight and the number of handles open through balancing.
+namespace ReplicaBalance
+{
+  struct DevLoad
+  {
+    std::atomic<s64> inflight{0};
+    std::atomic<s64> opens{0};
+  };
+
+  // Owned by a FileInfo. Holds an open count against the device
+  // until destroyed.
+  class Ref
+  {
+  public:
+    Ref() = default;
+    Ref(const Ref&) = delete;
+    Ref& operator=(const Ref&) = delete;
+    ~Ref();
+
+  public:
+    void acquire(const dev_t);
+
+    void
+    read_begin()
+    {
+      if(_load)
+        _load->inflight.fetch_add(1,std::memory_order_relaxed);
+    }
+
+    void
+    read_end()
+    {
+      if(_load)
+        _load->inflight.fetch_sub(1,std::memory_order_relaxed);
+    }
+
+  private:
+    DevLoad *_load = nullptr;
+  };
+
+  const Branch *select(const Branches::Ptr &branches,
+                       const fs::path      &fusepath,
+                       const Branch        *primary,
+                       dev_t               *dev);
+
+  s64 inflight(const dev_t);
+  s64 opens(const dev_t);
+}
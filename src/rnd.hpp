@@ -33,10 +33,10 @@ public:
   static u64 rand64(cu64 min_,
                     cu64 max_);
 
-  template<typename T>
+  template<typename V>
   static
   void
-  shrink_to_rand_elem(std::vector<T> &v_)
+  shrink_to_rand_elem(V &v_)
   {
     if(v_.size() <= 1)
       return;
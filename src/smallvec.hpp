@@ -0,0 +1,173 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+
+// A vector with inline storage for the first N elements. Only used for
+// small trivially copyable values (pointers) so growth is a memcpy and
+// nothing needs destructing. Once spilled to the heap the buffer is
+// kept until destruction so a reused instance doesn't reallocate.
+template<typename T, std::size_t N>
+class SmallVec
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  typedef T           value_type;
+  typedef T*          iterator;
+  typedef const T*    const_iterator;
+  typedef std::size_t size_type;
+
+public:
+  SmallVec()
+    : _data(_inline),
+      _size(0),
+      _cap(N)
+  {
+  }
+
+  SmallVec(const SmallVec &other_)
+    : SmallVec()
+  {
+    assign(other_.begin(),other_.end());
+  }
+
+  SmallVec&
+  operator=(const SmallVec &other_)
+  {
+    if(this != &other_)
+      assign(other_.begin(),other_.end());
+    return *this;
+  }
+
+  ~SmallVec()
+  {
+    if(_data != _inline)
+      delete[] _data;
+  }
+
+public:
+  void
+  push_back(const T &val_)
+  {
+    if(_size == _cap)
+      _grow(_cap * 2);
+    _data[_size++] = val_;
+  }
+
+  template<typename... Args>
+  T&
+  emplace_back(Args&&... args_)
+  {
+    if(_size == _cap)
+      _grow(_cap * 2);
+    _data[_size] = T(std::forward<Args>(args_)...);
+    return _data[_size++];
+  }
+
+  void
+  pop_back()
+  {
+    _size--;
+  }
+
+  void
+  assign(const T *begin_,
+         const T *end_)
+  {
+    size_type n = (end_ - begin_);
+
+    if(n > _cap)
+      _grow(n);
+    std::copy(begin_,end_,_data);
+    _size = n;
+  }
+
+  void
+  resize(const size_type n_)
+  {
+    if(n_ > _cap)
+      _grow(n_);
+    if(n_ > _size)
+      std::fill(_data + _size,_data + n_,T());
+    _size = n_;
+  }
+
+  void
+  reserve(const size_type n_)
+  {
+    if(n_ > _cap)
+      _grow(n_);
+  }
+
+  void
+  clear()
+  {
+    _size = 0;
+  }
+
+public:
+  bool      empty() const { return (_size == 0); }
+  size_type size() const { return _size; }
+  size_type capacity() const { return _cap; }
+
+  T*       data() { return _data; }
+  const T* data() const { return _data; }
+
+  iterator       begin() { return _data; }
+  iterator       end() { return _data + _size; }
+  const_iterator begin() const { return _data; }
+  const_iterator end() const { return _data + _size; }
+
+  T&       front() { return _data[0]; }
+  const T& front() const { return _data[0]; }
+  T&       back() { return _data[_size - 1]; }
+  const T& back() const { return _data[_size - 1]; }
+
+  T&       operator[](const size_type i_) { return _data[i_]; }
+  const T& operator[](const size_type i_) const { return _data[i_]; }
+
+private:
+  void
+  _grow(const size_type cap_)
+  {
+    T *data;
+
+    data = new T[cap_];
+    if(_size)
+      memcpy(data,_data,_size * sizeof(T));
+    if(_data != _inline)
+      delete[] _data;
+
+    _data = data;
+    _cap  = cap_;
+  }
+
+private:
+  T         *_data;
+  size_type  _size;
+  size_type  _cap;
+  T          _inline[N];
+};
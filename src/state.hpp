@@ -99,7 +99,8 @@ public:
              FileInfo * const fi_)
       : ref_count(1),
         backing_id(backing_id_),
-        fi(fi_)
+        fi(fi_),
+        wc_fi(nullptr)
     {
     }
 
@@ -110,13 +111,18 @@ public:
     OpenFile(OpenFile &&o_) noexcept
       : ref_count(o_.ref_count.load(std::memory_order_relaxed)),
         backing_id(o_.backing_id),
-        fi(o_.fi)
+        fi(o_.fi),
+        wc_fi(o_.wc_fi)
     {
     }
 
     std::atomic<int> ref_count;
     int backing_id;
     FileInfo *fi;
+    // The handle which last buffered writes with write-coalesce.
+    // Coalescing only happens while it is the sole open handle so
+    // this is the only one which may hold unwritten data.
+    FileInfo *wc_fi;
   };
 
 public:
@@ -0,0 +1,236 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "stats_shm.hpp"
+
+#include "config.hpp"
+#include "stats_snapshot.hpp"
+#include "syslog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+#define STATS_SHM_INTERVAL_MS 1000
+#define STATS_SHM_READ_TRIES  1000
+
+static std::mutex              g_enable_mutex;
+static std::mutex              g_mutex;
+static std::condition_variable g_cv;
+static std::thread             g_thread;
+static bool                    g_stop = false;
+
+
+std::string
+StatsShm::path(const pid_t pid_)
+{
+  return (MERGERFS_STATS_SHM_DIR "/" MERGERFS_STATS_SHM_PREFIX +
+          std::to_string(pid_));
+}
+
+static
+void
+_publish(mergerfs_stats_shm_t *shm_,
+         const char           *buf_,
+         cu32                  size_)
+{
+  u64 seq;
+
+  seq = shm_->seq.load(std::memory_order_relaxed);
+  shm_->seq.store(seq + 1,std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(shm_->data,buf_,size_);
+  shm_->size = size_;
+
+  shm_->seq.store(seq + 2,std::memory_order_release);
+}
+
+int
+StatsShm::read(const mergerfs_stats_shm_t *shm_,
+               char                       *buf_,
+               cu32                        bufsize_)
+{
+  u32 size;
+  u64 seq0;
+  u64 seq1;
+
+  for(int i = 0; i < STATS_SHM_READ_TRIES; i++)
+    {
+      seq0 = shm_->seq.load(std::memory_order_acquire);
+      if(seq0 & 1)
+        {
+          ::sched_yield();
+          continue;
+        }
+
+      size = std::min(shm_->size,bufsize_);
+      std::memcpy(buf_,shm_->data,size);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      seq1 = shm_->seq.load(std::memory_order_relaxed);
+      if(seq0 == seq1)
+        return size;
+    }
+
+  return -EAGAIN;
+}
+
+static
+mergerfs_stats_shm_t*
+_create(const std::string &path_)
+{
+  int fd;
+  void *mem;
+  mergerfs_stats_shm_t *shm;
+
+  // The path is predictable so never reuse or follow whatever is
+  // already there. A stale file from a previous instance with the
+  // same pid is removed first.
+  ::unlink(path_.c_str());
+  fd = ::open(path_.c_str(),O_RDWR|O_CREAT|O_EXCL|O_NOFOLLOW|O_CLOEXEC,0644);
+  if(fd < 0)
+    return NULL;
+
+  if(::ftruncate(fd,sizeof(mergerfs_stats_shm_t)) < 0)
+    {
+      ::close(fd);
+      ::unlink(path_.c_str());
+      return NULL;
+    }
+
+  mem = ::mmap(NULL,
+               sizeof(mergerfs_stats_shm_t),
+               PROT_READ|PROT_WRITE,
+               MAP_SHARED,
+               fd,
+               0);
+  ::close(fd);
+  if(mem == MAP_FAILED)
+    {
+      ::unlink(path_.c_str());
+      return NULL;
+    }
+
+  shm = new (mem) mergerfs_stats_shm_t{};
+  shm->magic       = MERGERFS_STATS_SHM_MAGIC;
+  shm->version     = MERGERFS_STATS_SHM_VERSION;
+  shm->pid         = ::getpid();
+  shm->interval_ms = STATS_SHM_INTERVAL_MS;
+  std::strncpy(shm->mountpoint,
+               cfg.mountpoint.c_str(),
+               sizeof(shm->mountpoint) - 1);
+
+  return shm;
+}
+
+static
+void
+_run(mergerfs_stats_shm_t *shm_)
+{
+  u32 size;
+  std::unique_ptr<char[]> buf(new char[sizeof(shm_->data)]);
+  std::unique_lock<std::mutex> lk(g_mutex);
+
+  while(!g_stop)
+    {
+      lk.unlock();
+      size = StatsSnapshot::fill(buf.get(),sizeof(shm_->data),0);
+      ::_publish(shm_,buf.get(),size);
+      lk.lock();
+
+      g_cv.wait_for(lk,
+                    std::chrono::milliseconds(STATS_SHM_INTERVAL_MS),
+                    []{ return g_stop; });
+    }
+}
+
+static
+void
+_start()
+{
+  std::string path;
+  mergerfs_stats_shm_t *shm;
+
+  path = StatsShm::path(::getpid());
+  shm  = ::_create(path);
+  if(shm == NULL)
+    {
+      SysLog::warning("stats.shm: unable to create {} - {}",
+                      path,
+                      strerror(errno));
+      return;
+    }
+
+  g_stop   = false;
+  g_thread = std::thread([shm]()
+  {
+    ::_run(shm);
+    ::munmap(shm,sizeof(mergerfs_stats_shm_t));
+  });
+}
+
+static
+void
+_stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    g_stop = true;
+  }
+  g_cv.notify_all();
+
+  g_thread.join();
+  ::unlink(StatsShm::path(::getpid()).c_str());
+}
+
+static
+void
+_atexit()
+{
+  StatsShm::enable(false);
+}
+
+void
+StatsShm::enable(const bool enabled_)
+{
+  static const bool registered = (std::atexit(::_atexit) == 0);
+  std::lock_guard<std::mutex> lk(g_enable_mutex);
+
+  (void)registered;
+
+  if(enabled_ == g_thread.joinable())
+    return;
+
+  if(enabled_)
+    ::_start();
+  else
+    ::_stop();
+}
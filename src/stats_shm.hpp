@@ -0,0 +1,75 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  SHARED MEMORY STATS
+  ===================
+
+  With `stats.shm` enabled a background thread writes the same
+  snapshot returned by MERGERFS_IOCTL_STATS to
+  /dev/shm/mergerfs.<pid> once a second. Readers map the file and
+  never enter the filesystem so stats remain available when the mount
+  is wedged by a hung branch. `mergerfs.stats` is such a reader.
+
+  The segment is protected by a seqlock: the writer makes `seq` odd,
+  copies in the snapshot, and makes it even again. A reader copies
+  the data out and retries if `seq` was odd or changed meanwhile.
+  Since the snapshot is built before the write starts the window a
+  reader can collide with is a single memcpy.
+*/
+
+#pragma once
+
+#include "base_types.h"
+
+#include "mergerfs_ioctl.hpp"
+
+#include <atomic>
+#include <string>
+
+
+#define MERGERFS_STATS_SHM_MAGIC   0x4D48534DU /* "MSHM" */
+#define MERGERFS_STATS_SHM_VERSION 2
+#define MERGERFS_STATS_SHM_DIR     "/dev/shm"
+#define MERGERFS_STATS_SHM_PREFIX  "mergerfs."
+// Unlike the ioctl the segment isn't paged so it is sized to hold
+// every branch of any reasonably sized pool.
+#define MERGERFS_STATS_SHM_DATA_SIZE (256 * 1024)
+
+struct mergerfs_stats_shm_t
+{
+  u32              magic;
+  u32              version;
+  u32              pid;
+  u32              interval_ms;
+  char             mountpoint[256];
+  std::atomic<u64> seq;
+  u32              size;
+  char             data[MERGERFS_STATS_SHM_DATA_SIZE];
+};
+
+namespace StatsShm
+{
+  void enable(const bool enabled);
+
+  std::string path(const pid_t pid);
+
+  int read(const mergerfs_stats_shm_t *shm,
+           char                       *buf,
+           cu32                        bufsize);
+}
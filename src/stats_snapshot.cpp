@@ -0,0 +1,197 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "stats_snapshot.hpp"
+
+#include "attr_cache.hpp"
+#include "branch_health.hpp"
+#include "branch_stats.hpp"
+#include "config.hpp"
+#include "fanout.hpp"
+#include "fd_cache.hpp"
+#include "mergerfs_ioctl.hpp"
+
+#include "fuse_stats.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <limits.h>
+
+static_assert(MERGERFS_STATS_HIST_BUCKETS == FUSE_STATS_HIST_BUCKETS);
+static_assert(MERGERFS_STATS_BRANCH_OPS == BranchStats::MAX_OP);
+static_assert(MERGERFS_STATS_BRANCH_OP_READ == BranchStats::READ);
+static_assert(MERGERFS_STATS_BRANCH_OP_WRITE == BranchStats::WRITE);
+static_assert(MERGERFS_STATS_BRANCH_OP_OPEN == BranchStats::OPEN);
+static_assert(MERGERFS_STATS_BRANCH_OP_SYNC == BranchStats::SYNC);
+
+
+static
+void
+_fill_hdr(mergerfs_stats_hdr_t *hdr_)
+{
+  fuse_pool_stats_t pools;
+  AttrCache::Stats attrcache;
+  FdCache::Stats fdcache;
+
+  fuse_stats_pools_get(&pools);
+  attrcache = AttrCache::stats();
+  fdcache   = FdCache::stats();
+
+  hdr_->magic            = MERGERFS_STATS_MAGIC;
+  hdr_->version          = MERGERFS_STATS_VERSION;
+  hdr_->hdr_size         = sizeof(mergerfs_stats_hdr_t);
+  hdr_->time_ns          = fuse_stats_now_ns();
+  hdr_->op_size          = sizeof(mergerfs_stats_op_t);
+  hdr_->branch_size      = sizeof(mergerfs_stats_branch_t);
+  hdr_->msgbuf_bufsize   = pools.msgbuf_bufsize;
+  hdr_->msgbuf_allocated = pools.msgbuf_allocated;
+  hdr_->nodes            = pools.nodes;
+  hdr_->node_table_size  = pools.node_table_size;
+  hdr_->read_threads     = pools.read_threads;
+  hdr_->process_threads  = pools.process_threads;
+  hdr_->fanout_threads   = Fanout::threads();
+
+  hdr_->attr_cache_hits    = attrcache.hits;
+  hdr_->attr_cache_misses  = attrcache.misses;
+  hdr_->attr_cache_size    = attrcache.size;
+  hdr_->fd_cache_hits      = fdcache.hits;
+  hdr_->fd_cache_misses    = fdcache.misses;
+  hdr_->fd_cache_evictions = fdcache.evictions;
+  hdr_->fd_cache_size      = fdcache.size;
+}
+
+static
+void
+_fill_branch(const Branch            &branch_,
+             mergerfs_stats_branch_t *rec_)
+{
+  BranchHealth::Health health;
+  BranchStats::Snapshot io;
+  const std::string &path = branch_.path.native();
+
+  health = BranchHealth::get(path);
+  BranchStats::snapshot(path,&io);
+
+  rec_->mode             = (u32)branch_.mode;
+  rec_->probe_err        = health.probe_err;
+  rec_->minfreespace     = branch_.minfreespace();
+  rec_->spaceavail       = health.spaceavail;
+  rec_->spaceused        = health.spaceused;
+  rec_->probe_start_ns   = health.probe_start_ns;
+  rec_->probe_done_ns    = health.probe_done_ns;
+  rec_->probe_latency_ns = health.probe_latency_ns;
+  rec_->path_len         = path.size();
+  std::copy(std::begin(io.ops),std::end(io.ops),rec_->ops);
+  std::copy(std::begin(io.errors),std::end(io.errors),rec_->errors);
+  std::copy(std::begin(io.total_ns),std::end(io.total_ns),rec_->total_ns);
+  rec_->read_bytes  = io.read_bytes;
+  rec_->write_bytes = io.write_bytes;
+  std::copy(std::begin(io.hist),std::end(io.hist),rec_->hist);
+}
+
+// Records are assembled on the stack and copied in since the output
+// buffer is packed and not necessarily aligned. Nothing here touches
+// the branches: space figures are from the last completed probe and a
+// new round of probes is kicked off for next time.
+u32
+StatsSnapshot::fill(char *buf_,
+                    cu32  bufsize_,
+                    cu32  branch_offset_)
+{
+  u32 offset;
+  u32 ops_end;
+  Branches::Ptr branches;
+  mergerfs_stats_hdr_t hdr = {};
+
+  if(bufsize_ < sizeof(hdr))
+    return 0;
+
+  ::_fill_hdr(&hdr);
+
+  // Ops only go in the first page and leave room for a branch with
+  // the longest possible path so paging always makes progress.
+  ops_end = bufsize_;
+  if(bufsize_ > (sizeof(hdr) + sizeof(mergerfs_stats_branch_t) + PATH_MAX))
+    ops_end -= (sizeof(mergerfs_stats_branch_t) + PATH_MAX);
+
+  offset = sizeof(hdr);
+  for(u32 opcode = 0; (branch_offset_ == 0) && (opcode < FUSE_STATS_MAX_OPCODE); opcode++)
+    {
+      fuse_op_stats_t st;
+      mergerfs_stats_op_t rec = {};
+
+      fuse_stats_op_get(opcode,&st);
+      if(st.count == 0)
+        continue;
+      if((offset + sizeof(rec)) > ops_end)
+        {
+          hdr.flags |= MERGERFS_STATS_FLAG_TRUNCATED;
+          break;
+        }
+
+      rec.opcode   = opcode;
+      rec.count    = st.count;
+      rec.errors   = st.errors;
+      rec.total_ns = st.total_ns;
+      std::copy(std::begin(st.hist),std::end(st.hist),rec.hist);
+
+      std::memcpy(&buf_[offset],&rec,sizeof(rec));
+      offset += sizeof(rec);
+      hdr.op_count++;
+    }
+
+  branches = cfg.branches;
+  if(branch_offset_ == 0)
+    BranchHealth::probe(branches);
+
+  hdr.branch_offset = branch_offset_;
+  hdr.branch_total  = branches->size();
+  for(u32 i = branch_offset_; i < branches->size(); i++)
+    {
+      u32 avail;
+      const Branch &branch = (*branches)[i];
+      mergerfs_stats_branch_t rec = {};
+
+      ::_fill_branch(branch,&rec);
+
+      // Branches which don't fit are left for the next page. Only a
+      // path too long for an otherwise empty page is cut.
+      avail = ((offset + sizeof(rec)) <= bufsize_) ? (bufsize_ - offset - sizeof(rec)) : 0;
+      if(((offset + sizeof(rec)) > bufsize_) || (rec.path_len > avail))
+        {
+          if(hdr.branch_count)
+            break;
+          hdr.flags |= MERGERFS_STATS_FLAG_TRUNCATED;
+          if((offset + sizeof(rec)) > bufsize_)
+            break;
+          rec.path_len = avail;
+        }
+
+      std::memcpy(&buf_[offset],&rec,sizeof(rec));
+      offset += sizeof(rec);
+      std::memcpy(&buf_[offset],branch.path.c_str(),rec.path_len);
+      offset += rec.path_len;
+      hdr.branch_count++;
+    }
+
+  hdr.size = offset;
+  std::memcpy(buf_,&hdr,sizeof(hdr));
+
+  return offset;
+}
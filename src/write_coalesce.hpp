@@ -0,0 +1,40 @@
+/*
+  ISC License
+
+  Copyright (c) 2026, Antonio SJ Musumeci <trapexit@spawn.link>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <sys/types.h>
+
+
+// Per handle buffer used by write-coalesce to combine small sequential
+// direct_io writes into fewer, larger pwrites. `pending` allows other
+// ops to skip taking the lock when there is nothing to flush.
+struct WriteCoalesce
+{
+  std::mutex        mutex;
+  std::vector<char> buf;
+  off_t             offset = 0;
+  std::atomic<bool> pending{false};
+  // Error from a flush whose data was already acknowledged. Kept
+  // until returned by the next op on the handle which flushes.
+  std::atomic<int>  err{0};
+};
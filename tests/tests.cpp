@@ -1,33 +1,110 @@
 #include "acutest/acutest.h"
 
+#include "attr_cache.hpp"
+#include "branch_stats.hpp"
+#include "branch_watch.hpp"
 #include "config.hpp"
+#include "error.hpp"
+#include "fanout.hpp"
+#include "fd_cache.hpp"
+#include "fs_copydata.hpp"
+#include "fs_copydata_readwrite.hpp"
 #include "fs_copyfile.hpp"
+#include "fs_exists.hpp"
+#include "fs_openat.hpp"
+#include "fs_pathbuf.hpp"
+#include "fs_statvfs_cache.hpp"
+#include "fsck_index.hpp"
+#include "fsck_scan.hpp"
+#include "fs_unlink.hpp"
 #include "fs_inode.hpp"
 #include "from_string.hpp"
+#include "fuse_getattr.hpp"
+#include "fuse_link.hpp"
+#include "fuse_open.hpp"
+#include "fuse_read.hpp"
+#include "fuse_release.hpp"
+#include "fuse_statfs.hpp"
+#include "fuse_unlink.hpp"
+#include "fuse_write.hpp"
+#include "fileinfo.hpp"
 #include "hashset.hpp"
+#include "hot_nodes.hpp"
+#include "kernel_notify.hpp"
+#include "mem_branch.hpp"
+#include "mergerfs_ioctl.hpp"
 #include "num.hpp"
+#include "policies.hpp"
+#include "procfs.hpp"
 #include "rapidhash/rapidhash.h"
+#include "read_stream.hpp"
+#include "relocation.hpp"
+#include "release_reaper.hpp"
+#include "replica_balance.hpp"
 #include "rnd.hpp"
+#include "smallvec.hpp"
+#include "state.hpp"
+#include "stats_shm.hpp"
+#include "stats_snapshot.hpp"
 #include "str.hpp"
 #include "thread_pool.hpp"
 
+#include "fuse_kernel.h"
+#include "fuse_slowlog.hpp"
+#include "fuse_stats.hpp"
+
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fcntl.h>
 #include <fstream>
 #include <future>
 #include <mutex>
+#include <new>
 #include <numeric>
 #include <optional>
 #include <sstream>
 #include <thread>
 
 #include <errno.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+// Counts heap allocations made by the current thread so tests can
+// assert hot paths stay allocation free.
+static thread_local uint64_t g_allocs = 0;
+
+void*
+operator new(std::size_t size_)
+{
+  void *p;
+
+  g_allocs++;
+  p = std::malloc(size_ ? size_ : 1);
+  if(p == nullptr)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+void
+operator delete(void *ptr_) noexcept
+{
+  std::free(ptr_);
+}
+
+void
+operator delete(void        *ptr_,
+                std::size_t  size_) noexcept
+{
+  (void)size_;
+  std::free(ptr_);
+}
+
+
 template<typename Predicate>
 bool
 wait_until(Predicate pred_,
@@ -386,129 +463,1650 @@ test_config_branches()
 // Branch unit tests
 // ---------------------------------------------------------------------------
 
-void
-test_branch_default_ctor_mode()
-{
-  Branch b;
+void
+test_branch_default_ctor_mode()
+{
+  Branch b;
+
+  TEST_CHECK(b.mode == Branch::Mode::RW);
+}
+
+void
+test_branch_to_string_modes()
+{
+  uint64_t global = 0;
+  Branch b(global);
+
+  b.path = "/mnt/disk1";
+
+  b.mode = Branch::Mode::RW;
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW");
+
+  b.mode = Branch::Mode::RO;
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RO");
+
+  b.mode = Branch::Mode::NC;
+  TEST_CHECK(b.to_string() == "/mnt/disk1=NC");
+}
+
+void
+test_branch_to_string_with_minfreespace()
+{
+  uint64_t global = 0;
+  Branch b(global);
+
+  b.path = "/mnt/disk1";
+  b.mode = Branch::Mode::RW;
+
+  // While minfreespace is held by pointer (global default), it is NOT emitted
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW");
+
+  // Once set_minfreespace is called the value is stored locally and IS emitted
+  b.set_minfreespace(1024);
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1K");
+
+  b.set_minfreespace(1024 * 1024);
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1M");
+
+  b.set_minfreespace(1024 * 1024 * 1024);
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1G");
+
+  b.set_minfreespace(500);
+  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,500");
+}
+
+void
+test_branch_mode_predicates()
+{
+  Branch b;
+
+  b.mode = Branch::Mode::RW;
+  TEST_CHECK(b.ro()       == false);
+  TEST_CHECK(b.nc()       == false);
+  TEST_CHECK(b.ro_or_nc() == false);
+
+  b.mode = Branch::Mode::RO;
+  TEST_CHECK(b.ro()       == true);
+  TEST_CHECK(b.nc()       == false);
+  TEST_CHECK(b.ro_or_nc() == true);
+
+  b.mode = Branch::Mode::NC;
+  TEST_CHECK(b.ro()       == false);
+  TEST_CHECK(b.nc()       == true);
+  TEST_CHECK(b.ro_or_nc() == true);
+}
+
+void
+test_branch_minfreespace_pointer_vs_value()
+{
+  uint64_t global = 9999;
+  Branch b(global);
+
+  // Reads through the pointer
+  TEST_CHECK(b.minfreespace() == 9999);
+
+  // Pointer tracks changes to the referenced global
+  global = 1234;
+  TEST_CHECK(b.minfreespace() == 1234);
+
+  // set_minfreespace switches variant to owned u64
+  b.set_minfreespace(42);
+  TEST_CHECK(b.minfreespace() == 42);
+
+  // Global changes no longer affect it
+  global = 9999;
+  TEST_CHECK(b.minfreespace() == 42);
+}
+
+void
+test_branch_copy_constructor()
+{
+  uint64_t global = 100;
+  Branch orig(global);
+  orig.path = "/orig";
+  orig.mode = Branch::Mode::RO;
+
+  Branch copy(orig);
+  TEST_CHECK(copy.path == "/orig");
+  TEST_CHECK(copy.mode == Branch::Mode::RO);
+  TEST_CHECK(copy.minfreespace() == 100);
+}
+
+void
+test_branch_copy_assignment()
+{
+  uint64_t global = 77;
+  Branch a(global);
+  a.path = "/a";
+  a.mode = Branch::Mode::NC;
+  a.set_minfreespace(555);
+
+  Branch b;
+  b = a;
+  TEST_CHECK(b.path == "/a");
+  TEST_CHECK(b.mode == Branch::Mode::NC);
+  TEST_CHECK(b.minfreespace() == 555);
+}
+
+void
+test_branch_fd_relative_ops()
+{
+  int fd;
+  Branch branch;
+  struct stat st;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-branch-fd-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  branch.path = tmp_dir;
+  std::filesystem::create_directory(tmp_dir / "dir");
+  std::ofstream(tmp_dir / "dir" / "file") << "data";
+
+  Branch::fds_enabled(false);
+  TEST_CHECK(branch.fd() == -1);
+  TEST_CHECK(fs::exists(branch,"dir/file"));
+
+  Branch::fds_enabled(true);
+  TEST_CHECK(branch.fd() >= 0);
+  TEST_CHECK(branch.fd() == Branch(branch).fd());
+
+  TEST_CHECK(fs::exists(branch,"",&st));
+  TEST_CHECK(S_ISDIR(st.st_mode));
+  TEST_CHECK(fs::exists(branch,"dir/file",&st));
+  TEST_CHECK(st.st_size == 4);
+  TEST_CHECK(!fs::exists(branch,"dir/nope"));
+
+  fd = fs::openat(branch,"dir/file",O_RDONLY);
+  TEST_CHECK(fd >= 0);
+  if(fd >= 0)
+    ::close(fd);
+
+  TEST_CHECK(fs::unlink(branch,"dir/file") == 0);
+  TEST_CHECK(!fs::exists(branch,"dir/file"));
+
+  Branch::fds_enabled(false);
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_branch_fd_revalidate()
+{
+  int fd;
+  Branch branch;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-branch-fd-reval-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  branch.path = tmp_dir / "branch";
+  std::filesystem::create_directory(branch.path);
+
+  Branch::fds_enabled(true);
+  fd = branch.fd();
+  TEST_CHECK(fd >= 0);
+
+  branch.revalidate_fd();
+  TEST_CHECK(branch.fd() == fd);
+
+  // replace the directory at the branch path
+  std::filesystem::rename(branch.path,tmp_dir / "old");
+  std::filesystem::create_directory(branch.path);
+  std::ofstream(branch.path / "new") << "data";
+
+  TEST_CHECK(!fs::exists(branch,"new"));
+  branch.revalidate_fd();
+  TEST_CHECK(fs::exists(branch,"new"));
+
+  Branch::fds_enabled(false);
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_pathbuf_join()
+{
+  const char *cases[][2] =
+    {
+     {"/mnt/a","foo/bar"},
+     {"/mnt/a/","foo/bar"},
+     {"/mnt/a",""},
+     {"/","foo"},
+     {"","foo"},
+    };
+
+  for(const auto &c : cases)
+    {
+      const fs::PathBuf pb(fs::path(c[0]),c[1]);
+      const fs::path    fp = fs::path(c[0]) / c[1];
+
+      TEST_CHECK(pb.view() == fp.native());
+      TEST_MSG("base=%s rel=%s got=%s expected=%s",
+               c[0],c[1],pb.c_str(),fp.c_str());
+      TEST_CHECK(pb.size() == fp.native().size());
+    }
+}
+
+void
+test_pathbuf_long_path()
+{
+  const std::string base(PATH_MAX,'a');
+  const std::string rel(64,'b');
+  const fs::PathBuf pb(std::string_view{base},std::string_view{rel});
+
+  TEST_CHECK(pb.size() == (base.size() + 1 + rel.size()));
+  TEST_CHECK(pb.view() == (base + "/" + rel));
+  TEST_CHECK(std::strlen(pb.c_str()) == pb.size());
+}
+
+void
+test_pathbuf_no_allocs()
+{
+  bool rv;
+  uint64_t allocs;
+  Branch branch;
+  fs::path tmp_dir;
+  const fs::path fusepath("dir/file");
+  const fs::path missing("dir/nope");
+  char tmp_template[] = "/tmp/mergerfs-test-pathbuf-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  branch.path = tmp_dir;
+  std::filesystem::create_directory(tmp_dir / "dir");
+  std::ofstream(tmp_dir / "dir" / "file") << "data";
+
+  Branch::fds_enabled(false);
+
+  allocs = g_allocs;
+  rv = fs::exists(branch.path,fusepath);
+  TEST_CHECK(rv);
+  rv = fs::exists(branch,fusepath);
+  TEST_CHECK(rv);
+  rv = fs::exists(branch,missing);
+  TEST_CHECK(!rv);
+  TEST_CHECK(g_allocs == allocs);
+  TEST_MSG("allocations: %lu",(unsigned long)(g_allocs - allocs));
+
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_getattr_open_allocs()
+{
+  int rv;
+  uint64_t allocs;
+  uint64_t path_allocs;
+  uint64_t fi_allocs;
+  fs::path tmp_dir;
+  struct stat st;
+  FileInfo *fi;
+  fuse_timeouts_t to;
+  fuse_req_ctx_t ctx = {};
+  fuse_file_info_t ffi = {};
+  const fs::path fusepath("dir/file");
+  char tmp_template[] = "/tmp/mergerfs-test-allocs-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::filesystem::create_directory(tmp_dir / "dir");
+  std::ofstream(tmp_dir / "dir" / "file") << "data";
+  cfg.set("branches",tmp_dir.string());
+
+  // The libfuse entry points take a char* which is turned into an
+  // fs::path once per request. That is the only allocation either
+  // op is allowed beyond the per handle FileInfo.
+  allocs = g_allocs;
+  {
+    const fs::path p("dir/file");
+  }
+  path_allocs = (g_allocs - allocs);
+
+  ctx.opcode = FUSE_GETATTR;
+  FUSE::getattr(&ctx,fusepath,&st,&to);
+
+  allocs = g_allocs;
+  rv = FUSE::getattr(&ctx,fusepath,&st,&to);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(g_allocs == allocs);
+  TEST_MSG("allocations: %lu",(unsigned long)(g_allocs - allocs));
+
+  allocs = g_allocs;
+  rv = FUSE::getattr(&ctx,"dir/file",&st,&to);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK((g_allocs - allocs) == path_allocs);
+  TEST_MSG("allocations: %lu",(unsigned long)(g_allocs - allocs));
+
+  ctx.opcode = FUSE_OPEN;
+  ffi.flags  = O_RDONLY;
+  rv = FUSE::open(&ctx,"dir/file",&ffi);
+  TEST_CHECK(rv == 0);
+
+  fi = FileInfo::from_fh(ffi.fh);
+  allocs = g_allocs;
+  delete new FileInfo(fi);
+  fi_allocs = (g_allocs - allocs);
+  FUSE::release(&ctx,&ffi);
+
+  ffi = {};
+  ffi.flags = O_RDONLY;
+  allocs = g_allocs;
+  rv = FUSE::open(&ctx,"dir/file",&ffi);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK((g_allocs - allocs) == (path_allocs + fi_allocs));
+  TEST_MSG("allocations: %lu expected: %lu",
+           (unsigned long)(g_allocs - allocs),
+           (unsigned long)(path_allocs + fi_allocs));
+  FUSE::release(&ctx,&ffi);
+
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_smallvec_inline_and_spill()
+{
+  int vals[16];
+  uint64_t allocs;
+  SmallVec<int*,4> v;
+
+  allocs = g_allocs;
+  for(int i = 0; i < 4; i++)
+    v.emplace_back(&vals[i]);
+  TEST_CHECK(g_allocs == allocs);
+  TEST_CHECK(v.size() == 4);
+  TEST_CHECK(v.capacity() == 4);
+
+  for(int i = 4; i < 16; i++)
+    v.push_back(&vals[i]);
+  TEST_CHECK(v.size() == 16);
+  TEST_CHECK(v.capacity() >= 16);
+  for(int i = 0; i < 16; i++)
+    TEST_CHECK(v[i] == &vals[i]);
+
+  SmallVec<int*,4> c(v);
+  TEST_CHECK(c.size() == 16);
+  TEST_CHECK(std::equal(c.begin(),c.end(),v.begin()));
+
+  v.resize(1);
+  TEST_CHECK(v.size() == 1);
+  TEST_CHECK(v.front() == &vals[0]);
+  TEST_CHECK(v.back() == &vals[0]);
+
+  allocs = g_allocs;
+  v.clear();
+  for(int i = 0; i < 16; i++)
+    v.push_back(&vals[i]);
+  TEST_CHECK(g_allocs == allocs);
+
+  c = v;
+  v.clear();
+  TEST_CHECK(v.empty());
+  TEST_CHECK(c.size() == 16);
+}
+
+void
+test_statfs_merged_cache()
+{
+  int rv;
+  struct statvfs st;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-statfs-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  TEST_CHECK(cfg.set("branches",tmp_dir.string()) == 0);
+  TEST_CHECK(cfg.set("cache.statfs","60") == 0);
+  fs::statvfs_cache_timeout(cfg.cache_statfs);
+  FUSE::statfs_cache_clear();
+
+  rv = FUSE::statfs(nullptr,"",&st);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(st.f_blocks > 0);
+
+  // With the branch gone the merged result is still served from
+  // cache and a refresh leaves entries younger than the timeout alone.
+  std::filesystem::remove_all(tmp_dir);
+  FUSE::statfs_cache_refresh();
+  rv = FUSE::statfs(nullptr,"",&st);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(st.f_blocks > 0);
+
+  FUSE::statfs_cache_clear();
+  rv = FUSE::statfs(nullptr,"",&st);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(st.f_blocks == 0);
+
+  TEST_CHECK(cfg.set("cache.statfs","0") == 0);
+  fs::statvfs_cache_timeout(cfg.cache_statfs);
+  FUSE::statfs_cache_clear();
+}
+
+void
+test_read_stream_sequential()
+{
+  u64 len;
+  off_t start;
+  ReadStream rs;
+  const u64 req = (128 * 1024);
+  const u64 max = (1024 * 1024);
+
+  // first read gives no signal
+  TEST_CHECK(rs.advance(0,req,max,&start) == 0);
+
+  len = rs.advance(req,req,max,&start);
+  TEST_CHECK(len == (req * 2));
+  TEST_CHECK(start == (off_t)(req * 2));
+
+  for(u64 off = (req * 2); off < (req * 32); off += req)
+    rs.advance(off,req,max,&start);
+  TEST_CHECK(rs.window() == max);
+
+  // out of order read within the window keeps the stream
+  rs.advance((req * 30),req,max,&start);
+  TEST_CHECK(rs.window() == max);
+
+  // random access collapses it
+  TEST_CHECK(rs.advance((req * 1000),req,max,&start) == 0);
+  TEST_CHECK(rs.window() == 0);
+}
+
+void
+test_replica_balance_select()
+{
+  dev_t dev;
+  Branches b;
+  struct stat st;
+  fs::path tmp_dir;
+  const Branch *branch;
+  char tmp_template[] = "/tmp/mergerfs-test-replica-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::filesystem::create_directory(tmp_dir / "a");
+  std::filesystem::create_directory(tmp_dir / "b");
+  std::ofstream(tmp_dir / "a" / "file") << "data";
+  std::ofstream(tmp_dir / "b" / "file") << "data";
+
+  TEST_CHECK(b.from_string((tmp_dir / "a").string() + ":" +
+                           (tmp_dir / "b").string()) == 0);
+  Branches::Ptr p = b;
+
+  TEST_CHECK(ReplicaBalance::select(p,"nope",&(*p)[0],&dev) == nullptr);
+
+  // Replicas on the same device gain nothing so the primary is kept.
+  branch = ReplicaBalance::select(p,"file",&(*p)[0],&dev);
+  TEST_CHECK(branch == &(*p)[0]);
+  TEST_CHECK(::stat((tmp_dir / "a").c_str(),&st) == 0);
+  TEST_CHECK(dev == st.st_dev);
+
+  {
+    ReplicaBalance::Ref ref;
+    s64 opens = ReplicaBalance::opens(dev);
+
+    ref.acquire(dev);
+    TEST_CHECK(ReplicaBalance::opens(dev) == (opens + 1));
+    ref.read_begin();
+    TEST_CHECK(ReplicaBalance::inflight(dev) == 1);
+    ref.read_end();
+    TEST_CHECK(ReplicaBalance::inflight(dev) == 0);
+  }
+  TEST_CHECK(ReplicaBalance::opens(dev) == 0);
+
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_open_writers()
+{
+  int rv;
+  FileInfo *fi;
+  fs::path tmp_dir;
+  fuse_req_ctx_t ctx = {};
+  fuse_file_info_t ro = {};
+  fuse_file_info_t rw = {};
+  char tmp_template[] = "/tmp/mergerfs-test-writers-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::ofstream(tmp_dir / "file") << "data";
+  cfg.set("branches",tmp_dir.string());
+  procfs::init();
+
+  ctx.opcode = FUSE_OPEN;
+  ctx.nodeid = 1000;
+
+  ro.flags = O_RDONLY;
+  rv = FUSE::open(&ctx,"file",&ro);
+  TEST_CHECK(rv == 0);
+  fi = FileInfo::from_fh(ro.fh);
+  TEST_CHECK(fi->writable == 0);
+  TEST_CHECK(fi->writers == 0);
+
+  // The canonical FileInfo counts writers across all handles.
+  rw.flags = O_RDWR;
+  rv = FUSE::open(&ctx,"file",&rw);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(FileInfo::from_fh(rw.fh)->writable == 1);
+  TEST_CHECK(fi->writers == 1);
+
+  FUSE::release(&ctx,&rw);
+  TEST_CHECK(fi->writers == 0);
+  FUSE::release(&ctx,&ro);
+
+  std::filesystem::remove_all(tmp_dir);
+}
+
+// Replicas on different devices: /tmp and /dev/shm. The first open
+// is canonical and must stay on the primary so a later writable open,
+// which duplicates its fd, writes the copy the policies will find.
+// Handles already balanced onto the replica must then read the
+// primary.
+static
+void
+test_open_balanced_then_write()
+{
+  int rv;
+  char buf[16];
+  fs::path primary;
+  fs::path replica;
+  std::string data;
+  FileInfo *fi;
+  fuse_req_ctx_t ctx = {};
+  struct stat st;
+  fuse_file_info_t ro[2] = {};
+  fuse_file_info_t rw = {};
+  ReplicaBalance::Ref load;
+  char tmp_template0[] = "/tmp/mergerfs-test-balance-XXXXXX";
+  char tmp_template1[] = "/dev/shm/mergerfs-test-balance-XXXXXX";
+  const struct timespec times[2] = {{1000,0},{1000,0}};
+
+  if((::mkdtemp(tmp_template0) == nullptr) ||
+     (::mkdtemp(tmp_template1) == nullptr))
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  primary = tmp_template0;
+  replica = tmp_template1;
+  for(const auto &dir : {primary,replica})
+    {
+      std::ofstream(dir / "file") << "old data";
+      ::utimensat(AT_FDCWD,(dir / "file").c_str(),times,0);
+    }
+  cfg.set("branches",primary.string() + ':' + replica.string());
+  cfg.set("replica-balance","true");
+  procfs::init();
+
+  ctx.opcode = FUSE_OPEN;
+  ctx.nodeid = 1001;
+
+  // With the primary's device already loaded the first open would
+  // balance onto the replica if allowed to.
+  TEST_CHECK(::stat(primary.c_str(),&st) == 0);
+  load.acquire(st.st_dev);
+  for(auto &ffi : ro)
+    {
+      ffi.flags = O_RDONLY;
+      rv = FUSE::open(&ctx,"file",&ffi);
+      TEST_CHECK(rv == 0);
+    }
+  TEST_CHECK(FileInfo::from_fh(ro[0].fh)->branch.path == primary);
+  TEST_CHECK(FileInfo::from_fh(ro[0].fh)->canonical == nullptr);
+  fi = FileInfo::from_fh(ro[1].fh);
+  TEST_CHECK(fi->branch.path == replica);
+  TEST_CHECK(fi->canonical == FileInfo::from_fh(ro[0].fh));
+
+  rw.flags = O_RDWR;
+  rv = FUSE::open(&ctx,"file",&rw);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(FileInfo::from_fh(rw.fh)->branch.path == primary);
+  ctx.opcode = FUSE_WRITE;
+  TEST_CHECK(FUSE::write(&ctx,&rw,"new data",8,0) == 8);
+
+  std::ifstream(primary / "file") >> data;
+  TEST_CHECK(data == "new");
+  std::ifstream(replica / "file") >> data;
+  TEST_CHECK(data == "old");
+
+  ctx.opcode = FUSE_READ;
+  rv = FUSE::read(&ctx,&ro[1],buf,8,0);
+  TEST_CHECK(rv == 8);
+  TEST_CHECK(std::string(buf,3) == "new");
+
+  FUSE::release(&ctx,&rw);
+  for(auto &ffi : ro)
+    FUSE::release(&ctx,&ffi);
+
+  cfg.set("replica-balance","false");
+  std::filesystem::remove_all(primary);
+  std::filesystem::remove_all(replica);
+}
+
+void
+test_write_coalesce()
+{
+  int fd;
+  Branch branch;
+  struct stat st;
+  fuse_req_ctx_t ctx = {};
+  fuse_file_info_t ffi = {};
+  char tmp_template[] = "/tmp/mergerfs-test-wc-XXXXXX";
+  const std::string data(100,'x');
+
+  fd = ::mkstemp(tmp_template);
+  TEST_CHECK(fd >= 0);
+  if(fd < 0)
+    return;
+
+  TEST_CHECK(cfg.set("write-coalesce","1") == 0);
+
+  FileInfo fi(fd,branch,"file",true);
+  ffi.fh = fi.to_fh();
+
+  TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,0) == 100);
+  TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,100) == 100);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 0);
+
+  // a gap flushes the buffered run
+  TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,1000) == 100);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 200);
+
+  TEST_CHECK(FUSE::write_coalesce_flush(&fi) == 0);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 1100);
+
+  // filling the buffer writes it out
+  for(int i = 0; i < 11; i++)
+    TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,1100 + (i * 100)) == 100);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 2100);
+  TEST_CHECK(FUSE::write_coalesce_flush(&fi) == 0);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 2200);
+
+  // While it is the sole open handle on the node it coalesces and
+  // path based ops on the node can flush it.
+  ctx.nodeid = 1001;
+  TEST_CHECK(state.open_files.try_emplace(ctx.nodeid,INVALID_BACKING_ID,&fi));
+  TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,2200) == 100);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 2200);
+  FUSE::write_coalesce_flush(ctx.nodeid);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 2300);
+
+  // With other handles open it writes through.
+  state.open_files.visit(ctx.nodeid,
+                         [](auto &v_)
+                         {
+                           v_.second.ref_count.fetch_add(1);
+                         });
+  TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,2300) == 100);
+  TEST_CHECK(::fstat(fd,&st) == 0);
+  TEST_CHECK(st.st_size == 2400);
+  state.open_files.erase(ctx.nodeid);
+  ctx.nodeid = 0;
+
+  // A failed flush of acknowledged data is reported once by the
+  // next op on the handle.
+  {
+    int rofd;
+
+    rofd = ::open(tmp_template,O_RDONLY);
+    FileInfo rofi(rofd,branch,"file",true);
+    ffi.fh = rofi.to_fh();
+
+    TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,0) == 100);
+    TEST_CHECK(FUSE::write_coalesce_flush(&rofi) == -EBADF);
+    TEST_CHECK(FUSE::write_coalesce_flush(&rofi) == 0);
+
+    TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,0) == 100);
+    TEST_CHECK(FUSE::write(&ctx,&ffi,data.data(),100,1000) == -EBADF);
+    TEST_CHECK(FUSE::write_coalesce_flush(&rofi) == 0);
+
+    ::close(rofd);
+  }
+
+  TEST_CHECK(cfg.set("write-coalesce","0") == 0);
+  ::close(fd);
+  ::unlink(tmp_template);
+}
+
+void
+test_relocation()
+{
+  int fd;
+  Branches b;
+  fs::path tmp_dir;
+  Relocation *r;
+  std::string data;
+  std::string buf;
+  std::stringstream ss;
+  char tmp_template[] = "/tmp/mergerfs-test-reloc-XXXXXX";
+  const size_t size = (3 * 1024 * 1024) + 100;
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::filesystem::create_directory(tmp_dir / "a");
+  std::filesystem::create_directory(tmp_dir / "b");
+  for(size_t i = 0; i < size; i++)
+    data += (char)('a' + (i % 26));
+  std::ofstream(tmp_dir / "a" / "file") << data;
+
+  // RO keeps the create policy from choosing the source.
+  TEST_CHECK(b.from_string((tmp_dir / "a").string() + "=RO:" +
+                           (tmp_dir / "b").string()) == 0);
+  Branches::Ptr p = b;
+
+  fd = ::open((tmp_dir / "a" / "file").c_str(),O_RDWR|O_APPEND|O_DSYNC);
+  TEST_CHECK(fd >= 0);
+  if(fd < 0)
+    return;
+
+  FileInfo fi(fd,(*p)[0],"file",true);
+
+  TEST_CHECK(Relocation::start(&Policies::Create::ff,p,&fi) == 0);
+  r = fi.relocation.load();
+  TEST_CHECK(r != nullptr);
+
+  // Writes land in the new file at once and win over the copy.
+  TEST_CHECK(r->pwrite("XYZ",3,(2 * 1024 * 1024) + 5) == 3);
+  TEST_CHECK(r->pwrite("END",3,size) == 3);
+  data.replace((2 * 1024 * 1024) + 5,3,"XYZ");
+  data += "END";
+
+  buf.resize(data.size());
+  TEST_CHECK(r->pread(buf.data(),buf.size(),0) == (s64)buf.size());
+  TEST_CHECK(buf == data);
+
+  Relocation::finish(&fi);
+  TEST_CHECK(fi.relocation.load() == nullptr);
+
+  // The fd now refers to the new file with the original's flags.
+  TEST_CHECK((::fcntl(fd,F_GETFL) & (O_ACCMODE|O_APPEND|O_DSYNC)) ==
+             (O_RDWR|O_APPEND|O_DSYNC));
+  ::close(fd);
+
+  TEST_CHECK(!std::filesystem::exists(tmp_dir / "a" / "file"));
+  ss << std::ifstream(tmp_dir / "b" / "file").rdbuf();
+  TEST_CHECK(ss.str() == data);
+
+  // A directory in the way fails the final rename. Writes made since
+  // the switch are put back in the source and the temp file removed.
+  data.resize(size);
+  std::ofstream(tmp_dir / "a" / "file2") << data;
+  std::filesystem::create_directories(tmp_dir / "b" / "file2" / "x");
+
+  fd = ::open((tmp_dir / "a" / "file2").c_str(),O_RDWR);
+  TEST_CHECK(fd >= 0);
+  if(fd < 0)
+    return;
+
+  {
+    FileInfo fi2(fd,(*p)[0],"file2",true);
+
+    {
+      // Holding the FileInfo's lock keeps the relocation from
+      // finishing until the writes are in.
+      std::shared_lock<std::shared_mutex> lk(fi2.mutex);
+
+      TEST_CHECK(Relocation::start(&Policies::Create::ff,p,&fi2) == 0);
+      r = fi2.relocation.load();
+      TEST_CHECK(r != nullptr);
+      TEST_CHECK(r->pwrite("XYZ",3,5) == 3);
+      TEST_CHECK(r->pwrite("END",3,size) == 3);
+    }
+
+    data.replace(5,3,"XYZ");
+    data += "END";
+
+    Relocation::finish(&fi2);
+  }
+  ::close(fd);
+
+  ss.str("");
+  ss << std::ifstream(tmp_dir / "a" / "file2").rdbuf();
+  TEST_CHECK(ss.str() == data);
+  TEST_CHECK(std::distance(std::filesystem::directory_iterator(tmp_dir / "b"),
+                           std::filesystem::directory_iterator()) == 2);
+
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_fd_cache()
+{
+  int fd;
+  int fd2;
+  Branch branch;
+  std::optional<Branch> out;
+  fs::path tmp_dir;
+  FdCache::Stats s;
+  char tmp_template[] = "/tmp/mergerfs-test-fdcache-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  branch.path = tmp_dir;
+  std::ofstream(tmp_dir / "a") << "a";
+  std::ofstream(tmp_dir / "b") << "b";
+
+  fd = ::open((tmp_dir / "a").c_str(),O_RDONLY);
+  TEST_CHECK(FdCache::put(1,"a",branch,fd) == false);
+
+  FdCache::capacity(1);
+
+  // Only read-only fds are kept.
+  fd2 = ::open((tmp_dir / "b").c_str(),O_RDWR);
+  TEST_CHECK(FdCache::put(2,"b",branch,fd2) == false);
+  ::close(fd2);
+
+  TEST_CHECK(FdCache::put(1,"a",branch,fd) == true);
+  TEST_CHECK(FdCache::take(1,"a",O_RDWR,&out) == -1);
+  TEST_CHECK(FdCache::take(1,"other",O_RDONLY,&out) == -1);
+  TEST_CHECK(FdCache::take(1,"a",O_RDONLY|O_CLOEXEC,&out) == fd);
+  TEST_CHECK(out->path == tmp_dir);
+  TEST_CHECK(FdCache::take(1,"a",O_RDONLY,&out) == -1);
+
+  // Replaced on the branch: fails validation.
+  TEST_CHECK(FdCache::put(1,"a",branch,fd) == true);
+  std::filesystem::remove(tmp_dir / "a");
+  std::ofstream(tmp_dir / "a") << "new";
+  TEST_CHECK(FdCache::take(1,"a",O_RDONLY,&out) == -1);
+
+  // Capacity evicts the least recently used.
+  fd  = ::open((tmp_dir / "a").c_str(),O_RDONLY);
+  fd2 = ::open((tmp_dir / "b").c_str(),O_RDONLY);
+  TEST_CHECK(FdCache::put(1,"a",branch,fd) == true);
+  TEST_CHECK(FdCache::put(2,"b",branch,fd2) == true);
+  s = FdCache::stats();
+  TEST_CHECK(s.size == 1);
+  TEST_CHECK(s.evictions == 1);
+  TEST_CHECK(s.hits == 1);
+
+  FdCache::invalidate("b");
+  TEST_CHECK(FdCache::stats().size == 0);
+
+  FdCache::capacity(0);
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_release_async()
+{
+  int fd;
+  int nodeid;
+  Branch branch;
+  FileInfo *fi;
+  char tmp_template[] = "/tmp/mergerfs-test-release-XXXXXX";
+
+  fd = ::mkstemp(tmp_template);
+  TEST_CHECK(fd >= 0);
+  if(fd < 0)
+    return;
+
+  TEST_CHECK(cfg.set("release.async","close") == 0);
+
+  nodeid = 0x7fff0001;
+  fi = new FileInfo(fd,branch,"file",true);
+  TEST_CHECK(state.open_files.try_emplace(nodeid,INVALID_BACKING_ID,fi));
+
+  FUSE::release(nodeid,fi);
+  TEST_CHECK(state.open_files.contains(nodeid) == false);
+
+  // The close happens on the reaper so wait for it.
+  for(int i = 0; (i < 1000) && (::fcntl(fd,F_GETFD) != -1); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  TEST_CHECK(::fcntl(fd,F_GETFD) == -1);
+
+  // Work is run inline when it can't be queued.
+  {
+    std::atomic<int> n{0};
+
+    for(int i = 0; i < 4096; i++)
+      ReleaseReaper::run([&n](){ n++; });
+    for(int i = 0; (i < 1000) && (n != 4096); i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    TEST_CHECK(n == 4096);
+  }
+
+  TEST_CHECK(cfg.set("release.async","off") == 0);
+  ::unlink(tmp_template);
+}
+
+void
+test_mem_branch()
+{
+  Branches b;
+  std::string path;
+  std::string path2;
+
+  TEST_CHECK(MemBranch::is_mem("@mem"));
+  TEST_CHECK(MemBranch::is_mem("@mem.2"));
+  TEST_CHECK(!MemBranch::is_mem("@memory"));
+  TEST_CHECK(!MemBranch::is_mem("/mnt/@mem"));
+
+  TEST_CHECK(MemBranch::path("@mem.test",&path) == 0);
+  TEST_CHECK(std::filesystem::is_directory(path));
+  TEST_CHECK(MemBranch::path("@mem.test",&path2) == 0);
+  TEST_CHECK(path == path2);
+  TEST_CHECK(MemBranch::path("@mem.test2",&path2) == 0);
+  TEST_CHECK(path != path2);
+
+  TEST_CHECK(b.from_string("@mem.test=NC,1234:@mem.test2") == 0);
+  Branches::Ptr p = b;
+  TEST_CHECK(p->size() == 2);
+  TEST_CHECK((*p)[0].path == path);
+  TEST_CHECK((*p)[0].mode == Branch::Mode::NC);
+  TEST_CHECK((*p)[1].path == path2);
+}
+
+void
+test_fanout()
+{
+  Branches b;
+  BranchPtrVec branches;
+  SmallVec<int,8> seq;
+  SmallVec<int,8> par;
+  auto func = [](const Branch &branch_)
+  {
+    int i = (branch_.path.string().back() - 'a');
+
+    // Later branches finish first.
+    std::this_thread::sleep_for(std::chrono::milliseconds(5 * (5 - i)));
+
+    return ((i % 2) ? -(EROFS + i) : i);
+  };
+
+  TEST_CHECK(b.from_string("/tmp/a:/tmp/b:/tmp/c:/tmp/d:/tmp/e") == 0);
+  Branches::Ptr p = b;
+  for(auto &branch : *p)
+    branches.push_back(&branch);
+
+  seq.resize(branches.size());
+  par.resize(branches.size());
+
+  Fanout::threads(0);
+  Fanout::run(branches,seq.data(),func);
+  Fanout::threads(3);
+  Fanout::run(branches,par.data(),func);
+  Fanout::threads(0);
+
+  Err seqerr;
+  Err parerr;
+  for(u64 i = 0; i < branches.size(); i++)
+    {
+      TEST_CHECK(seq[i] == par[i]);
+      seqerr = seq[i];
+      parerr = par[i];
+    }
+  TEST_CHECK(seq[0] == 0);
+  TEST_CHECK(seq[1] == -(EROFS + 1));
+  TEST_CHECK((int)seqerr == (int)parerr);
+}
+
+void
+test_branch_watch_relpath()
+{
+  std::string rel;
+  std::vector<std::string> roots = {"/mnt/disk10","/mnt/disk1"};
+  std::vector<std::string> slash = {""};
+
+  TEST_CHECK(BranchWatch::relpath(roots,"/mnt/disk1/a/b",&rel));
+  TEST_CHECK(rel == "/a/b");
+  TEST_CHECK(BranchWatch::relpath(roots,"/mnt/disk10/c",&rel));
+  TEST_CHECK(rel == "/c");
+  TEST_CHECK(BranchWatch::relpath(roots,"/mnt/disk1",&rel));
+  TEST_CHECK(rel.empty());
+  TEST_CHECK(!BranchWatch::relpath(roots,"/mnt/disk100/c",&rel));
+  TEST_CHECK(!BranchWatch::relpath(roots,"/mnt/disk2/c",&rel));
+
+  TEST_CHECK(BranchWatch::relpath(slash,"/etc/passwd",&rel));
+  TEST_CHECK(rel == "/etc/passwd");
+}
+
+void
+test_branch_watch_invalidate()
+{
+  int fd;
+  Branch branch;
+  std::string rel;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-bwinval-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  branch.path = tmp_dir;
+  std::filesystem::create_directory(tmp_dir / "a");
+  std::ofstream(tmp_dir / "a" / "b") << "b";
+
+  FdCache::capacity(4);
+  fd = ::open((tmp_dir / "a" / "b").c_str(),O_RDONLY);
+  TEST_CHECK(FdCache::put(1,"a/b",branch,fd) == true);
+  TEST_CHECK(FdCache::stats().size == 1);
+
+  // Events outside the file or for the root leave it alone.
+  TEST_CHECK(BranchWatch::relpath({tmp_dir.string()},tmp_dir.string(),&rel));
+  BranchWatch::invalidate(rel);
+  TEST_CHECK(BranchWatch::relpath({tmp_dir.string()},(tmp_dir / "a").string(),&rel));
+  BranchWatch::invalidate(rel);
+  TEST_CHECK(FdCache::stats().size == 1);
+
+  TEST_CHECK(BranchWatch::relpath({tmp_dir.string()},(tmp_dir / "a" / "b").string(),&rel));
+  BranchWatch::invalidate(rel);
+  TEST_CHECK(FdCache::stats().size == 0);
+
+  FdCache::clear();
+  FdCache::capacity(0);
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_invalidate_path_unmounted()
+{
+  u64 nodeid = 0;
+
+  // Relocations in tests run without a session. Must be a no-op.
+  TEST_CHECK(fuse_invalidate_path("/a/b",0,&nodeid) == -ENOTCONN);
+  TEST_CHECK(fuse_invalidate_path("/a/b",
+                                  FUSE_INVAL_EXPIRE_ONLY|FUSE_INVAL_ATTR_ONLY,
+                                  &nodeid) == -ENOTCONN);
+  KernelNotify::expire("/a/b");
+  KernelNotify::invalidate("/a/b");
+}
+
+void
+test_stats_snapshot()
+{
+  u32 size;
+  mergerfs_stats_hdr_t hdr;
+  mergerfs_stats_op_t op;
+  static mergerfs_ioctl_t ioc;
+
+  TEST_CHECK(fuse_stats_hist_bucket(999) == 0);
+  TEST_CHECK(fuse_stats_hist_bucket(1000) == 1);
+  TEST_CHECK(fuse_stats_hist_bucket(3999) == 2);
+  TEST_CHECK(fuse_stats_hist_bucket(4000) == 3);
+  TEST_CHECK(fuse_stats_hist_bucket(~0ULL) == (FUSE_STATS_HIST_BUCKETS - 1));
+
+  fuse_stats_op_reset();
+  fuse_stats_op(FUSE_GETATTR,500);
+  fuse_stats_op(FUSE_GETATTR,2500);
+  fuse_stats_op_error(FUSE_GETATTR);
+  fuse_stats_op(FUSE_STATFS,100);
+
+  size = StatsSnapshot::fill(ioc.buf,sizeof(ioc.buf),0);
+  TEST_CHECK(size >= sizeof(hdr));
+
+  std::memcpy(&hdr,ioc.buf,sizeof(hdr));
+  TEST_CHECK(hdr.magic == MERGERFS_STATS_MAGIC);
+  TEST_CHECK(hdr.version == MERGERFS_STATS_VERSION);
+  TEST_CHECK(hdr.size == size);
+  TEST_CHECK(hdr.op_count == 2);
+  TEST_CHECK(hdr.flags == 0);
+  TEST_CHECK(hdr.branch_offset == 0);
+  TEST_CHECK(hdr.branch_count == hdr.branch_total);
+  TEST_CHECK(size >= (hdr.hdr_size +
+                      (hdr.op_count * hdr.op_size) +
+                      (hdr.branch_count * hdr.branch_size)));
+
+  std::memcpy(&op,&ioc.buf[hdr.hdr_size],sizeof(op));
+  TEST_CHECK(op.opcode == FUSE_GETATTR);
+  TEST_CHECK(op.count == 2);
+  TEST_CHECK(op.errors == 1);
+  TEST_CHECK(op.total_ns == 3000);
+  TEST_CHECK(op.hist[0] == 1);
+  TEST_CHECK(op.hist[2] == 1);
+
+  // Too small for every record.
+  size = StatsSnapshot::fill(ioc.buf,sizeof(hdr) + sizeof(op),0);
+  std::memcpy(&hdr,ioc.buf,sizeof(hdr));
+  TEST_CHECK(hdr.op_count == 1);
+  TEST_CHECK(hdr.flags & MERGERFS_STATS_FLAG_TRUNCATED);
+
+  fuse_stats_op_reset();
+}
+
+// More and longer branches than fit in one ioctl buffer. Paging
+// through them must return every branch with its full path.
+static
+void
+test_stats_snapshot_paging()
+{
+  u32 size;
+  u32 offset;
+  std::string branches;
+  std::vector<std::string> paths;
+  std::vector<std::string> seen;
+  mergerfs_stats_hdr_t hdr;
+  static mergerfs_ioctl_t ioc;
+  char tmp_template[] = "/tmp/mergerfs-test-stats-paging-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  for(int i = 0; i < 48; i++)
+    {
+      std::string path;
+
+      path  = tmp_template;
+      path += '/' + std::string(200,'a' + (i % 26)) + std::to_string(i);
+      std::filesystem::create_directory(path);
+      if(!branches.empty())
+        branches += ':';
+      branches += path;
+      paths.emplace_back(path);
+    }
+  TEST_CHECK(cfg.set("branches",branches) == 0);
+
+  offset = 0;
+  do
+    {
+      u32 pos;
+      mergerfs_stats_req_t req = {offset};
+
+      std::memcpy(ioc.buf,&req,sizeof(req));
+      size = StatsSnapshot::fill(ioc.buf,sizeof(ioc.buf),req.branch_offset);
+      std::memcpy(&hdr,ioc.buf,sizeof(hdr));
+      TEST_CHECK(hdr.size == size);
+      TEST_CHECK(hdr.branch_offset == offset);
+      TEST_CHECK(hdr.branch_total == paths.size());
+      TEST_CHECK(hdr.branch_count > 0);
+      TEST_CHECK((hdr.flags & MERGERFS_STATS_FLAG_TRUNCATED) == 0);
+      if(offset > 0)
+        TEST_CHECK(hdr.op_count == 0);
+
+      pos = hdr.hdr_size + (hdr.op_count * hdr.op_size);
+      for(u32 i = 0; i < hdr.branch_count; i++)
+        {
+          mergerfs_stats_branch_t rec;
+
+          std::memcpy(&rec,&ioc.buf[pos],sizeof(rec));
+          pos += hdr.branch_size;
+          seen.emplace_back(&ioc.buf[pos],rec.path_len);
+          pos += rec.path_len;
+        }
+      TEST_CHECK(pos == size);
+
+      offset += hdr.branch_count;
+    }
+  while((hdr.branch_count > 0) && (offset < hdr.branch_total));
+
+  TEST_CHECK(offset > hdr.branch_count);
+  TEST_CHECK(seen == paths);
+
+  cfg.set("branches","");
+  std::filesystem::remove_all(tmp_template);
+}
+
+static
+void
+test_branch_stats()
+{
+  u64 start;
+  BranchStats::Counters *c;
+  BranchStats::Snapshot snap;
+  const std::string path = "/tmp/mergerfs-test-branch-stats";
+
+  c = BranchStats::get(path);
+  TEST_CHECK(c != nullptr);
+  TEST_CHECK(BranchStats::get(path) == c);
+  TEST_CHECK(BranchStats::get(path + "2") != c);
+
+  start = fuse_stats_now_ns();
+  BranchStats::record(c,BranchStats::READ,4096,start);
+  BranchStats::record(c,BranchStats::READ,-EIO,start);
+  BranchStats::record(c,BranchStats::WRITE,100,start);
+  BranchStats::record(path,BranchStats::OPEN,3,start);
+
+  // Records from other threads land in other shards.
+  std::thread([&]()
+  {
+    BranchStats::record(c,BranchStats::WRITE,50,start);
+  }).join();
+
+  BranchStats::snapshot(path,&snap);
+  TEST_CHECK(snap.ops[BranchStats::READ] == 2);
+  TEST_CHECK(snap.errors[BranchStats::READ] == 1);
+  TEST_CHECK(snap.read_bytes == 4096);
+  TEST_CHECK(snap.ops[BranchStats::WRITE] == 2);
+  TEST_CHECK(snap.errors[BranchStats::WRITE] == 0);
+  TEST_CHECK(snap.write_bytes == 150);
+  TEST_CHECK(snap.ops[BranchStats::OPEN] == 1);
+  TEST_CHECK(snap.ops[BranchStats::SYNC] == 0);
+  TEST_CHECK(std::accumulate(std::begin(snap.hist),std::end(snap.hist),0ULL) == 5);
+}
+
+static
+void
+test_hot_nodes()
+{
+  std::vector<HotNodes::Entry> top;
+
+  HotNodes::enable(false);
+  HotNodes::touch(1);
+  TEST_CHECK(HotNodes::top().empty());
+
+  HotNodes::enable(true);
+  for(int i = 0; i < 1000; i++)
+    HotNodes::touch(100);
+  for(int i = 0; i < 500; i++)
+    HotNodes::touch(200);
+  // Far more cold nodes than the table holds.
+  for(u64 n = 1000; n < 11000; n++)
+    HotNodes::touch(n);
+  for(int i = 0; i < 10; i++)
+    HotNodes::touch(100);
+
+  top = HotNodes::top();
+  TEST_CHECK(top.size() >= 2);
+  TEST_CHECK(top.size() <= 64);
+  TEST_CHECK(top[0].nodeid == 100);
+  TEST_CHECK(top[0].score >= 1010);
+  TEST_CHECK(top[1].nodeid == 200);
+  TEST_CHECK(top[1].score >= 500);
+
+  HotNodes::decay();
+  top = HotNodes::top();
+  TEST_CHECK(top[0].nodeid == 100);
+  TEST_CHECK(top[0].score < 1010);
+
+  HotNodes::clear();
+  TEST_CHECK(HotNodes::top().empty());
+  HotNodes::enable(false);
+}
+
+static
+void
+test_slowlog()
+{
+  LogFile log_file({});
+  std::string logpath;
+  std::string contents;
+
+  logpath = "/tmp/mergerfs-test-slowlog." + std::to_string(::getpid());
+  TEST_CHECK(log_file.from_string(logpath) == 0);
+
+  fuse_slowlog_threshold_ms(0);
+  fuse_slowlog_begin(1);
+  TEST_CHECK(fuse_slowlog_start() == 0);
+  fuse_slowlog_end(FUSE_GETATTR,1000000000ULL);
+
+  fuse_slowlog_threshold_ms(5);
+  TEST_CHECK(fuse_slowlog_threshold_ms() == 5);
+
+  // Outside of a request nothing is recorded.
+  TEST_CHECK(fuse_slowlog_start() == 0);
+
+  // Fast requests are not logged.
+  fuse_slowlog_begin(1);
+  fuse_slowlog_path("/fast");
+  fuse_slowlog_call("lstat",-1,"/branch/fast",0,fuse_slowlog_start());
+  fuse_slowlog_end(FUSE_GETATTR,1000);
+
+  fuse_slowlog_begin(1);
+  fuse_slowlog_path("/slow");
+  fuse_slowlog_policy("ff","/branch",0,fuse_slowlog_start());
+  for(int i = 0; i < 40; i++)
+    fuse_slowlog_call("lstat",-1,"/branch/slow",-ENOENT,fuse_slowlog_start());
+  fuse_slowlog_end(FUSE_GETATTR,6000000ULL);
+  fuse_slowlog_threshold_ms(0);
+
+  {
+    std::ifstream ifs(logpath);
+    std::stringstream ss;
+
+    ss << ifs.rdbuf();
+    contents = ss.str();
+  }
 
-  TEST_CHECK(b.mode == Branch::Mode::RW);
+  TEST_CHECK(contents.find("/fast") == std::string::npos);
+  TEST_CHECK(contents.find("slow op: GETATTR took 6.000ms nodeid=1 path=/slow") != std::string::npos);
+  TEST_CHECK(contents.find("9 earlier calls not shown") != std::string::npos);
+  TEST_CHECK(contents.find("lstat /branch/slow") != std::string::npos);
+  TEST_CHECK(contents.find("rv=-2") != std::string::npos);
+
+  log_file.from_string("");
+  ::unlink(logpath.c_str());
 }
 
+static
 void
-test_branch_to_string_modes()
+test_fsck_index()
 {
-  uint64_t global = 0;
-  Branch b(global);
+  int rv;
+  u32 flags;
+  std::string path;
+  const FsckIndex::BranchStat *bs;
+  FsckIndex::BranchStat stats[2] = {};
 
-  b.path = "/mnt/disk1";
+  path = "/tmp/mergerfs-test-fsck-index." + std::to_string(::getpid());
 
-  b.mode = Branch::Mode::RW;
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW");
+  {
+    FsckIndex::Writer writer(2);
 
-  b.mode = Branch::Mode::RO;
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RO");
+    for(u64 i = 0; i < 1000; i++)
+      {
+        stats[0].size      = i;
+        stats[1].mtime_sec = i * 2;
+        writer.add(FsckIndex::hash("dir" + std::to_string(i)),
+                   ((i == 7) ? FsckIndex::FLAG_MISMATCH : 0),
+                   stats);
+      }
 
-  b.mode = Branch::Mode::NC;
-  TEST_CHECK(b.to_string() == "/mnt/disk1=NC");
-}
+    TEST_CHECK(writer.write(path,1234) == 0);
+  }
 
-void
-test_branch_to_string_with_minfreespace()
-{
-  uint64_t global = 0;
-  Branch b(global);
+  {
+    FsckIndex::Reader reader;
 
-  b.path = "/mnt/disk1";
-  b.mode = Branch::Mode::RW;
+    TEST_CHECK(reader.lookup(FsckIndex::hash("dir1"),&flags) == nullptr);
+    TEST_CHECK(reader.open(path,1235,2) == -EINVAL);
+    TEST_CHECK(reader.open(path,1234,3) == -EINVAL);
+  }
 
-  // While minfreespace is held by pointer (global default), it is NOT emitted
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW");
+  {
+    FsckIndex::Reader reader;
 
-  // Once set_minfreespace is called the value is stored locally and IS emitted
-  b.set_minfreespace(1024);
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1K");
+    rv = reader.open(path,1234,2);
+    TEST_CHECK(rv == 0);
+    TEST_CHECK(reader.count() == 1000);
 
-  b.set_minfreespace(1024 * 1024);
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1M");
+    for(u64 i = 0; i < 1000; i++)
+      {
+        flags = ~0U;
+        bs = reader.lookup(FsckIndex::hash("dir" + std::to_string(i)),&flags);
+        TEST_CHECK(bs != nullptr);
+        if(bs == nullptr)
+          continue;
+        TEST_CHECK(bs[0].size == i);
+        TEST_CHECK(bs[1].mtime_sec == (s64)(i * 2));
+        TEST_CHECK(flags == ((i == 7) ? (u32)FsckIndex::FLAG_MISMATCH : 0U));
+      }
 
-  b.set_minfreespace(1024 * 1024 * 1024);
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,1G");
+    TEST_CHECK(reader.lookup(FsckIndex::hash("dir1000"),&flags) == nullptr);
+  }
 
-  b.set_minfreespace(500);
-  TEST_CHECK(b.to_string() == "/mnt/disk1=RW,500");
+  TEST_CHECK(FsckIndex::Reader().open(path + ".missing",1234,2) == -ENOENT);
+  ::unlink(path.c_str());
 }
 
+// Three branches: `a` on all, `a/same` and `a/diff` on two with
+// `a/diff` differing in mode, plus `m` holding 32 subdirectories
+// each with a file on two branches. Everything else exists on one
+// branch only and must not be stat'ed.
+static
 void
-test_branch_mode_predicates()
+test_fsck_scan()
 {
-  Branch b;
+  std::filesystem::path root;
+  FsckScan::Scan scan;
+  std::vector<std::thread> threads;
+  std::vector<std::string> reported;
+  char tmp_template[] = "/tmp/mergerfs-test-fsck-scan-XXXXXX";
 
-  b.mode = Branch::Mode::RW;
-  TEST_CHECK(b.ro()       == false);
-  TEST_CHECK(b.nc()       == false);
-  TEST_CHECK(b.ro_or_nc() == false);
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
 
-  b.mode = Branch::Mode::RO;
-  TEST_CHECK(b.ro()       == true);
-  TEST_CHECK(b.nc()       == false);
-  TEST_CHECK(b.ro_or_nc() == true);
+  root = tmp_template;
+  for(const char *b : {"b0","b1","b2"})
+    {
+      std::filesystem::create_directories(root / b / "a");
+      scan.branches.emplace_back((root / b).string());
+    }
+  for(const char *b : {"b0","b1"})
+    {
+      std::ofstream(root / b / "a" / "same") << "same";
+      std::ofstream(root / b / "a" / "diff") << "diff";
+      for(int i = 0; i < 32; i++)
+        {
+          std::filesystem::create_directories(root / b / "m" / std::to_string(i));
+          std::ofstream(root / b / "m" / std::to_string(i) / "f") << i;
+        }
+    }
+  ::chmod((root / "b0" / "a" / "diff").c_str(),0644);
+  ::chmod((root / "b1" / "a" / "diff").c_str(),0600);
+  std::ofstream(root / "b0" / "only0") << "0";
+  std::ofstream(root / "b1" / "only1") << "1";
+  std::filesystem::create_directories(root / "b0" / "d");
+  std::ofstream(root / "b0" / "d" / "x") << "x";
+  std::filesystem::create_directories(root / "b2" / "a" / "sub");
+  std::ofstream(root / "b2" / "a" / "sub" / "f") << "f";
+
+  scan.mountpoint = "/mnt";
+  scan.report =
+    [&](const std::string &path_,
+        const PathStatVec &pathstats_)
+    {
+      reported.emplace_back(path_);
+      for(const auto &ps : pathstats_)
+        if(ps.st.st_mode != pathstats_[0].st.st_mode)
+          return true;
+      return false;
+    };
 
-  b.mode = Branch::Mode::NC;
-  TEST_CHECK(b.ro()       == false);
-  TEST_CHECK(b.nc()       == true);
-  TEST_CHECK(b.ro_or_nc() == true);
-}
+  {
+    FsckScan::DirQueue queue(4);
 
-void
-test_branch_minfreespace_pointer_vs_value()
-{
-  uint64_t global = 9999;
-  Branch b(global);
+    queue.push(0,"");
+    for(u64 i = 0; i < 4; i++)
+      threads.emplace_back([&,i](){ FsckScan::scan_thread(scan,queue,i); });
+    for(auto &thread : threads)
+      thread.join();
+  }
 
-  // Reads through the pointer
-  TEST_CHECK(b.minfreespace() == 9999);
+  // root, a, a/sub, d, m, and m/0..31
+  TEST_CHECK(scan.dirs == 37);
+  TEST_CHECK(scan.entries == 74);
+  TEST_CHECK(scan.duplicates == 68);
+  TEST_CHECK(reported.size() == 68);
+  TEST_CHECK(scan.mismatches == 1);
+  // One stat per copy of a duplicate name and none for the rest.
+  TEST_CHECK(scan.stats == (3 + 2 + 2 + 2 + (32 * 2) + (32 * 2)));
+  TEST_CHECK(std::find(reported.begin(),
+                       reported.end(),
+                       "/mnt/a/diff") != reported.end());
+  TEST_CHECK(std::find(reported.begin(),
+                       reported.end(),
+                       "/mnt/only0") == reported.end());
+
+  // With nothing queued every thread gives up.
+  {
+    FsckScan::DirQueue queue(4);
+
+    threads.clear();
+    for(u64 i = 0; i < 4; i++)
+      threads.emplace_back([&queue,i]()
+                           {
+                             std::string relpath;
+                             TEST_CHECK(!queue.pop(i,relpath));
+                           });
+    for(auto &thread : threads)
+      thread.join();
+  }
 
-  // Pointer tracks changes to the referenced global
-  global = 1234;
-  TEST_CHECK(b.minfreespace() == 1234);
+  // With an index only files changed since they last matched are
+  // compared again, including an append which leaves the directory's
+  // mtime alone.
+  {
+    const std::string index = (root / "index").string();
 
-  // set_minfreespace switches variant to owned u64
-  b.set_minfreespace(42);
-  TEST_CHECK(b.minfreespace() == 42);
+    auto run =
+      [&](FsckScan::Scan &s_)
+      {
+        FsckScan::DirQueue queue(4);
 
-  // Global changes no longer affect it
-  global = 9999;
-  TEST_CHECK(b.minfreespace() == 42);
-}
+        s_.mountpoint = "/mnt";
+        s_.branches   = scan.branches;
+        s_.report     = scan.report;
+        s_.index_in.open(index,1,s_.branches.size());
+        s_.index_out = std::make_unique<FsckIndex::Writer>(s_.branches.size());
 
-void
-test_branch_copy_constructor()
-{
-  uint64_t global = 100;
-  Branch orig(global);
-  orig.path = "/orig";
-  orig.mode = Branch::Mode::RO;
+        reported.clear();
+        threads.clear();
+        queue.push(0,"");
+        for(u64 i = 0; i < 4; i++)
+          threads.emplace_back([&,i](){ FsckScan::scan_thread(s_,queue,i); });
+        for(auto &thread : threads)
+          thread.join();
 
-  Branch copy(orig);
-  TEST_CHECK(copy.path == "/orig");
-  TEST_CHECK(copy.mode == Branch::Mode::RO);
-  TEST_CHECK(copy.minfreespace() == 100);
+        TEST_CHECK(s_.index_out->write(index,1) == 0);
+      };
+
+    {
+      FsckScan::Scan s;
+      run(s);
+      TEST_CHECK(s.skipped == 0);
+      TEST_CHECK(reported.size() == 68);
+    }
+
+    {
+      FsckScan::Scan s;
+      run(s);
+      TEST_CHECK(s.skipped == 67);
+      TEST_CHECK(reported.size() == 1);
+      TEST_CHECK(s.mismatches == 1);
+    }
+
+    std::ofstream(root / "b0" / "a" / "same",std::ios::app) << "more";
+
+    {
+      FsckScan::Scan s;
+      run(s);
+      TEST_CHECK(s.skipped == 66);
+      TEST_CHECK(reported.size() == 2);
+      TEST_CHECK(std::find(reported.begin(),
+                           reported.end(),
+                           "/mnt/a/same") != reported.end());
+    }
+  }
+
+  std::filesystem::remove_all(root);
 }
 
+static
 void
-test_branch_copy_assignment()
+test_stats_shm()
 {
-  uint64_t global = 77;
-  Branch a(global);
-  a.path = "/a";
-  a.mode = Branch::Mode::NC;
-  a.set_minfreespace(555);
+  int fd;
+  int rv;
+  void *mem;
+  std::string path;
+  mergerfs_stats_hdr_t hdr;
+  const mergerfs_stats_shm_t *shm;
+  static char buf[MERGERFS_STATS_SHM_DATA_SIZE];
+  static mergerfs_stats_shm_t local;
+
+  // A writer mid-update leaves seq odd and readers must give up.
+  local.seq = 1;
+  TEST_CHECK(StatsShm::read(&local,buf,sizeof(buf)) == -EAGAIN);
+  local.seq  = 2;
+  local.size = 4;
+  std::memcpy(local.data,"abcd",4);
+  TEST_CHECK(StatsShm::read(&local,buf,sizeof(buf)) == 4);
+  TEST_CHECK(std::memcmp(buf,"abcd",4) == 0);
+
+  path = StatsShm::path(::getpid());
+
+  // Anything already at the predictable path is replaced rather than
+  // followed.
+  {
+    struct stat st;
+    const std::string target = "/tmp/mergerfs-test-shm-target";
+
+    std::ofstream(target) << "keep";
+    ::unlink(path.c_str());
+    TEST_CHECK(::symlink(target.c_str(),path.c_str()) == 0);
+    StatsShm::enable(true);
+    TEST_CHECK(::lstat(path.c_str(),&st) == 0);
+    TEST_CHECK(S_ISREG(st.st_mode));
+    TEST_CHECK(::stat(target.c_str(),&st) == 0);
+    TEST_CHECK(st.st_size == 4);
+    ::unlink(target.c_str());
+  }
 
-  Branch b;
-  b = a;
-  TEST_CHECK(b.path == "/a");
-  TEST_CHECK(b.mode == Branch::Mode::NC);
-  TEST_CHECK(b.minfreespace() == 555);
+  fd = ::open(path.c_str(),O_RDONLY);
+  TEST_CHECK(fd >= 0);
+  if(fd < 0)
+    return StatsShm::enable(false);
+  mem = ::mmap(NULL,sizeof(*shm),PROT_READ,MAP_SHARED,fd,0);
+  ::close(fd);
+  TEST_CHECK(mem != MAP_FAILED);
+  if(mem == MAP_FAILED)
+    return StatsShm::enable(false);
+
+  shm = (const mergerfs_stats_shm_t*)mem;
+  TEST_CHECK(shm->magic == MERGERFS_STATS_SHM_MAGIC);
+  TEST_CHECK(shm->pid == (u32)::getpid());
+  for(int i = 0; (i < 1000) && (shm->seq.load() < 2); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  rv = StatsShm::read(shm,buf,sizeof(buf));
+  TEST_CHECK(rv >= (int)sizeof(hdr));
+  std::memcpy(&hdr,buf,sizeof(hdr));
+  TEST_CHECK(hdr.magic == MERGERFS_STATS_MAGIC);
+  TEST_CHECK(hdr.size == (u32)rv);
+
+  ::munmap(mem,sizeof(*shm));
+  StatsShm::enable(false);
+  TEST_CHECK(::access(path.c_str(),F_OK) == -1);
 }
 
 // ---------------------------------------------------------------------------
@@ -1480,6 +3078,162 @@ test_config()
   TEST_CHECK(cfg.set("async-read","true") == 0);
 }
 
+static
+AttrCache::Entry
+_attr_cache_entry(const std::string &branch_,
+                  const std::string &fusepath_)
+{
+  AttrCache::Entry entry;
+
+  entry.fusepath = fusepath_;
+  entry.branch   = branch_;
+  entry.follow   = false;
+  ::lstat((fs::path(branch_) / fusepath_).c_str(),&entry.st);
+  entry.fingerprint = AttrCache::fingerprint(entry.st);
+  entry.st.st_ino   = 12345;
+
+  return entry;
+}
+
+void
+test_attr_cache_get_set()
+{
+  int rv;
+  struct stat st;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-attr-cache-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::ofstream(tmp_dir / "file") << "data";
+
+  AttrCache::clear();
+  TEST_CHECK(AttrCache::get(100,"file",60,true,&st) == false);
+
+  AttrCache::set(100,::_attr_cache_entry(tmp_dir,"file"));
+  TEST_CHECK(AttrCache::size() == 1);
+
+  memset(&st,0,sizeof(st));
+  TEST_CHECK(AttrCache::get(100,"file",60,true,&st) == true);
+  TEST_CHECK(st.st_ino == 12345);
+  TEST_CHECK(st.st_size == 4);
+
+  // renamed nodes must not reuse the old result
+  TEST_CHECK(AttrCache::get(100,"other",60,false,&st) == false);
+  // expired
+  TEST_CHECK(AttrCache::get(100,"file",0,false,&st) == false);
+
+  AttrCache::invalidate(100);
+  TEST_CHECK(AttrCache::get(100,"file",60,false,&st) == false);
+  TEST_CHECK(AttrCache::size() == 0);
+
+  AttrCache::set(100,::_attr_cache_entry(tmp_dir,"file"));
+  AttrCache::set(101,::_attr_cache_entry(tmp_dir,"file"));
+  TEST_CHECK(AttrCache::prune(60) == 0);
+  TEST_CHECK(AttrCache::prune(0) == 2);
+  TEST_CHECK(AttrCache::size() == 0);
+
+  rv = std::filesystem::remove_all(tmp_dir);
+  TEST_CHECK(rv > 0);
+}
+
+// The request nodeid for link and unlink is the parent directory.
+// Entries for the other names of the inode carry a stale st_nlink
+// and have to go too.
+static
+void
+test_attr_cache_link()
+{
+  int rv;
+  struct stat st;
+  fs::path tmp_dir;
+  fuse_timeouts_t to;
+  fuse_req_ctx_t ctx = {};
+  char tmp_template[] = "/tmp/mergerfs-test-attr-cache-link-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::ofstream(tmp_dir / "file") << "data";
+  std::ofstream(tmp_dir / "other") << "data";
+  TEST_CHECK(::link((tmp_dir / "file").c_str(),(tmp_dir / "alias").c_str()) == 0);
+  TEST_CHECK(cfg.set("branches",tmp_dir.string()) == 0);
+
+  AttrCache::clear();
+  AttrCache::set(300,::_attr_cache_entry(tmp_dir,"file"));
+  AttrCache::set(301,::_attr_cache_entry(tmp_dir,"alias"));
+  AttrCache::set(302,::_attr_cache_entry(tmp_dir,"other"));
+  TEST_CHECK(AttrCache::get(301,"alias",60,false,&st));
+  TEST_CHECK(st.st_nlink == 2);
+
+  ctx.nodeid = 1;
+  rv = FUSE::link(&ctx,"file","third",&st,&to);
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(st.st_nlink == 3);
+  TEST_CHECK(!AttrCache::get(300,"file",60,false,&st));
+  TEST_CHECK(!AttrCache::get(301,"alias",60,false,&st));
+  TEST_CHECK(AttrCache::get(302,"other",60,false,&st));
+
+  AttrCache::set(301,::_attr_cache_entry(tmp_dir,"alias"));
+  TEST_CHECK(AttrCache::get(301,"alias",60,false,&st));
+  TEST_CHECK(st.st_nlink == 3);
+  rv = FUSE::unlink(&ctx,"third");
+  TEST_CHECK(rv == 0);
+  TEST_CHECK(!AttrCache::get(301,"alias",60,false,&st));
+  TEST_CHECK(AttrCache::get(302,"other",60,false,&st));
+
+  AttrCache::clear();
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_attr_cache_validate()
+{
+  struct stat st;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-attr-cache-validate-XXXXXX";
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  std::ofstream(tmp_dir / "file") << "data";
+
+  AttrCache::clear();
+  AttrCache::set(200,::_attr_cache_entry(tmp_dir,"file"));
+  TEST_CHECK(AttrCache::get(200,"file",60,true,&st) == true);
+
+  // out of band change to the branch file
+  std::ofstream(tmp_dir / "file",std::ios::app) << "more";
+
+  // unvalidated lookups trust the entry until timeout
+  TEST_CHECK(AttrCache::get(200,"file",60,false,&st) == true);
+  TEST_CHECK(st.st_size == 4);
+
+  // validated lookups notice and drop it
+  TEST_CHECK(AttrCache::get(200,"file",60,true,&st) == false);
+  TEST_CHECK(AttrCache::size() == 0);
+
+  AttrCache::set(200,::_attr_cache_entry(tmp_dir,"file"));
+  std::filesystem::remove(tmp_dir / "file");
+  TEST_CHECK(AttrCache::get(200,"file",60,true,&st) == false);
+
+  AttrCache::clear();
+  std::filesystem::remove_all(tmp_dir);
+}
+
 // =====================================================================
 // ThreadPool tests
 // =====================================================================
@@ -3075,6 +4829,11 @@ test_fs_copyfile_source_changes_cleanup_tmpfiles()
       }
   });
 
+  // The source is a single hole so with extent aware copying the copy
+  // can finish before the mutator gets going.
+  while(mutator_updates.load() == 0)
+    std::this_thread::yield();
+
   rv = fs::copyfile(src_fd,dst_path,{.cleanup_failure = true});
   stop_mutator.store(true);
   mutator.join();
@@ -3102,6 +4861,118 @@ test_fs_copyfile_source_changes_cleanup_tmpfiles()
   std::filesystem::remove_all(tmp_dir);
 }
 
+void
+test_fs_copydata_readwrite_pipelined()
+{
+  int src_fd;
+  int dst_fd;
+  std::string data;
+  std::string copy;
+  fs::path tmp_dir;
+  char tmp_template[] = "/tmp/mergerfs-test-copydata-XXXXXX";
+  const size_t size = (5 * 1024 * 1024) + 123;
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+  for(size_t i = 0; i < size; i++)
+    data += (char)(i * 7);
+  std::ofstream(tmp_dir / "src",std::ios::binary) << data;
+
+  src_fd = ::open((tmp_dir / "src").c_str(),O_RDONLY);
+  TEST_CHECK(src_fd >= 0);
+
+  // chunk size, inflight: pipelined, serial and unaligned chunk size.
+  for(const auto &[chunk,inflight] : {std::pair<u64,u64>{64 * 1024,4},
+                                      std::pair<u64,u64>{64 * 1024,1},
+                                      std::pair<u64,u64>{1000,3}})
+    {
+      dst_fd = ::open((tmp_dir / "dst").c_str(),O_RDWR|O_CREAT|O_TRUNC,0600);
+      TEST_CHECK(dst_fd >= 0);
+
+      TEST_CHECK(fs::copydata_readwrite(src_fd,dst_fd,0,size,chunk,inflight) == (s64)size);
+
+      copy.assign(size + 1,'\0');
+      TEST_CHECK(::pread(dst_fd,copy.data(),copy.size(),0) == (ssize_t)size);
+      copy.resize(size);
+      TEST_CHECK(copy == data);
+
+      ::close(dst_fd);
+    }
+
+  TEST_CHECK(fs::copydata_readwrite(src_fd,src_fd,0,size,0,4) == -EINVAL);
+
+  ::close(src_fd);
+  std::filesystem::remove_all(tmp_dir);
+}
+
+void
+test_fs_copydata_sparse()
+{
+  int src_fd;
+  int dst_fd;
+  char c;
+  struct stat st;
+  fs::path tmp_dir;
+  std::string junk(1024 * 1024,'j');
+  char tmp_template[] = "/tmp/mergerfs-test-copydata-sparse-XXXXXX";
+  const off_t size = (64 * 1024 * 1024);
+  const off_t mid  = (32 * 1024 * 1024) + 17;
+
+  if(::mkdtemp(tmp_template) == nullptr)
+    {
+      TEST_CHECK(false);
+      return;
+    }
+
+  tmp_dir = tmp_template;
+
+  // Leading hole, one data extent in the middle and a trailing hole.
+  src_fd = ::open((tmp_dir / "src").c_str(),O_RDWR|O_CREAT|O_TRUNC,0600);
+  TEST_CHECK(src_fd >= 0);
+  TEST_CHECK(::ftruncate(src_fd,size) == 0);
+  TEST_CHECK(::pwrite(src_fd,"M",1,mid) == 1);
+
+  // Fresh destination: holes are left alone.
+  dst_fd = ::open((tmp_dir / "dst").c_str(),O_RDWR|O_CREAT|O_TRUNC,0600);
+  TEST_CHECK(dst_fd >= 0);
+  TEST_CHECK(fs::copydata(src_fd,dst_fd,size) == size);
+  TEST_CHECK(::fstat(dst_fd,&st) == 0);
+  TEST_CHECK(st.st_size == size);
+  TEST_CHECK((st.st_blocks * 512) < (4 * 1024 * 1024));
+  TEST_CHECK((::pread(dst_fd,&c,1,mid) == 1) && (c == 'M'));
+  TEST_CHECK((::pread(dst_fd,&c,1,0) == 1) && (c == '\0'));
+  ::close(dst_fd);
+
+  // Destination with existing data: holes are punched (or zeroed).
+  dst_fd = ::open((tmp_dir / "dst2").c_str(),O_RDWR|O_CREAT|O_TRUNC,0600);
+  TEST_CHECK(dst_fd >= 0);
+  TEST_CHECK(::pwrite(dst_fd,junk.data(),junk.size(),0) == (ssize_t)junk.size());
+  TEST_CHECK(::pwrite(dst_fd,junk.data(),junk.size(),size - junk.size()) == (ssize_t)junk.size());
+  TEST_CHECK(fs::copydata(src_fd,dst_fd,size) == size);
+  TEST_CHECK((::pread(dst_fd,&c,1,100) == 1) && (c == '\0'));
+  TEST_CHECK((::pread(dst_fd,&c,1,size - 1) == 1) && (c == '\0'));
+  TEST_CHECK((::pread(dst_fd,&c,1,mid) == 1) && (c == 'M'));
+  ::close(dst_fd);
+
+  // Fully sparse source.
+  TEST_CHECK(::ftruncate(src_fd,0) == 0);
+  TEST_CHECK(::ftruncate(src_fd,size) == 0);
+  dst_fd = ::open((tmp_dir / "dst3").c_str(),O_RDWR|O_CREAT|O_TRUNC,0600);
+  TEST_CHECK(fs::copydata(src_fd,dst_fd,size) == size);
+  TEST_CHECK(::fstat(dst_fd,&st) == 0);
+  TEST_CHECK(st.st_size == size);
+  TEST_CHECK(st.st_blocks == 0);
+  ::close(dst_fd);
+
+  ::close(src_fd);
+  std::filesystem::remove_all(tmp_dir);
+}
+
 void
 test_hashset_put_and_size()
 {
@@ -3754,6 +5625,8 @@ TEST_LIST =
     {"config_prune_cmd_xattr",test_config_prune_cmd_xattr},
     {"fs_copyfile_basic",test_fs_copyfile_basic},
     {"fs_copyfile_source_changes_cleanup_tmpfiles",test_fs_copyfile_source_changes_cleanup_tmpfiles},
+    {"fs_copydata_readwrite_pipelined",test_fs_copydata_readwrite_pipelined},
+    {"fs_copydata_sparse",test_fs_copydata_sparse},
     {"str_eq_nullptr",test_str_eq_nullptr},
     {"str_startswith_char_nullptr",test_str_startswith_char_nullptr},
     {"str_from_u64_suffixes",test_str_from_u64_suffixes},
@@ -3784,6 +5657,38 @@ TEST_LIST =
     {"branch_copy_assignment_relinks_default_minfreespace",test_branch_copy_assignment_relinks_default_minfreespace},
     {"branch_move_assignment_relinks_default_minfreespace",test_branch_move_assignment_relinks_default_minfreespace},
     {"str",test_str_stuff},
+    {"branch_fd_relative_ops",test_branch_fd_relative_ops},
+    {"branch_fd_revalidate",test_branch_fd_revalidate},
+    {"pathbuf_join",test_pathbuf_join},
+    {"pathbuf_long_path",test_pathbuf_long_path},
+    {"pathbuf_no_allocs",test_pathbuf_no_allocs},
+    {"getattr_open_allocs",test_getattr_open_allocs},
+    {"smallvec_inline_and_spill",test_smallvec_inline_and_spill},
+    {"statfs_merged_cache",test_statfs_merged_cache},
+    {"read_stream_sequential",test_read_stream_sequential},
+    {"replica_balance_select",test_replica_balance_select},
+    {"open_writers",test_open_writers},
+    {"open_balanced_then_write",test_open_balanced_then_write},
+    {"write_coalesce",test_write_coalesce},
+  {"relocation",test_relocation},
+  {"fd_cache",test_fd_cache},
+  {"release_async",test_release_async},
+  {"mem_branch",test_mem_branch},
+  {"fanout",test_fanout},
+  {"branch_watch_relpath",test_branch_watch_relpath},
+  {"branch_watch_invalidate",test_branch_watch_invalidate},
+  {"invalidate_path_unmounted",test_invalidate_path_unmounted},
+  {"stats_snapshot",test_stats_snapshot},
+  {"stats_snapshot_paging",test_stats_snapshot_paging},
+  {"stats_shm",test_stats_shm},
+  {"branch_stats",test_branch_stats},
+  {"hot_nodes",test_hot_nodes},
+  {"slowlog",test_slowlog},
+  {"fsck_index",test_fsck_index},
+  {"fsck_scan",test_fsck_scan},
+    {"attr_cache_get_set",test_attr_cache_get_set},
+    {"attr_cache_link",test_attr_cache_link},
+    {"attr_cache_validate",test_attr_cache_validate},
    {"tp_construct_default",test_tp_construct_default},
    {"tp_construct_named",test_tp_construct_named},
    {"tp_construct_zero_threads_throws",test_tp_construct_zero_threads_throws},
@@ -67,6 +67,7 @@ void fuse_debug_in_header(const struct fuse_in_header *hdr);
 void fuse_debug_out_header(const struct fuse_out_header *hdr);
 
 std::string fuse_debug_init_flag_name(const uint64_t);
+const char* fuse_debug_opcode_name(const uint32_t opcode);
 
 void fuse_syslog_fuse_init_in(const struct fuse_init_in *arg);
 void fuse_syslog_fuse_init_out(const struct fuse_init_out *arg);
@@ -419,6 +419,12 @@ void fuse_gc1();
 void fuse_gc();
 void fuse_invalidate_all_nodes();
 
+#define FUSE_INVAL_EXPIRE_ONLY (1 << 0)
+#define FUSE_INVAL_ATTR_ONLY   (1 << 1)
+int  fuse_invalidate_path(const char *path, uint32_t flags, uint64_t *nodeid);
+int  fuse_nodeid_path(const uint64_t nodeid, char *buf, const size_t bufsize);
+int  fuse_path_nodeid(const char *path, uint64_t *nodeid);
+
 int fuse_passthrough_open(const int fd);
 int fuse_passthrough_close(const int backing_id);
 
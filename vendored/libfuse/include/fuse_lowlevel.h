@@ -415,10 +415,13 @@ int fuse_lowlevel_notify_inval_inode(struct fuse_session *se, uint64_t ino,
  * @param parent inode number
  * @param name file name
  * @param namelen strlen() of file name
+ * @param flags FUSE_EXPIRE_ONLY to mark the dentry expired rather than
+ *              dropping it. Ignored if the kernel does not support it.
  * @return zero for success, -errno for failure
  */
 int fuse_lowlevel_notify_inval_entry(struct fuse_session *se, uint64_t parent,
-                                     const char *name, size_t namelen);
+                                     const char *name, size_t namelen,
+                                     uint32_t flags);
 
 /**
  * Notify to invalidate parent attributes and delete the dentry matching
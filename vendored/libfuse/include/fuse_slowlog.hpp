@@ -0,0 +1,33 @@
+#pragma once
+
+#include "base_types.h"
+
+// Slow request log. While a threshold is set each request thread
+// keeps a small scratch ring of the branch syscalls and policy calls
+// made on behalf of the current request. Recording an entry is a
+// clock read and a short copy. When the request finishes under the
+// threshold the ring is simply reset. When it takes longer the
+// request and everything in the ring is written as a single line to
+// `log.file` if set or otherwise syslog.
+//
+// fuse_slowlog_start() returns 0 when the log is off or the thread is
+// not serving a request and fuse_slowlog_call() ignores a 0 start so
+// callers need no checks of their own.
+
+void fuse_slowlog_threshold_ms(cu64 ms);
+u64  fuse_slowlog_threshold_ms();
+
+void fuse_slowlog_begin(cu64 nodeid);
+void fuse_slowlog_end(cu32 opcode, cu64 ns);
+void fuse_slowlog_path(const char *path);
+
+u64  fuse_slowlog_start();
+void fuse_slowlog_call(const char *name,
+                       const int   fd,
+                       const char *path,
+                       const s64   rv,
+                       cu64        start);
+void fuse_slowlog_policy(const char *name,
+                         const char *branch,
+                         const s64   rv,
+                         cu64        start);
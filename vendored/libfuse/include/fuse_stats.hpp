@@ -0,0 +1,42 @@
+#pragma once
+
+#include "base_types.h"
+
+// Per opcode request counters and latency histograms. Latency is the
+// time spent in the handler from dispatch to return which in mergerfs
+// includes sending the reply.
+//
+// Bucket 0 counts requests under 1us, bucket N those in
+// [2^(N-1),2^N)us, and the last bucket everything slower.
+#define FUSE_STATS_HIST_BUCKETS 24
+#define FUSE_STATS_MAX_OPCODE   64
+
+struct fuse_op_stats_t
+{
+  u64 count;
+  u64 errors;
+  u64 total_ns;
+  u64 hist[FUSE_STATS_HIST_BUCKETS];
+};
+
+struct fuse_pool_stats_t
+{
+  u64 msgbuf_bufsize;
+  u64 msgbuf_allocated;
+  u64 nodes;
+  u64 node_table_size;
+  u32 read_threads;
+  u32 process_threads;
+};
+
+u64  fuse_stats_now_ns();
+u32  fuse_stats_hist_bucket(cu64 ns);
+
+void fuse_stats_op(cu32 opcode, cu64 ns);
+void fuse_stats_op_error(cu32 opcode);
+int  fuse_stats_op_get(cu32 opcode, fuse_op_stats_t *st);
+void fuse_stats_op_reset();
+
+void fuse_stats_threads(cu32 read_threads, cu32 process_threads);
+void fuse_stats_threads_get(u32 *read_threads, u32 *process_threads);
+void fuse_stats_pools_get(fuse_pool_stats_t *st);
@@ -0,0 +1,28 @@
+#pragma once
+
+// Optional USDT (userland statically defined tracing) probes. Only
+// built in when compiled with `make USE_USDT=1` which requires
+// <sys/sdt.h> (systemtap-sdt-dev / systemtap-sdt-devel). Each probe
+// compiles to a single nop and a note in the ELF so there is no cost
+// unless a tracer such as bpftrace or perf attaches to it. All probes
+// use the provider name "mergerfs".
+//
+//   bpftrace -l 'usdt:/usr/bin/mergerfs:mergerfs:*'
+
+#ifdef USE_USDT
+#  if !__has_include(<sys/sdt.h>)
+#    error "USE_USDT=1 requires <sys/sdt.h> (systemtap-sdt-dev)"
+#  endif
+#  include <sys/sdt.h>
+#  define FUSE_USDT(name)           DTRACE_PROBE(mergerfs,name)
+#  define FUSE_USDT1(name,a)        DTRACE_PROBE1(mergerfs,name,a)
+#  define FUSE_USDT2(name,a,b)      DTRACE_PROBE2(mergerfs,name,a,b)
+#  define FUSE_USDT3(name,a,b,c)    DTRACE_PROBE3(mergerfs,name,a,b,c)
+#  define FUSE_USDT4(name,a,b,c,d)  DTRACE_PROBE4(mergerfs,name,a,b,c,d)
+#else
+#  define FUSE_USDT(name)           do {} while(0)
+#  define FUSE_USDT1(name,a)        do {} while(0)
+#  define FUSE_USDT2(name,a,b)      do {} while(0)
+#  define FUSE_USDT3(name,a,b,c)    do {} while(0)
+#  define FUSE_USDT4(name,a,b,c,d)  do {} while(0)
+#endif
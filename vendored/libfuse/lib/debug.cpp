@@ -1508,6 +1508,13 @@ _opcode_name(enum fuse_opcode op_)
   return names[op_];
 }
 
+const
+char*
+fuse_debug_opcode_name(const uint32_t opcode_)
+{
+  return ::_opcode_name((fuse_opcode)opcode_);
+}
+
 void
 fuse_debug_in_header(const struct fuse_in_header *hdr_)
 {
@@ -28,6 +28,8 @@
 #include "fuse_lowlevel.h"
 #include "fuse_opt.h"
 #include "fuse_pollhandle.h"
+#include "fuse_slowlog.hpp"
+#include "fuse_stats.hpp"
 #include "fuse_msgbuf.hpp"
 #include "stat_utils.h"
 
@@ -984,6 +986,9 @@ get_path_common(uint64_t     nodeid,
     }
   mutex_unlock(f.lock);
 
+  if(err == 0)
+    fuse_slowlog_path(*path);
+
   return err;
 }
 
@@ -1047,6 +1052,9 @@ get_path2(uint64_t     nodeid1,
     }
   mutex_unlock(f.lock);
 
+  if(err == 0)
+    fuse_slowlog_path(*path1);
+
   return err;
 }
 
@@ -3433,6 +3441,20 @@ metrics_log_nodes_info(FILE *file_)
   fputs(buf,file_);
 }
 
+void
+fuse_stats_pools_get(fuse_pool_stats_t *st_)
+{
+  st_->msgbuf_bufsize   = msgbuf_get_bufsize();
+  st_->msgbuf_allocated = msgbuf_alloc_count();
+
+  mutex_lock(f.lock);
+  st_->nodes           = f.id_table.use;
+  st_->node_table_size = f.id_table.size;
+  mutex_unlock(f.lock);
+
+  fuse_stats_threads_get(&st_->read_threads,&st_->process_threads);
+}
+
 static
 void
 metrics_log_nodes_info_to_tmp_dir(struct fuse *f_)
@@ -3503,8 +3525,188 @@ fuse_invalidate_all_nodes()
       fuse_lowlevel_notify_inval_entry(f.se,
                                        FUSE_ROOT_ID,
                                        name.c_str(),
-                                       name.size());
+                                       name.size(),
+                                       0);
+    }
+}
+
+// Invalidate whatever the kernel may have cached for a path relative
+// to the mount root. Only nodes the kernel has looked up exist in the
+// table so if any component is missing there is nothing to do. The
+// parent directory is invalidated as well since its listing and
+// times change along with the entry.
+//
+// FUSE_INVAL_EXPIRE_ONLY marks the dentry as needing revalidation
+// rather than dropping it and FUSE_INVAL_ATTR_ONLY leaves the page
+// cache alone. Both suit a file whose content is unchanged but which
+// now lives elsewhere.
+// Walks the node table for a path relative to the mount root. The
+// final component need not exist in which case `child_` is 0.
+static
+int
+find_path_node(const std::string &path_,
+               uint64_t          *parent_,
+               std::string       *name_,
+               uint64_t          *child_)
+{
+  node_t *node;
+  std::string::size_type pos;
+  std::string::size_type next;
+
+  *parent_ = FUSE_ROOT_ID;
+  *child_  = 0;
+  pos      = path_.find_first_not_of('/');
+  if(pos == std::string::npos)
+    return -EINVAL;
+
+  mutex_lock(f.lock);
+  while(true)
+    {
+      next   = path_.find('/',pos);
+      *name_ = path_.substr(pos,next - pos);
+      pos    = path_.find_first_not_of('/',next);
+      if(pos == std::string::npos)
+        break;
+
+      node = lookup_node(*parent_,name_->c_str());
+      if(node == NULL)
+        {
+          mutex_unlock(f.lock);
+          return -ENOENT;
+        }
+
+      *parent_ = node->nodeid;
+    }
+
+  node = lookup_node(*parent_,name_->c_str());
+  if(node != NULL)
+    *child_ = node->nodeid;
+  mutex_unlock(f.lock);
+
+  return 0;
+}
+
+int
+fuse_invalidate_path(const char     *path_,
+                     const uint32_t  flags_,
+                     uint64_t       *nodeid_)
+{
+  int rv;
+  off_t off;
+  uint32_t entryflags;
+  uint64_t parent;
+  uint64_t child;
+  std::string name;
+
+  if(f.se == NULL)
+    return -ENOTCONN;
+
+  rv = find_path_node(path_,&parent,&name,&child);
+  if(rv < 0)
+    return rv;
+
+  // A negative offset invalidates attributes only.
+  off        = ((flags_ & FUSE_INVAL_ATTR_ONLY) ? -1 : 0);
+  entryflags = ((flags_ & FUSE_INVAL_EXPIRE_ONLY) ? FUSE_EXPIRE_ONLY : 0);
+
+  fuse_lowlevel_notify_inval_entry(f.se,
+                                   parent,
+                                   name.c_str(),
+                                   name.size(),
+                                   entryflags);
+  fuse_lowlevel_notify_inval_inode(f.se,parent,off,0);
+  if(child)
+    fuse_lowlevel_notify_inval_inode(f.se,child,off,0);
+
+  if(nodeid_)
+    *nodeid_ = child;
+
+  return 0;
+}
+
+// Looks up the nodeid of a path relative to the mount root without
+// notifying the kernel. The root itself is given as "" or "/".
+int
+fuse_path_nodeid(const char *path_,
+                 uint64_t   *nodeid_)
+{
+  int rv;
+  uint64_t parent;
+  uint64_t child;
+  std::string name;
+
+  if(f.se == NULL)
+    return -ENOTCONN;
+
+  rv = find_path_node(path_,&parent,&name,&child);
+  if(rv == -EINVAL)
+    child = FUSE_ROOT_ID;
+  else if(rv < 0)
+    return rv;
+  if(child == 0)
+    return -ENOENT;
+
+  *nodeid_ = child;
+
+  return 0;
+}
+
+// Writes the current path of a node into buf_ for reporting. Unlike
+// get_path() it does not take or wait on the tree locks so the path
+// may be stale if a rename is in flight. Returns the length or
+// -ENOENT if the node is unknown.
+int
+fuse_nodeid_path(const uint64_t  nodeid_,
+                 char           *buf_,
+                 const size_t    bufsize_)
+{
+  size_t len;
+  size_t namelen;
+  node_t *node;
+  char *s;
+
+  if(bufsize_ < 2)
+    return -ENAMETOOLONG;
+
+  s  = buf_ + bufsize_ - 1;
+  *s = '\0';
+
+  mutex_lock(f.lock);
+  node = get_node(nodeid_);
+  if(node == NULL)
+    {
+      mutex_unlock(f.lock);
+      return -ENOENT;
+    }
+
+  for(; node->nodeid != FUSE_ROOT_ID; node = node->parent)
+    {
+      if((node->name == NULL) || (node->parent == NULL))
+        {
+          mutex_unlock(f.lock);
+          return -ESTALE;
+        }
+
+      namelen = strlen(node->name);
+      if((size_t)(s - buf_) < (namelen + 1))
+        {
+          mutex_unlock(f.lock);
+          return -ENAMETOOLONG;
+        }
+
+      s -= namelen;
+      memcpy(s,node->name,namelen);
+      *--s = '/';
     }
+  mutex_unlock(f.lock);
+
+  if(*s == '\0')
+    *--s = '/';
+
+  len = (buf_ + bufsize_ - 1 - s);
+  memmove(buf_,s,len + 1);
+
+  return len;
 }
 
 void
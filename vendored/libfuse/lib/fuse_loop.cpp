@@ -15,6 +15,8 @@
 
 #include "fuse_cfg.hpp"
 #include "fuse_msgbuf.hpp"
+#include "fuse_stats.hpp"
+#include "fuse_usdt.hpp"
 
 #include <cassert>
 #include <memory>
@@ -56,6 +58,26 @@ _print_error(int rv_)
              -rv_);
 }
 
+static
+inline
+void
+_usdt_receive(const fuse_msgbuf_t *msgbuf_)
+{
+  [[maybe_unused]] const fuse_in_header *in = (const fuse_in_header*)msgbuf_->mem;
+
+  FUSE_USDT3(request_receive,in->unique,in->opcode,in->len);
+}
+
+static
+inline
+void
+_usdt_dequeue(const fuse_msgbuf_t *msgbuf_)
+{
+  [[maybe_unused]] const fuse_in_header *in = (const fuse_in_header*)msgbuf_->mem;
+
+  FUSE_USDT2(request_dequeue,in->unique,in->opcode);
+}
+
 static
 int
 _nproc()
@@ -119,9 +141,11 @@ struct AsyncWorker
             return ::_print_error(rv);
           }
 
+        ::_usdt_receive(msgbuf);
         _process_tp->enqueue_work(ptok,
                                   [se = _se,fd = _fd,msgbuf]()
                                   {
+                                    ::_usdt_dequeue(msgbuf);
                                     se->process_buf(se,fd,msgbuf);
                                     msgbuf_free(msgbuf);
                                   });
@@ -181,6 +205,7 @@ struct SyncWorker
             return ::_print_error(rv);
           }
 
+        ::_usdt_receive(msgbuf);
         _se->process_buf(_se,_fd,msgbuf);
 
         msgbuf_free(msgbuf);
@@ -312,6 +337,7 @@ fuse_session_loop_mt(struct fuse_session *se_,
     process_threads = process_tp->threads();
 
   PinThreads::pin(read_threads,process_threads,pin_threads_type_);
+  fuse_stats_threads(read_threads.size(),process_threads.size());
 
   SysLog::info("read-thread-count={}; "
                "process-thread-count={}; "
@@ -21,6 +21,9 @@
 #include "fuse_msgbuf.hpp"
 #include "fuse_opt.h"
 #include "fuse_pollhandle.h"
+#include "fuse_slowlog.hpp"
+#include "fuse_stats.hpp"
+#include "fuse_usdt.hpp"
 #include "stat_utils.h"
 
 #include <stdio.h>
@@ -112,6 +115,7 @@ fuse_send_msg(const int     fd_,
 
   out->len = iov_length(iov, count);
 
+  FUSE_USDT3(request_reply,out->unique,out->error,out->len);
   rv = writev(fd_,iov,count);
   if(rv == -1)
     return -errno;
@@ -209,6 +213,9 @@ int
 fuse_reply_err(fuse_req_t *req_,
                int         err_)
 {
+  if(err_ != 0)
+    fuse_stats_op_error(req_->ctx.opcode);
+
   if(fuse_cfg.debug)
     {
       struct fuse_out_header hdr = {};
@@ -1030,6 +1037,8 @@ do_init(fuse_req_t            *req,
         f.conn.capable |= FUSE_CAP_HANDLE_KILLPRIV_V2;
       if(inargflags & FUSE_ALLOW_IDMAP)
         f.conn.capable |= FUSE_CAP_ALLOW_IDMAP;
+      if(inargflags & FUSE_HAS_EXPIRE_ONLY)
+        f.conn.capable |= FUSE_CAP_EXPIRE_ONLY;
     }
   else
     {
@@ -1360,7 +1369,8 @@ int
 fuse_lowlevel_notify_inval_entry(struct fuse_session *se,
                                  uint64_t             parent,
                                  const char          *name,
-                                 size_t               namelen)
+                                 size_t               namelen,
+                                 uint32_t             flags)
 {
   struct fuse_notify_inval_entry_out outarg;
   struct iovec iov[3];
@@ -1368,10 +1378,14 @@ fuse_lowlevel_notify_inval_entry(struct fuse_session *se,
   if(!se)
     return -EINVAL;
 
+  // Older kernels reject unknown flags. Fully invalidating is always
+  // a safe substitute for expiring.
+  if(!(f.conn.capable & FUSE_CAP_EXPIRE_ONLY))
+    flags &= ~FUSE_EXPIRE_ONLY;
+
   outarg.parent  = parent;
   outarg.namelen = namelen;
-  // TODO: Add ability to set `flags`
-  outarg.flags   = 0;
+  outarg.flags   = flags;
 
   iov[1].iov_base = &outarg;
   iov[1].iov_len = sizeof(outarg);
@@ -1644,7 +1658,20 @@ fuse_ll_buf_process_read(struct fuse_session *se_,
   if(fuse_ll_funcs[in->opcode] == NULL)
     goto reply_err;
 
-  fuse_ll_funcs[in->opcode](req, in);
+  {
+    u64 ns;
+    const u32 opcode = in->opcode;
+    const u64 start  = fuse_stats_now_ns();
+
+    FUSE_USDT3(request_dispatch,in->unique,opcode,in->nodeid);
+    fuse_slowlog_begin(in->nodeid);
+    fuse_ll_funcs[opcode](req, in);
+
+    ns = (fuse_stats_now_ns() - start);
+    fuse_stats_op(opcode,ns);
+    fuse_slowlog_end(opcode,ns);
+    FUSE_USDT2(request_done,opcode,ns);
+  }
 
   return;
 
@@ -20,6 +20,7 @@
 #include "fatal.hpp"
 #include "fuse.h"
 #include "fuse_kernel.h"
+#include "fuse_usdt.hpp"
 #include "objpool.hpp"
 
 #include <unistd.h>
@@ -109,6 +110,7 @@ _msgbuf_alloc(msgbuf_setup_func_t setup_func_)
   fuse_msgbuf_t *msgbuf;
 
   msgbuf = g_msgbuf_pool.alloc_size(g_bufsize);
+  FUSE_USDT1(msgbuf_alloc,msgbuf);
   if(msgbuf == NULL)
     return NULL;
 
@@ -135,6 +137,7 @@ msgbuf_free(fuse_msgbuf_t *msgbuf_)
   if(msgbuf_ == nullptr)
     return;
 
+  FUSE_USDT1(msgbuf_free,msgbuf_);
   g_msgbuf_pool.free_size(msgbuf_,g_bufsize);
 }
 
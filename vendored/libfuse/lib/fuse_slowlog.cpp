@@ -0,0 +1,273 @@
+#include "fuse_slowlog.hpp"
+
+#include "debug.hpp"
+#include "fuse.h"
+#include "fuse_cfg.hpp"
+#include "fuse_stats.hpp"
+#include "syslog.hpp"
+
+#include "fmt/core.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define SLOWLOG_ENTRIES  32
+#define SLOWLOG_PATH_MAX 192
+
+namespace l
+{
+  struct Entry
+  {
+    const char *name;
+    bool        policy;
+    int         fd;
+    s64         rv;
+    u64         ns;
+    char        path[SLOWLOG_PATH_MAX];
+  };
+
+  struct Ring
+  {
+    bool  active;
+    u64   nodeid;
+    u32   count;
+    char  path[PATH_MAX];
+    Entry entries[SLOWLOG_ENTRIES];
+  };
+}
+
+static std::atomic<u64> g_threshold_ns{0};
+static thread_local l::Ring t_ring;
+
+
+static
+void
+_copy(char       *dst_,
+      const char *src_,
+      const u64   dstsize_)
+{
+  if(src_ == NULL)
+    {
+      dst_[0] = '\0';
+      return;
+    }
+
+  strncpy(dst_,src_,dstsize_ - 1);
+  dst_[dstsize_ - 1] = '\0';
+}
+
+void
+fuse_slowlog_threshold_ms(cu64 ms_)
+{
+  g_threshold_ns.store(ms_ * 1000000ULL,std::memory_order_relaxed);
+}
+
+u64
+fuse_slowlog_threshold_ms()
+{
+  return (g_threshold_ns.load(std::memory_order_relaxed) / 1000000ULL);
+}
+
+void
+fuse_slowlog_begin(cu64 nodeid_)
+{
+  l::Ring &r = t_ring;
+
+  r.active = (g_threshold_ns.load(std::memory_order_relaxed) != 0);
+  if(!r.active)
+    return;
+
+  r.nodeid  = nodeid_;
+  r.count   = 0;
+  r.path[0] = '\0';
+}
+
+void
+fuse_slowlog_path(const char *path_)
+{
+  l::Ring &r = t_ring;
+
+  if(!r.active || r.path[0])
+    return;
+
+  ::_copy(r.path,path_,sizeof(r.path));
+}
+
+u64
+fuse_slowlog_start()
+{
+  if(!t_ring.active)
+    return 0;
+
+  return fuse_stats_now_ns();
+}
+
+static
+l::Entry*
+_next_entry(cu64 start_)
+{
+  l::Ring &r = t_ring;
+
+  if((start_ == 0) || !r.active)
+    return NULL;
+
+  return &r.entries[r.count++ % SLOWLOG_ENTRIES];
+}
+
+void
+fuse_slowlog_call(const char *name_,
+                  const int   fd_,
+                  const char *path_,
+                  const s64   rv_,
+                  cu64        start_)
+{
+  l::Entry *e;
+
+  e = ::_next_entry(start_);
+  if(e == NULL)
+    return;
+
+  e->name   = name_;
+  e->policy = false;
+  e->fd     = fd_;
+  e->rv     = rv_;
+  e->ns     = (fuse_stats_now_ns() - start_);
+  ::_copy(e->path,path_,sizeof(e->path));
+}
+
+void
+fuse_slowlog_policy(const char *name_,
+                    const char *branch_,
+                    const s64   rv_,
+                    cu64        start_)
+{
+  l::Entry *e;
+
+  e = ::_next_entry(start_);
+  if(e == NULL)
+    return;
+
+  e->name   = name_;
+  e->policy = true;
+  e->fd     = -1;
+  e->rv     = rv_;
+  e->ns     = (fuse_stats_now_ns() - start_);
+  ::_copy(e->path,branch_,sizeof(e->path));
+}
+
+// Paths relative to a directory fd are resolved now rather than when
+// recorded to keep recording cheap. The fd is normally still open as
+// requests don't close the branch root or file handles they use.
+static
+std::string
+_target(const l::Entry &e_)
+{
+  ssize_t len;
+  char buf[PATH_MAX];
+  std::string fdpath;
+
+  if(e_.fd < 0)
+    return e_.path;
+  if(e_.path[0] == '/')
+    return e_.path;
+
+  fdpath = fmt::format("/proc/self/fd/{}",e_.fd);
+  len = ::readlink(fdpath.c_str(),buf,sizeof(buf) - 1);
+  if(len < 0)
+    fdpath = fmt::format("fd={}",e_.fd);
+  else
+    fdpath.assign(buf,len);
+
+  if(e_.path[0] == '\0')
+    return fdpath;
+
+  return fdpath + '/' + e_.path;
+}
+
+static
+std::string
+_ms(cu64 ns_)
+{
+  return fmt::format("{:.3f}ms",ns_ / 1000000.0);
+}
+
+static
+void
+_emit(const std::string &msg_)
+{
+  auto filepath = fuse_cfg.log_filepath();
+
+  if(filepath && !filepath->empty())
+    {
+      auto output = fuse_cfg.log_file();
+
+      if(!output)
+        return;
+      fmt::print(output.get(),"{}\n",msg_);
+      fflush(output.get());
+      return;
+    }
+
+  SysLog::warning("{}",msg_);
+}
+
+void
+fuse_slowlog_end(cu32 opcode_,
+                 cu64 ns_)
+{
+  u32 first;
+  u64 threshold;
+  std::string msg;
+  l::Ring &r = t_ring;
+
+  if(!r.active)
+    return;
+  r.active = false;
+
+  // The threshold may have been changed, or disabled, while the
+  // request was in flight.
+  threshold = g_threshold_ns.load(std::memory_order_relaxed);
+  if((threshold == 0) || (ns_ < threshold))
+    return;
+
+  if(r.path[0] == '\0')
+    fuse_nodeid_path(r.nodeid,r.path,sizeof(r.path));
+
+  msg = fmt::format("slow op: {} took {} nodeid={} path={}",
+                    fuse_debug_opcode_name(opcode_),
+                    ::_ms(ns_),
+                    r.nodeid,
+                    (r.path[0] ? r.path : "?"));
+
+  first = 0;
+  if(r.count > SLOWLOG_ENTRIES)
+    {
+      first = (r.count - SLOWLOG_ENTRIES);
+      msg += fmt::format("; {} earlier calls not shown",first);
+    }
+
+  for(u32 i = first; i < r.count; i++)
+    {
+      const l::Entry &e = r.entries[i % SLOWLOG_ENTRIES];
+
+      if(e.policy)
+        msg += fmt::format("; policy {} {} rv={} -> {}",
+                           e.name,
+                           ::_ms(e.ns),
+                           e.rv,
+                           (e.path[0] ? e.path : "none"));
+      else
+        msg += fmt::format("; {} {} {} rv={}",
+                           e.name,
+                           ::_target(e),
+                           ::_ms(e.ns),
+                           e.rv);
+    }
+
+  ::_emit(msg);
+}
@@ -0,0 +1,141 @@
+#include "fuse_stats.hpp"
+
+#include <atomic>
+#include <cerrno>
+
+#include <time.h>
+
+// Counters are spread over shards picked per thread so the hot
+// opcodes (read, write, getattr) don't have every thread contending
+// on the same cache lines. Readers sum the shards.
+#define FUSE_STATS_SHARDS 8
+
+namespace l
+{
+  struct alignas(64) OpStats
+  {
+    std::atomic<u64> count;
+    std::atomic<u64> errors;
+    std::atomic<u64> total_ns;
+    std::atomic<u64> hist[FUSE_STATS_HIST_BUCKETS];
+  };
+}
+
+static l::OpStats       g_ops[FUSE_STATS_SHARDS][FUSE_STATS_MAX_OPCODE];
+static std::atomic<u32> g_next_shard{0};
+static std::atomic<u32> g_read_threads{0};
+static std::atomic<u32> g_process_threads{0};
+
+
+static
+l::OpStats*
+_shard()
+{
+  static thread_local u32 shard =
+    (g_next_shard.fetch_add(1,std::memory_order_relaxed) % FUSE_STATS_SHARDS);
+
+  return g_ops[shard];
+}
+
+u64
+fuse_stats_now_ns()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+
+  return ((ts.tv_sec * 1000000000ULL) + ts.tv_nsec);
+}
+
+u32
+fuse_stats_hist_bucket(cu64 ns_)
+{
+  u32 bucket;
+  u64 us;
+
+  us = (ns_ / 1000);
+  if(us == 0)
+    return 0;
+
+  bucket = (64 - __builtin_clzll(us));
+  if(bucket >= FUSE_STATS_HIST_BUCKETS)
+    bucket = (FUSE_STATS_HIST_BUCKETS - 1);
+
+  return bucket;
+}
+
+void
+fuse_stats_op(cu32 opcode_,
+              cu64 ns_)
+{
+  l::OpStats *st;
+
+  if(opcode_ >= FUSE_STATS_MAX_OPCODE)
+    return;
+
+  st = &::_shard()[opcode_];
+  st->count.fetch_add(1,std::memory_order_relaxed);
+  st->total_ns.fetch_add(ns_,std::memory_order_relaxed);
+  st->hist[fuse_stats_hist_bucket(ns_)].fetch_add(1,std::memory_order_relaxed);
+}
+
+void
+fuse_stats_op_error(cu32 opcode_)
+{
+  if(opcode_ >= FUSE_STATS_MAX_OPCODE)
+    return;
+
+  ::_shard()[opcode_].errors.fetch_add(1,std::memory_order_relaxed);
+}
+
+int
+fuse_stats_op_get(cu32             opcode_,
+                  fuse_op_stats_t *st_)
+{
+  if(opcode_ >= FUSE_STATS_MAX_OPCODE)
+    return -EINVAL;
+
+  *st_ = {};
+  for(u32 i = 0; i < FUSE_STATS_SHARDS; i++)
+    {
+      const l::OpStats &op = g_ops[i][opcode_];
+
+      st_->count    += op.count.load(std::memory_order_relaxed);
+      st_->errors   += op.errors.load(std::memory_order_relaxed);
+      st_->total_ns += op.total_ns.load(std::memory_order_relaxed);
+      for(u32 b = 0; b < FUSE_STATS_HIST_BUCKETS; b++)
+        st_->hist[b] += op.hist[b].load(std::memory_order_relaxed);
+    }
+
+  return 0;
+}
+
+void
+fuse_stats_op_reset()
+{
+  for(auto &shard : g_ops)
+    for(auto &op : shard)
+      {
+        op.count.store(0,std::memory_order_relaxed);
+        op.errors.store(0,std::memory_order_relaxed);
+        op.total_ns.store(0,std::memory_order_relaxed);
+        for(auto &h : op.hist)
+          h.store(0,std::memory_order_relaxed);
+      }
+}
+
+void
+fuse_stats_threads(cu32 read_threads_,
+                   cu32 process_threads_)
+{
+  g_read_threads.store(read_threads_,std::memory_order_relaxed);
+  g_process_threads.store(process_threads_,std::memory_order_relaxed);
+}
+
+void
+fuse_stats_threads_get(u32 *read_threads_,
+                       u32 *process_threads_)
+{
+  *read_threads_    = g_read_threads.load(std::memory_order_relaxed);
+  *process_threads_ = g_process_threads.load(std::memory_order_relaxed);
+}
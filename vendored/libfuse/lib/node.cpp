@@ -1,5 +1,6 @@
 #include "node.hpp"
 
+#include "fuse_usdt.hpp"
 #include "objpool.hpp"
 
 static ObjPool<node_t> g_NODE_POOL;
@@ -7,12 +8,18 @@ static ObjPool<node_t> g_NODE_POOL;
 node_t*
 node_alloc()
 {
-  return g_NODE_POOL.alloc();
+  node_t *node;
+
+  node = g_NODE_POOL.alloc();
+  FUSE_USDT1(node_alloc,node);
+
+  return node;
 }
 
 void
 node_free(node_t *node_)
 {
+  FUSE_USDT1(node_free,node_);
   g_NODE_POOL.free(node_);
 }
 